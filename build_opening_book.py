@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+오프닝 북 생성 (초반 런 상태 → top-K 프로그램 + 점수 통계)
+
+1단계: 시작 상태(init_level3)에서 큰 그룹 Running Max로 후보 생성
+2단계: 후보마다 sims번 평가 (몬테카를로) → 평균 / 표준편차 순위
+3단계: 최선 프로그램을 rollouts번 실행해 다음 런 상태 수집, min_visits 이상 나온 상태를 다음 깊이로 확장
+4단계: 대칭 정규화 키로 저장 (mmap 가능한 단일 파일)
+
+사용법:
+    python3 build_opening_book.py --max_runs 2 --group_size 256 --sims 64 --output opening_book.bin
+
+생성 시 사용:
+    python3 generate_sft_data.py --opening_book opening_book.bin --book_explore 0.1
+"""
+
+import os
+import sys
+import time
+import argparse
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+os.environ['SDL_VIDEODRIVER'] = 'dummy'
+os.environ['SDL_AUDIODRIVER'] = 'dummy'
+
+from game_worker import (generate_running_max_standalone, evaluate_programs_standalone,
+                         get_effective_length)
+
+
+def analyze_state(state, args):
+    """상태 하나의 후보 생성 + 몬테카를로 평가 → (프로그램, 평균, 표준편차) 평균 내림차순"""
+    programs = []
+    seen = set()
+    for p in generate_running_max_standalone(args.group_size, state, args.cpp_threads):
+        if tuple(p) not in seen:
+            seen.add(tuple(p))
+            programs.append(p)
+
+    totals = np.zeros((args.sims, len(programs)), dtype=np.float64)
+    for r in range(args.sims):
+        results = evaluate_programs_standalone(programs, state, args.cpp_threads)
+        totals[r] = [res['total_score'] for res in results]
+    means = totals.mean(axis=0)
+    stds = totals.std(axis=0)
+
+    order = sorted(range(len(programs)), key=lambda i: (-means[i], get_effective_length(programs[i])))
+    order = order[:args.top_k]
+    return ([programs[i] for i in order], [float(means[i]) for i in order], [float(stds[i]) for i in order])
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build an opening book for the first runs of a game')
+    parser.add_argument('--level', type=int, default=3, help='Game level')
+    parser.add_argument('--max_runs', type=int, default=2, help='Book depth in runs')
+    parser.add_argument('--group_size', type=int, default=256, help='Running Max candidates per state')
+    parser.add_argument('--sims', type=int, default=64, help='Monte Carlo evaluations per candidate')
+    parser.add_argument('--rollouts', type=int, default=64, help='Best-program plays per state to find next states')
+    parser.add_argument('--min_visits', type=int, default=4, help='Rollout hits needed to expand a next state')
+    parser.add_argument('--top_k', type=int, default=8, help='Programs stored per state')
+    parser.add_argument('--cpp_threads', type=int, default=0, help='C++ threads (0 = auto)')
+    parser.add_argument('--output', type=str, default='opening_book.bin', help='Output book path')
+    args = parser.parse_args()
+
+    import cpp_simulator as cpp_sim
+    from cpp_simulator_adapter import LightweightGameSimulator
+
+    writer = cpp_sim.OpeningBookWriter(max_moves=args.top_k)
+    keyer = cpp_sim.OpeningBook()
+    game = LightweightGameSimulator(level=args.level)
+    game.reset()
+
+    start_time = time.time()
+    frontier = [(game.get_state_dict(), args.rollouts)]
+
+    print("=" * 70)
+    for depth in range(args.max_runs):
+        next_states = {}  # 정규화 키 → [상태, 방문 수]
+        for state, visits in frontier:
+            programs, means, stds = analyze_state(state, args)
+            writer.add(state, programs, means, stds, [args.sims] * len(programs), visits)
+
+            if depth + 1 < args.max_runs and programs:
+                best = [t for t in programs[0] if t != 112]
+                for _ in range(args.rollouts):
+                    game.restore_state(state)
+                    try:
+                        game.execute_program(best)
+                    except Exception:
+                        continue
+                    if game.win_sign or game.lose_sign:
+                        continue
+                    child = game.get_state_dict()
+                    entry = next_states.setdefault(keyer.key(child), [child, 0])
+                    entry[1] += 1
+
+        frontier = [(s, c) for s, c in next_states.values() if c >= args.min_visits]
+        print(f"런 {depth}: 북 {len(writer)} 상태 | 다음 깊이 후보 {len(next_states)}, 확장 {len(frontier)} | "
+              f"{time.time() - start_time:.1f}s")
+        if not frontier:
+            break
+
+    if not writer.save(args.output):
+        raise SystemExit(f"저장 실패: {args.output}")
+    print(f"저장: {args.output} ({len(writer)} 상태)")
+    print("=" * 70)
+
+
+if __name__ == '__main__':
+    main()
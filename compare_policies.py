@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+탐색 정책 토너먼트 (C++ run_tournament)
+
+정책마다 같은 시드 집합으로 게임을 반복 (공통 난수) → 승률 / 점수 분포 / 승리까지 런 수 / 결정당 시뮬레이션 수
+신뢰 구간은 95% (승률: Wilson, 나머지: 정규 근사), diff는 첫 정책 대비 같은 시드 게임끼리의 점수 차
+
+정책 지정: 종류:예산[:평가 반복]
+    rm:32        Running Max, 그룹 32
+    sampled:256  문법 유효 균등 샘플 256개 중 최고
+    sampled:256:4  (각 후보 4회 평균으로 선택)
+
+사용법:
+    python3 compare_policies.py --policy rm:16 --policy rm:32 --policy sampled:256 --games 200
+"""
+
+import os
+import sys
+import time
+import json
+import argparse
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+
+def parse_policy(spec, cpp_sim):
+    parts = spec.split(':')
+    kinds = {'rm': cpp_sim.SearchKind.RUNNING_MAX, 'sampled': cpp_sim.SearchKind.SAMPLED}
+    if parts[0] not in kinds or len(parts) < 2:
+        raise argparse.ArgumentTypeError(f"정책 형식 오류: {spec} (예: rm:32, sampled:256:4)")
+    evals = int(parts[2]) if len(parts) > 2 else 1
+    return cpp_sim.SearchPolicy(name=spec, kind=kinds[parts[0]], budget=int(parts[1]), evals=evals)
+
+
+def fmt(interval, digits=1):
+    mean, lo, hi = interval
+    return f"{mean:.{digits}f} [{lo:.{digits}f}, {hi:.{digits}f}]"
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare search policies on common random seeds')
+    parser.add_argument('--policy', action='append', required=True, help='kind:budget[:evals] (rm / sampled)')
+    parser.add_argument('--games', type=int, default=100, help='Games per policy')
+    parser.add_argument('--max_runs', type=int, default=20, help='Max runs per game')
+    parser.add_argument('--seed', type=int, default=0, help='Seed set (same for every policy)')
+    parser.add_argument('--threads', type=int, default=0, help='C++ threads (0 = auto)')
+    parser.add_argument('--output', type=str, default=None, help='Optional JSON report path')
+    args = parser.parse_args()
+
+    import cpp_simulator as cpp_sim
+
+    policies = [parse_policy(s, cpp_sim) for s in args.policy]
+    start = time.time()
+    reports = cpp_sim.run_tournament(policies, games=args.games, max_runs=args.max_runs,
+                                     seed=args.seed, num_threads=args.threads)
+    elapsed = time.time() - start
+
+    print("=" * 100)
+    print(f"토너먼트: 정책 {len(policies)}개 x {args.games}게임 (seed {args.seed}) | {elapsed:.1f}s")
+    print("=" * 100)
+    for r in reports:
+        q = r['score_quantiles']
+        print(f"{r['name']:>16} | 승률 {fmt(r['win_rate'], 3)} | 점수 {fmt(r['score'])} "
+              f"(p10 {q[0]:.0f} / p50 {q[2]:.0f} / p90 {q[4]:.0f}) | "
+              f"승리 런 {fmt(r['runs_to_win'], 2)} | 시뮬/결정 {r['sims_per_decision']:.0f} | "
+              f"diff {fmt(r['score_diff'])}")
+    print("=" * 100)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump({'args': vars(args), 'elapsed': elapsed, 'reports': reports}, f, indent=1)
+        print(f"저장: {args.output}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,90 @@
+// ============================================================
+// 네이티브 시뮬레이터 벤치마크
+//
+// 빌드:
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON
+//   cmake --build build --target bench_simulator
+// 실행:
+//   ./build/bench_simulator [n_programs] [repeats]
+// ============================================================
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "simulator.hpp"
+
+using namespace simulator;
+
+namespace {
+
+// 벤치마크용 랜덤 프로그램 (방향 / LOOP / IF / 함수 혼합)
+std::vector<std::vector<int>> make_programs(int n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::vector<int>> programs(n);
+    for (auto& prog : programs) {
+        int len = 3 + rng() % 8;
+        for (int t = 0; t < len; t++) {
+            int r = rng() % 10;
+            if (r < 4) {
+                prog.push_back(rng() % 4);
+            } else if (r < 7) {
+                prog.push_back(Token::LOOP);
+                prog.push_back(Token::NUM_BASE + rng() % 10);
+                prog.push_back(rng() % 4);
+            } else if (r < 8) {
+                prog.push_back(Token::IF);
+                prog.push_back(Token::NUM_1 + rng() % 7);
+                prog.push_back(rng() % 4);
+            } else {
+                prog.push_back(Token::FUNC_LIB_START + rng() % 50);
+            }
+        }
+        prog.push_back(Token::END);
+    }
+    return programs;
+}
+
+const char* policy_name(MovePolicy p) {
+    switch (p) {
+        case MovePolicy::FLEE:  return "flee";
+        case MovePolicy::CHASE: return "chase";
+        default:                return "random";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int n_programs = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    Simulator sim(3);
+    sim.initialize_cache();
+    auto programs = make_programs(n_programs, 42);
+
+    const MovePolicy policies[] = {MovePolicy::RANDOM, MovePolicy::FLEE, MovePolicy::CHASE};
+
+    std::printf("%-8s %-8s %12s %12s\n", "cat", "crzbc", "sims/sec", "avg_score");
+    for (MovePolicy cat_p : policies) {
+        for (MovePolicy crzbc_p : policies) {
+            double best_rate = 0.0;
+            double score_sum = 0.0;
+            for (int r = 0; r < repeats; r++) {
+                score_sum = 0.0;
+                auto t0 = std::chrono::steady_clock::now();
+                for (const auto& prog : programs) {
+                    score_sum += sim.simulate_program(prog, cat_p, crzbc_p);
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                double sec = std::chrono::duration<double>(t1 - t0).count();
+                if (sec > 0) best_rate = std::max(best_rate, n_programs / sec);
+            }
+            std::printf("%-8s %-8s %12.0f %12.2f\n", policy_name(cat_p), policy_name(crzbc_p),
+                        best_rate, score_sum / n_programs);
+        }
+    }
+    return 0;
+}
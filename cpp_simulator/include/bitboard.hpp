@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include "constants.hpp"
+#include "game_state.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 121칸 비트보드 (칸 번호 = x * MAP_SIZE + y, lo: 0-63, hi: 64-120)
+// ============================================================
+struct CellMask {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    void set(int cell) {
+        if (cell < 64) lo |= 1ULL << cell;
+        else hi |= 1ULL << (cell - 64);
+    }
+    void reset(int cell) {
+        if (cell < 64) lo &= ~(1ULL << cell);
+        else hi &= ~(1ULL << (cell - 64));
+    }
+    bool test(int cell) const {
+        return cell < 64 ? (lo >> cell) & 1ULL : (hi >> (cell - 64)) & 1ULL;
+    }
+
+    int count() const { return __builtin_popcountll(lo) + __builtin_popcountll(hi); }
+    bool any() const { return (lo | hi) != 0; }
+
+    CellMask operator&(const CellMask& o) const { return CellMask{lo & o.lo, hi & o.hi}; }
+    CellMask operator|(const CellMask& o) const { return CellMask{lo | o.lo, hi | o.hi}; }
+    bool operator==(const CellMask& o) const { return lo == o.lo && hi == o.hi; }
+
+    // 값이 0이 아닌 칸 (예: sc 그리드 → 남은 치즈)
+    static CellMask from_grid(const GridMap& g) {
+        CellMask m;
+        for (int i = 0; i < MAP_SIZE; i++) {
+            for (int j = 0; j < MAP_SIZE; j++) {
+                if (g[i][j]) m.set(i * MAP_SIZE + j);
+            }
+        }
+        return m;
+    }
+};
+
+} // namespace simulator
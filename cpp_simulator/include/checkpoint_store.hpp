@@ -0,0 +1,96 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game_state.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 생성 작업 체크포인트 (진행 중 게임 + RNG + 출력 오프셋 + 카운터)
+// - 갱신은 메모리 스냅샷만 바꾸고, 백그라운드 스레드가 interval마다 변경분을 파일로 씀
+// - 쓰기는 원자적: path.tmp에 쓰고 fsync → rename → 디렉터리 fsync (중간에 죽어도 이전 파일 유지)
+// - 파일: 매직 / 버전 / 본문 길이 / 본문 / FNV-1a 64 체크섬, 손상되면 load 실패
+// 상태는 StateCodec 레코드, RNG / payload는 호출자가 직렬화한 불투명 바이트
+// ============================================================
+class CheckpointStore {
+public:
+    // 진행 중 게임 하나 (슬롯 = 호출자가 정한 번호)
+    struct GameSlot {
+        int64_t game_id = -1;
+        int32_t run = 0;             // 다음에 실행할 런
+        bool finished = false;       // 게임 종료 (결과는 payload에)
+        GameState state;
+        std::string rng;             // RNG 스트림 상태
+        std::string payload;         // 완료된 런 데이터 등
+    };
+
+    // interval_sec <= 0이면 백그라운드 스레드 없이 flush()로만 씀
+    explicit CheckpointStore(std::string path, double interval_sec = 5.0);
+    ~CheckpointStore();
+
+    CheckpointStore(const CheckpointStore&) = delete;
+    CheckpointStore& operator=(const CheckpointStore&) = delete;
+
+    // ========== 갱신 (메모리, 스레드 안전) ==========
+
+    void set_counter(const std::string& name, int64_t value);
+    void set_shard(const std::string& name, uint64_t offset);  // 출력 파일별 유효 바이트 수
+    void set_slot(int slot, const GameSlot& game);
+    void clear_slot(int slot);
+    void clear();
+
+    // ========== 조회 ==========
+
+    std::map<std::string, int64_t> counters() const;
+    std::map<std::string, uint64_t> shards() const;
+    bool get_slot(int slot, GameSlot& out) const;
+    std::vector<int> slot_ids() const;
+
+    // ========== 파일 ==========
+
+    // 변경분이 있으면 즉시 원자적 쓰기 (성공 / 변경 없음 = true)
+    bool flush();
+    // 파일에서 읽어 메모리 교체 (없거나 손상 = false, 메모리 유지)
+    bool load();
+    // 백그라운드 스레드 정지 + 마지막 flush
+    void close();
+
+    const std::string& path() const { return path_; }
+    uint64_t writes() const;
+
+private:
+    struct Snapshot {
+        std::map<std::string, int64_t> counters;
+        std::map<std::string, uint64_t> shards;
+        std::map<int, GameSlot> slots;
+    };
+
+    std::string path_;
+    double interval_sec_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    Snapshot data_;
+    uint64_t version_ = 0;          // 메모리 변경 횟수
+    uint64_t written_version_ = 0;  // 마지막으로 파일에 쓴 version_
+    uint64_t writes_ = 0;
+    bool stop_ = false;
+
+    std::mutex write_mutex_;        // 파일 쓰기 직렬화 (백그라운드 / flush)
+    std::thread writer_;
+
+    void touch_locked() { version_++; }
+    void writer_loop();
+
+    static std::string serialize(const Snapshot& snap);
+    static bool deserialize(const std::string& bytes, Snapshot& snap);
+    static bool write_atomic(const std::string& path, const std::string& bytes);
+};
+
+} // namespace simulator
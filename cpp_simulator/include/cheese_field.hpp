@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "constants.hpp"
+#include "game_state.hpp"
+#include "bitboard.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 가장 가까운 남은 작은 치즈까지의 거리장 (다중 출발 BFS, 벽 통과 불가, 4방향)
+// lightweight_simulator._compute_cheese_distances_bfs와 같은 값 (도달 불가 = NONE)
+// 치즈는 줄기만 하므로 한 칸을 먹으면 그 치즈에만 기대던 칸만 찾아 다시 계산
+// (거리 순으로 지지 칸을 잃은 영역 표시 → 경계 거리에서 시작하는 BFS로 복구)
+// 조회는 O(1) 배열 읽기, 읽기 전용 조회만 스레드 안전
+// ============================================================
+class CheeseDistanceField {
+public:
+    static constexpr uint8_t NONE = 255;   // 남은 치즈 없음 / 도달 불가
+
+    CheeseDistanceField();
+
+    // 상태 반영: 맵이 같고 치즈가 줄기만 했으면 먹은 칸만 eat_cheese, 아니면 전체 BFS
+    void set_state(const GameState& state);
+
+    // 치즈 한 칸 제거 (이미 없으면 무시)
+    void eat_cheese(const Position& p);
+
+    uint8_t distance(const Position& p) const { return dist_[p.x * MAP_SIZE + p.y]; }
+    uint8_t at(int cell) const { return dist_[cell]; }
+    const std::array<uint8_t, TOTAL_CELLS>& distances() const { return dist_; }
+    const CellMask& cheese() const { return cheese_; }
+
+    // 누적 통계: 전체 BFS 횟수 / 제거 수 / 제거 때 다시 계산한 칸 수
+    uint64_t rebuilds() const { return rebuilds_; }
+    uint64_t removals() const { return removals_; }
+    uint64_t repaired_cells() const { return repaired_; }
+
+private:
+    GridMap wall_;
+    bool has_map_ = false;
+    CellMask cheese_;
+    std::array<uint8_t, TOTAL_CELLS> dist_;
+
+    uint64_t rebuilds_ = 0;
+    uint64_t removals_ = 0;
+    uint64_t repaired_ = 0;
+
+    bool open(int cell) const { return !wall_[cell / MAP_SIZE][cell % MAP_SIZE]; }
+    void rebuild();
+};
+
+} // namespace simulator
@@ -109,10 +109,36 @@ namespace Config {
     constexpr int DEFAULT_STEP_LIMIT = 200;
     constexpr int DEFAULT_RED_ZONE = 5;
     constexpr int DEFAULT_FUNC_CHANCE = 4;
+    constexpr int MAX_RUNS = 20;          // 이 런 수까지 못 이기면 패배 (exe3.py)
+    // 레벨 3 기본 엔티티 수
     constexpr int NUM_CATS = 2;
     constexpr int NUM_MOVBC = 2;
     constexpr int NUM_CRZBC = 2;
+    // 엔티티 최대 수 (상태 벡터: 고양이 6칸, 빅치즈 5칸 예약)
+    constexpr int MAX_CATS = 6;
+    constexpr int MAX_MOVBC = 5;
+    constexpr int MAX_CRZBC = 5;
     constexpr int MAX_RANDOM_TRIES = 100;
 }
 
+// ============================================================
+// 828차원 상태 벡터 레이아웃 (game_worker.get_state_vector_list와 동일)
+// [0, 484)    wall / sc / junc / deadend 그리드 (각 121, 행 우선)
+// [484, 486)  마우스 (x, y)
+// [486, 498)  고양이 6칸 (x, y), 없으면 -1
+// [498, 508)  미친 빅치즈 5칸 (x, y), 없으면 -1
+// [549, 555)  스칼라 (score, life, run, win, lose, step)
+// ============================================================
+namespace StateVec {
+    constexpr int DIM = 828;
+    constexpr int NUM_GRIDS = 4;
+    constexpr int GRID_OFFSET = 0;
+    constexpr int MOUSE_OFFSET = NUM_GRIDS * TOTAL_CELLS;                 // 484
+    constexpr int CAT_OFFSET = MOUSE_OFFSET + 2;                          // 486
+    constexpr int CRZBC_OFFSET = CAT_OFFSET + 2 * Config::MAX_CATS;       // 498
+    constexpr int NUM_POSITIONS = 1 + Config::MAX_CATS + Config::MAX_CRZBC;
+    constexpr int SCALAR_OFFSET = MOUSE_OFFSET + 65;                      // 549
+    constexpr float DYNAMIC_SCALE = 10.0f;
+}
+
 } // namespace simulator
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "constants.hpp"
+#include "game_state.hpp"
+#include "cheese_field.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 보조 특징 벡터 (lightweight_simulator.get_state_vector와 같은 828차원 배치)
+// Spatial 484 | Entity 65 | GameState 279, 히스토리 / 예측 / 클러스터 항목은 0
+// ============================================================
+namespace FeatureVec {
+    constexpr int DIM = 828;
+    constexpr int GRID_OFFSET = 0;
+    constexpr int MOUSE_OFFSET = 4 * TOTAL_CELLS;          // 484: mouse 2 + dir 1
+    constexpr int CAT_OFFSET = MOUSE_OFFSET + 3;           // 487: 위치 4 + 방향 2
+    constexpr int MOVBC_OFFSET = CAT_OFFSET + 6;           // 493
+    constexpr int CRZBC_OFFSET = MOVBC_OFFSET + 4;         // 497
+    constexpr int NEAREST_BC_OFFSET = CRZBC_OFFSET + 4;    // 501: 원핫 4
+    constexpr int BC_FUTURE_OFFSET = NEAREST_BC_OFFSET + 4 + 16 + 12;  // 533: movbc + crzbc 8
+    constexpr int ESCAPE_OFFSET = BC_FUTURE_OFFSET + 8;    // 541: 고양이별 원핫 4 x 2
+    constexpr int SCALAR_OFFSET = ESCAPE_OFFSET + 8;       // 549: life, score, step, func_chance, run
+    constexpr int BC_DIST_OFFSET = SCALAR_OFFSET + 5;      // 554
+    constexpr int BC_THREAT_OFFSET = BC_DIST_OFFSET + 4;   // 558
+    constexpr int NEAREST_BC_IDX_OFFSET = BC_THREAT_OFFSET + 4;         // 562
+    constexpr int CHEESE_DIST_OFFSET = NEAREST_BC_IDX_OFFSET + 1;       // 563
+    constexpr int CAT_THREAT_OFFSET = CHEESE_DIST_OFFSET + TOTAL_CELLS; // 684
+    constexpr int REGION_OFFSET = CAT_THREAT_OFFSET + TOTAL_CELLS + 10; // 815
+    constexpr int NUM_REGIONS = 5;
+}
+
+// ========== 개별 커널 (Python _compute_* 함수와 같은 정의) ==========
+
+// 고양이별 도망 방향 원핫 (8): 벽 아닌 이웃 중 고양이와 맨해튼 거리 최대 (동률은 상하좌우 순 첫 방향)
+void cat_escape_directions(const GameState& state, float* out);
+
+// 가장 가까운 치즈까지 BFS 거리 / 20 (121), 도달 불가 = 999 / 20
+void cheese_distance_features(const CheeseDistanceField& field, float* out);
+
+// 고양이 위협도 (121): 맨해튼 거리 3 이내 (4 - d) / 4 합, 1로 자름
+void cat_threat_map(const GameState& state, float* out);
+
+// 구역별 치즈 비율 (5): 좌상 / 우상 / 좌하 / 우하 (5x5) / 가운데 십자
+void region_cheese_distribution(const GameState& state, float* out);
+
+// 전체 828차원 (field는 state로 동기화, 같은 게임의 연속 상태면 먹은 치즈만 복구)
+void encode_feature_vector(const GameState& state, CheeseDistanceField& field, float* out);
+
+} // namespace simulator
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "game_state.hpp"
+#include "bitboard.hpp"
+#include "simulator.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 상태별 함수 라이브러리 순위 인덱스
+// 마우스 칸에서 라이브러리 함수 전체를 전개 (엔티티 무시) → 치즈 수↓, 벽 충돌↑, ID↑ 순
+// - 전개 경로(방문 칸 비트보드)는 맵 + 시작 칸마다 한 번만 계산 (맵이 바뀌면 초기화)
+// - 치즈를 먹으면 그 칸을 지나는 함수만 치즈 수 감소 → 거의 정렬된 순서를 삽입 정렬로 복구
+// 읽기/갱신 모두 내부 상태를 바꾸므로 스레드별로 하나씩 사용
+// ============================================================
+class FunctionIndex {
+public:
+    struct Entry {
+        int func_id;
+        int cheese;       // 경로 위 남은 치즈 칸 수
+        int wall_hits;    // 벽 충돌 액션 수
+        int moves;        // 실제 이동 수
+        Position end;     // 전개 후 마우스 위치
+    };
+
+    FunctionIndex();
+
+    // 상태 반영: 맵이 같으면 경로 캐시 재사용, 마우스 칸 / 치즈 기준으로 순위 재계산
+    void set_state(const GameState& state);
+
+    // 치즈 한 칸 제거 (이미 없으면 무시)
+    void eat_cheese(const Position& p);
+
+    // 상위 n개 (distinct: 본문이 같은 함수는 가장 작은 ID만)
+    std::vector<Entry> top(int n, bool distinct = true);
+    std::vector<int> top_ids(int n, bool distinct = true);
+
+    // 개별 함수 항목 (라이브러리에 없으면 nullptr)
+    const Entry* find(int func_id) const;
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    // 시작 칸 기준 함수 전개 결과 (맵 고정)
+    struct Expansion {
+        CellMask visited;
+        int16_t wall_hits;
+        int16_t moves;
+        Position end;
+    };
+
+    Simulator sim_;                   // 전개용 (엔티티 없는 상태)
+    std::vector<int> func_ids_;       // 라이브러리 ID (오름차순)
+    std::vector<int16_t> slot_of_;    // func_id - FUNC_LIB_START → func_ids_ 인덱스 (-1 = 없음)
+    std::vector<uint8_t> duplicate_;  // 본문이 같은 더 작은 ID가 있으면 1
+    std::array<std::vector<Expansion>, TOTAL_CELLS> paths_;  // 시작 칸별 (지연 계산)
+
+    GridMap wall_;
+    GridMap junc_;
+    bool has_map_ = false;
+    int cell_ = -1;                   // 현재 마우스 칸
+    CellMask cheese_;
+
+    std::vector<Entry> entries_;      // func_ids_ 순서
+    std::vector<int> order_;          // entries_ 인덱스, 순위 순
+    bool dirty_ = false;
+
+    const std::vector<Expansion>& expansions(int cell);
+    bool ranks_before(int a, int b) const;
+    void resort();
+};
+
+} // namespace simulator
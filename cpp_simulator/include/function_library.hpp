@@ -1,33 +1,105 @@
 #pragma once
 
 #include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
 #include <unordered_map>
+#include "constants.hpp"
 
 namespace simulator {
 
+// 기본 함수 테이블은 프로세스당 한 번만 만들고 모든 인스턴스가 공유 (읽기 전용)
+// load_flat으로 바꿀 때만 자기 사본을 만듦 (copy-on-write, 공유 테이블은 수정하지 않음)
 class FunctionLibrary {
 public:
-    FunctionLibrary() {
-        init_functions();
-    }
+    using Table = std::unordered_map<int, std::vector<int>>;
+
+    FunctionLibrary() : library_(default_table()) {}
 
     const std::vector<int>& get_function(int func_id) const {
-        auto it = library_.find(func_id);
-        if (it != library_.end()) {
+        auto it = library_->find(func_id);
+        if (it != library_->end()) {
             return it->second;
         }
         return EMPTY_FUNC;
     }
 
     bool has_function(int func_id) const {
-        return library_.find(func_id) != library_.end();
+        return library_->find(func_id) != library_->end();
+    }
+
+    size_t size() const { return library_->size(); }
+
+    // 전체 함수 순회 f(func_id, body) - 순서 보장 없음
+    template <class F>
+    void for_each_function(F&& f) const {
+        for (const auto& kv : *library_) {
+            f(kv.first, kv.second);
+        }
+    }
+
+    // ========== 평면 형식 [id, len, t1..tlen, id, len, ...] (ID 오름차순) ==========
+
+    std::vector<int> to_flat() const {
+        std::vector<int> ids;
+        for (const auto& kv : *library_) ids.push_back(kv.first);
+        std::sort(ids.begin(), ids.end());
+        std::vector<int> flat;
+        for (int id : ids) {
+            const auto& body = library_->at(id);
+            flat.push_back(id);
+            flat.push_back(static_cast<int>(body.size()));
+            flat.insert(flat.end(), body.begin(), body.end());
+        }
+        return flat;
+    }
+
+    // 평면 형식 함수 등록 (같은 ID는 덮어씀). 형식 / ID 범위가 잘못되면 아무것도 바꾸지 않고 false
+    bool load_flat(const std::vector<int>& flat) {
+        size_t i = 0;
+        while (i < flat.size()) {
+            if (i + 1 >= flat.size() || !Token::is_func_lib(flat[i]) || flat[i + 1] <= 0) return false;
+            i += 2 + flat[i + 1];
+            if (i > flat.size()) return false;
+        }
+        // 다른 인스턴스와 공유 중일 수 있으므로 항상 사본을 고친 뒤 교체
+        auto table = std::make_shared<Table>(*library_);
+        for (i = 0; i < flat.size(); i += 2 + flat[i + 1]) {
+            (*table)[flat[i]].assign(flat.begin() + i + 2, flat.begin() + i + 2 + flat[i + 1]);
+        }
+        library_ = std::move(table);
+        return true;
+    }
+
+    // 본문이 더 작은 ID와 같은 ID (새 함수로 재사용 가능), 오름차순
+    std::vector<int> redundant_ids() const {
+        std::vector<int> ids;
+        for (const auto& kv : *library_) ids.push_back(kv.first);
+        std::sort(ids.begin(), ids.end());
+        std::map<std::vector<int>, int> seen;
+        std::vector<int> result;
+        for (int id : ids) {
+            if (!seen.emplace(library_->at(id), id).second) result.push_back(id);
+        }
+        return result;
     }
 
 private:
-    std::unordered_map<int, std::vector<int>> library_;
+    std::shared_ptr<const Table> library_;   // 공유 읽기 전용, load_flat은 새 테이블로 교체
     static const std::vector<int> EMPTY_FUNC;
 
-    void init_functions() {
+    // 정적 초기화는 스레드 안전 (C++11)
+    static const std::shared_ptr<Table>& default_table() {
+        static const std::shared_ptr<Table> table = [] {
+            auto t = std::make_shared<Table>();
+            init_functions(*t);
+            return t;
+        }();
+        return table;
+    }
+
+    static void init_functions(Table& library_) {
         library_[113] = {1, 2};
         library_[114] = {3, 2};
         library_[115] = {2, 1, 2};
@@ -44,17 +44,80 @@ struct Position {
 };
 
 // ============================================================
-// 엔티티 (고양이, 빅치즈)
+// 엔티티 배열 (고양이, 빅치즈) - Struct of Arrays
+// 런타임 개수(count) + 컴파일 타임 최대치(MAX_N)
+// 사용하지 않는 슬롯은 (-1, -1), active = 0 으로 유지
+// → 충돌 체크는 고정 길이 루프로 벡터화 가능
 // ============================================================
-struct Entity {
-    Position pos;
-    Position last_pos;
-    int8_t direction;
-    bool active;  // 빅치즈: false면 이미 먹힘
+template <int MAX_N>
+struct EntityArray {
+    static constexpr int MAX = MAX_N;
+
+    std::array<int8_t, MAX_N> x;
+    std::array<int8_t, MAX_N> y;
+    std::array<int8_t, MAX_N> last_x;
+    std::array<int8_t, MAX_N> last_y;
+    std::array<int8_t, MAX_N> direction;
+    std::array<uint8_t, MAX_N> active;  // 빅치즈: 0이면 이미 먹힘
+    int8_t count;
+
+    EntityArray() { clear(); }
+
+    void clear() {
+        x.fill(-1);
+        y.fill(-1);
+        last_x.fill(-1);
+        last_y.fill(-1);
+        direction.fill(0);
+        active.fill(0);
+        count = 0;
+    }
+
+    // 엔티티 추가 (최대치 초과 시 -1)
+    int add(const Position& p, int8_t dir = 0) {
+        if (count >= MAX_N) return -1;
+        int i = count++;
+        x[i] = p.x;
+        y[i] = p.y;
+        last_x[i] = p.x;
+        last_y[i] = p.y;
+        direction[i] = dir;
+        active[i] = 1;
+        return i;
+    }
+
+    Position pos(int i) const { return Position(x[i], y[i]); }
+    Position last_pos(int i) const { return Position(last_x[i], last_y[i]); }
+
+    void set_pos(int i, const Position& p) { x[i] = p.x; y[i] = p.y; }
+    void set_last_pos(int i, const Position& p) { last_x[i] = p.x; last_y[i] = p.y; }
+
+    // 위치 p에 있는 활성 엔티티 비트마스크
+    uint32_t mask_at(const Position& p) const {
+        uint32_t mask = 0;
+        for (int i = 0; i < MAX_N; i++) {
+            uint32_t hit = (x[i] == p.x) & (y[i] == p.y) & (active[i] != 0);
+            mask |= hit << i;
+        }
+        return mask;
+    }
 
-    Entity() : pos(), last_pos(), direction(0), active(true) {}
+    // p_last → p 로 이동한 대상과 교차(crossing)한 활성 엔티티 비트마스크
+    uint32_t mask_crossing(const Position& p, const Position& p_last) const {
+        uint32_t mask = 0;
+        for (int i = 0; i < MAX_N; i++) {
+            uint32_t hit = (x[i] == p_last.x) & (y[i] == p_last.y) &
+                           (last_x[i] == p.x) & (last_y[i] == p.y) & (active[i] != 0);
+            mask |= hit << i;
+        }
+        return mask;
+    }
 };
 
+using CatArray = EntityArray<Config::MAX_CATS>;
+using MovbcArray = EntityArray<Config::MAX_MOVBC>;
+using CrzbcArray = EntityArray<Config::MAX_CRZBC>;
+
 // ============================================================
 // 게임 상태 (Python LightweightGameSimulator와 1:1 대응)
 // ============================================================
@@ -68,9 +131,9 @@ struct GameState {
     // ========== 엔티티 ==========
     Position mouse;
     Position mouse_last;
-    std::array<Entity, Config::NUM_CATS> cats;      // 고양이 2마리
-    std::array<Entity, Config::NUM_MOVBC> movbc;    // 이동 빅치즈 2개
-    std::array<Entity, Config::NUM_CRZBC> crzbc;    // 미친 빅치즈 2개
+    CatArray cats;      // 고양이 (레벨 3: 2마리)
+    MovbcArray movbc;   // 이동 빅치즈 (레벨 3: 2개)
+    CrzbcArray crzbc;   // 미친 빅치즈 (레벨 3: 2개)
 
     // ========== 게임 상태 ==========
     int32_t score;
@@ -106,15 +169,9 @@ struct GameState {
         mouse = Position(10, 10);
         mouse_last = Position(10, 10);
 
-        for (int i = 0; i < Config::NUM_CATS; i++) {
-            cats[i] = Entity();
-        }
-        for (int i = 0; i < Config::NUM_MOVBC; i++) {
-            movbc[i] = Entity();
-        }
-        for (int i = 0; i < Config::NUM_CRZBC; i++) {
-            crzbc[i] = Entity();
-        }
+        cats.clear();
+        movbc.clear();
+        crzbc.clear();
 
         // 상태 초기화
         score = 0;
@@ -212,35 +269,16 @@ struct GameState {
         sc[10][10] = 0;  // 시작 위치 치즈 제거
 
         // 고양이 초기 위치
-        cats[0].pos = Position(2, 2);
-        cats[0].last_pos = Position(2, 2);
-        cats[0].direction = Direction::DOWN;
-        cats[0].active = true;
-
-        cats[1].pos = Position(5, 5);
-        cats[1].last_pos = Position(5, 5);
-        cats[1].direction = Direction::RIGHT;
-        cats[1].active = true;
+        cats.add(Position(2, 2), Direction::DOWN);
+        cats.add(Position(5, 5), Direction::RIGHT);
 
         // 이동 빅치즈 초기 위치
-        movbc[0].pos = Position(1, 5);
-        movbc[0].last_pos = Position(1, 5);
-        movbc[0].active = true;
-
-        movbc[1].pos = Position(7, 5);
-        movbc[1].last_pos = Position(7, 5);
-        movbc[1].active = true;
+        movbc.add(Position(1, 5));
+        movbc.add(Position(7, 5));
 
         // 미친 빅치즈 (초기 위치는 시뮬레이션에서 랜덤 설정)
-        crzbc[0].pos = Position(0, 3);
-        crzbc[0].last_pos = Position(0, 3);
-        crzbc[0].direction = Direction::RIGHT;
-        crzbc[0].active = true;
-
-        crzbc[1].pos = Position(10, 7);
-        crzbc[1].last_pos = Position(10, 7);
-        crzbc[1].direction = Direction::LEFT;
-        crzbc[1].active = true;
+        crzbc.add(Position(0, 3), Direction::RIGHT);
+        crzbc.add(Position(10, 7), Direction::LEFT);
     }
 
     // ========== 남은 치즈 개수 ==========
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "game_state.hpp"
+#include "move_policy.hpp"
+#include "program_grammar.hpp"
+#include "rules.hpp"
+
+namespace simulator {
+
+// ============================================================
+// GRPO 그룹 샘플러 (정책 확률표 → 문법 유효 프로그램 G개 샘플 + 점수 + 그룹 정규화 이점)
+// 확률표 probs[position][slot][vocab] (행 우선)
+// - n_slots == 1: 위치별 확률 (L, V)
+// - n_slots == ProgramGrammar::NUM_SLOTS: 위치 + 문법 슬롯별 확률 (L, 5, V)
+// 위치 L 이상은 마지막 행 재사용 (L = 1이면 위치 무관 분포)
+// 각 위치에서 문법상 허용된 토큰만 남겨 재정규화 후 샘플 (허용 토큰 확률 합이 0이면 균등)
+// 샘플 g는 (seed, g)로 정해지는 RNG만 사용 → 스레드 수와 무관하게 재현
+// ============================================================
+struct GroupSamplerConfig {
+    int group_size = 16;
+    int max_tokens = 10;         // END 제외 본문 토큰 수 한도
+    float temperature = 1.0f;    // p^(1/T)
+    uint64_t seed = 0;
+    int num_threads = 0;         // 0 = 자동 감지
+    MovePolicy cat_policy = MovePolicy::RANDOM;
+    MovePolicy crzbc_policy = MovePolicy::RANDOM;
+    std::vector<int> functions;  // 평면 형식 함수 교체 (batch_simulate와 동일)
+    RuleSet rules;
+};
+
+struct GroupSample {
+    std::vector<std::vector<int>> programs;            // END 포함
+    std::vector<std::vector<float>> token_log_probs;   // 실제 샘플한 (마스크 + 온도) 분포 기준
+    std::vector<float> log_probs;                      // 프로그램별 합
+    std::vector<float> scores;                         // 실행 후 점수 (batch_simulate와 동일)
+    std::vector<float> advantages;                     // (score - 평균) / (표준편차 + 1e-6), 편차 0이면 0
+};
+
+GroupSample sample_group(const GameState& state,
+                         const float* probs, int n_positions, int n_slots, int vocab,
+                         const GroupSamplerConfig& config);
+
+} // namespace simulator
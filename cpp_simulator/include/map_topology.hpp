@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "game_state.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 엔티티 전이 테이블
+// (칸, 진입 방향)별 유효한 출구 방향 목록과 개수를 미리 계산
+// - 진입 방향 0-3: 뒤로 가는 방향(OPPOSITE) 제외 (교차로 규칙)
+// - TRANSITION_ANY: 제한 없음 (막혔을 때 랜덤 방향)
+// 랜덤 스텝 = RNG 1회 + 테이블 조회 1회 (할당 없음)
+// 거절 샘플링과 같은 분포: 유효 방향 중 균등 선택
+// ============================================================
+constexpr int TRANSITION_ANY = Direction::COUNT;  // 4
+
+struct TransitionTable {
+    // dirs[cell][in_dir][k]: k번째 유효 출구 방향 (오름차순)
+    std::array<std::array<std::array<int8_t, Direction::COUNT>, Direction::COUNT + 1>, TOTAL_CELLS> dirs;
+    // count[cell][in_dir]: 유효 출구 방향 개수
+    std::array<std::array<uint8_t, Direction::COUNT + 1>, TOTAL_CELLS> count;
+
+    void build(const GridMap& wall) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            for (int y = 0; y < MAP_SIZE; y++) {
+                int cell = x * MAP_SIZE + y;
+                Position pos(x, y);
+                for (int in_dir = 0; in_dir <= TRANSITION_ANY; in_dir++) {
+                    int n = 0;
+                    for (int d = 0; d < Direction::COUNT; d++) {
+                        if (in_dir != TRANSITION_ANY && d == Direction::OPPOSITE[in_dir]) continue;
+                        Position next = pos.move(d);
+                        if (next.is_valid() && !wall[next.x][next.y]) {
+                            dirs[cell][in_dir][n++] = static_cast<int8_t>(d);
+                        }
+                    }
+                    for (int k = n; k < Direction::COUNT; k++) {
+                        dirs[cell][in_dir][k] = -1;
+                    }
+                    count[cell][in_dir] = static_cast<uint8_t>(n);
+                }
+            }
+        }
+    }
+
+    // 진입 방향 → 테이블 인덱스 (범위 밖이면 제한 없음)
+    static int slot(int in_dir) {
+        return (in_dir >= 0 && in_dir < Direction::COUNT) ? in_dir : TRANSITION_ANY;
+    }
+};
+
+// ============================================================
+// 복도 그래프 (직선 구간 단위)
+// 노드: 교차로(junc) 또는 직진 통과 칸이 아닌 열린 칸 (모서리, 막다른 길 등)
+// 간선: 노드에서 한 방향으로 다음 노드까지의 직선 복도 (길이 + 칸 목록)
+// 레이 테이블: (칸, 방향)별 벽까지 / 첫 교차로까지 직진 칸 수
+//  → 마우스 LOOP/IF 전개와 엔티티 복도 이동을 칸 단위가 아닌 구간 단위로 처리
+// ============================================================
+constexpr uint8_t RAY_NONE = 0xFF;
+
+struct CorridorGraph {
+    struct Edge {
+        int16_t from;         // 출발 노드
+        int16_t to;           // 도착 노드
+        int8_t dir;           // 진행 방향
+        uint8_t length;       // 칸 수
+        int16_t cell_offset;  // edge_cells 시작 위치 (출발 제외, 도착 포함 length칸)
+    };
+
+    // wall_run[cell][dir]: 벽 / 맵 끝 전까지 직진 가능한 칸 수
+    std::array<std::array<uint8_t, Direction::COUNT>, TOTAL_CELLS> wall_run;
+    // junc_run[cell][dir]: 직진해서 처음 교차로 칸에 도착하기까지 칸 수 (벽 전에 없으면 RAY_NONE)
+    std::array<std::array<uint8_t, Direction::COUNT>, TOTAL_CELLS> junc_run;
+
+    std::array<int16_t, TOTAL_CELLS> node_id;  // -1 = 노드 아님 (벽 또는 직진 통과 칸)
+    std::vector<int16_t> nodes;                // node → cell
+    std::vector<Edge> edges;
+    std::vector<int16_t> edge_cells;
+    std::vector<std::array<int16_t, Direction::COUNT>> node_edges;  // (node, dir) → edge (-1 = 없음)
+
+    void build(const GridMap& wall, const GridMap& junc) {
+        // 레이: 진행 방향 반대쪽부터 누적 (x/y 역순 스캔)
+        for (int dir = 0; dir < Direction::COUNT; dir++) {
+            int dx = Direction::DX[dir];
+            int dy = Direction::DY[dir];
+            for (int k = 0; k < TOTAL_CELLS; k++) {
+                // 진행 방향으로 먼 칸부터 처리해야 next 값이 준비됨
+                int x = dx > 0 ? MAP_SIZE - 1 - k / MAP_SIZE : k / MAP_SIZE;
+                int y = dy > 0 ? MAP_SIZE - 1 - k % MAP_SIZE : k % MAP_SIZE;
+                int cell = x * MAP_SIZE + y;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (nx < 0 || nx >= MAP_SIZE || ny < 0 || ny >= MAP_SIZE || wall[nx][ny]) {
+                    wall_run[cell][dir] = 0;
+                    junc_run[cell][dir] = RAY_NONE;
+                    continue;
+                }
+                int next = nx * MAP_SIZE + ny;
+                wall_run[cell][dir] = static_cast<uint8_t>(wall_run[next][dir] + 1);
+                if (junc[nx][ny]) {
+                    junc_run[cell][dir] = 1;
+                } else {
+                    uint8_t r = junc_run[next][dir];
+                    junc_run[cell][dir] = r == RAY_NONE ? RAY_NONE : static_cast<uint8_t>(r + 1);
+                }
+            }
+        }
+
+        // 노드: 열린 칸 중 교차로이거나 "정확히 반대 방향 두 곳만 열린" 칸이 아닌 칸
+        nodes.clear();
+        node_id.fill(-1);
+        for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+            int x = cell / MAP_SIZE;
+            int y = cell % MAP_SIZE;
+            if (wall[x][y]) continue;
+            const auto& r = wall_run[cell];
+            bool straight_ud = r[Direction::UP] && r[Direction::DOWN] && !r[Direction::LEFT] && !r[Direction::RIGHT];
+            bool straight_lr = r[Direction::LEFT] && r[Direction::RIGHT] && !r[Direction::UP] && !r[Direction::DOWN];
+            if (junc[x][y] || !(straight_ud || straight_lr)) {
+                node_id[cell] = static_cast<int16_t>(nodes.size());
+                nodes.push_back(static_cast<int16_t>(cell));
+            }
+        }
+
+        // 간선: 노드에서 각 열린 방향으로 다음 노드까지 (통과 칸은 직진만 가능하므로 반드시 도달)
+        edges.clear();
+        edge_cells.clear();
+        node_edges.assign(nodes.size(), {-1, -1, -1, -1});
+        for (size_t n = 0; n < nodes.size(); n++) {
+            int cell = nodes[n];
+            for (int dir = 0; dir < Direction::COUNT; dir++) {
+                if (wall_run[cell][dir] == 0) continue;
+                Edge e;
+                e.from = static_cast<int16_t>(n);
+                e.dir = static_cast<int8_t>(dir);
+                e.cell_offset = static_cast<int16_t>(edge_cells.size());
+                int cur = cell;
+                int len = 0;
+                do {
+                    cur += Direction::DX[dir] * MAP_SIZE + Direction::DY[dir];
+                    edge_cells.push_back(static_cast<int16_t>(cur));
+                    len++;
+                } while (node_id[cur] < 0);
+                e.to = node_id[cur];
+                e.length = static_cast<uint8_t>(len);
+                node_edges[n][dir] = static_cast<int16_t>(edges.size());
+                edges.push_back(e);
+            }
+        }
+    }
+
+    // 교차로가 아닌 칸에서 dir로 결정 없이 직진하는 칸 수
+    // (교차로에 도착하거나 벽에 막히기 직전까지)
+    int straight_run(int cell, int dir) const {
+        return std::min<int>(junc_run[cell][dir], wall_run[cell][dir]);
+    }
+};
+
+// ============================================================
+// 벽 / 교차로 기준 토폴로지 묶음 (만든 뒤 불변)
+// Simulator 복사 / fork 사이에서 shared_ptr로 공유, 맵이 바뀔 때만 새로 만듦
+// ============================================================
+struct MapTopology {
+    TransitionTable transitions;
+    CorridorGraph corridors;
+    GridMap wall;   // 테이블을 만든 벽 (변경 감지용)
+    GridMap junc;   // 테이블을 만든 교차로 (변경 감지용)
+
+    void build(const GridMap& wall_, const GridMap& junc_) {
+        transitions.build(wall_);
+        corridors.build(wall_, junc_);
+        wall = wall_;
+        junc = junc_;
+    }
+};
+
+} // namespace simulator
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <random>
+#include "constants.hpp"
+#include "game_state.hpp"
+#include "map_topology.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 거리 맵 / 다음 칸 테이블 타입
+// ============================================================
+using DistanceMap = std::array<std::array<int16_t, MAP_SIZE>, MAP_SIZE>;
+using NextHopMap = std::array<int8_t, TOTAL_CELLS>;  // 목표까지 최단 경로 첫 방향 (-1 = 없음)
+
+// ============================================================
+// 엔티티 이동 정책 (배치 단위 선택)
+// RANDOM: exe3.py 랜덤 워크 (기본값, 기존 동작)
+// FLEE:   Red Zone 안에서 마우스로부터 도망 (move_single_cat 로직)
+// CHASE:  다음 칸 테이블을 따라 마우스 추적
+// ============================================================
+enum class MovePolicy : int {
+    RANDOM = 0,
+    FLEE = 1,
+    CHASE = 2,
+};
+
+// 정지 액션 (사전 계산 액션 리스트에서 "이동 없음")
+constexpr int ACTION_STAY = -1;
+
+// ============================================================
+// 정책 컨텍스트: 현재 스텝의 마우스 위치 기준 정보
+// ============================================================
+struct MoveContext {
+    const GameState* state;
+    Position mouse;
+    const DistanceMap* mouse_dist;      // 마우스 기준 BFS 거리 (FLEE/CHASE만)
+    const NextHopMap* mouse_next_hop;   // 마우스로 가는 다음 방향 (CHASE만)
+    const TransitionTable* transitions; // (칸, 진입 방향) → 유효 출구 방향
+    const CorridorGraph* corridors;     // 직진 구간 길이 (복도 단위 이동)
+};
+
+namespace policy_detail {
+
+inline bool open_cell(const GameState& s, const Position& p) {
+    return p.is_valid() && s.wall[p.x][p.y] == 0;
+}
+
+// 전이 테이블에서 균등 선택 (유효 방향 없으면 현재 방향 유지값 반환)
+template <class Rng>
+inline int random_transition(const TransitionTable& t, int slot,
+                             Position& pos, int& dir, Rng& rng) {
+    int fallback = dir >= 0 && dir < Direction::COUNT ? dir : 0;
+    if (!pos.is_valid()) return fallback;
+    int cell = pos.x * MAP_SIZE + pos.y;
+    int n = t.count[cell][slot];
+    if (n == 0) return fallback;
+    std::uniform_int_distribution<> dist(0, n - 1);
+    int new_dir = t.dirs[cell][slot][dist(rng)];
+    pos = pos.move(new_dir);
+    dir = new_dir;
+    return new_dir;
+}
+
+// 막힌 경우 랜덤 방향 (exe3.py: 유효한 방향 중 균등)
+template <class Rng>
+inline int random_any(const MoveContext& ctx, Position& pos, int& dir, Rng& rng) {
+    return random_transition(*ctx.transitions, TRANSITION_ANY, pos, dir, rng);
+}
+
+// 교차로 랜덤 방향 (뒤로 가지 않음)
+template <class Rng>
+inline int random_forward(const MoveContext& ctx, Position& pos, int& dir, Rng& rng) {
+    return random_transition(*ctx.transitions, TransitionTable::slot(dir), pos, dir, rng);
+}
+
+} // namespace policy_detail
+
+// ============================================================
+// RANDOM: exe3.py _get_cats_direct_actions (마우스 추적 없음)
+// ============================================================
+struct RandomWalkPolicy {
+    static constexpr MovePolicy KIND = MovePolicy::RANDOM;
+    static constexpr bool NEEDS_MOUSE = false;
+    static constexpr bool CORRIDOR_RUNS = true;
+
+    // 교차로 밖에서 현재 방향으로 RNG 없이 확정되는 직진 칸 수 (0 = step() 필요)
+    static int corridor_run(const MoveContext& ctx, const Position& pos, int dir) {
+        if (dir < 0 || dir >= Direction::COUNT || !pos.is_valid()) return 0;
+        if (ctx.state->junc[pos.x][pos.y]) return 0;
+        return ctx.corridors->straight_run(pos.x * MAP_SIZE + pos.y, dir);
+    }
+
+    // pos/dir를 갱신하고 기록할 액션을 반환
+    template <class Rng>
+    static int step(const MoveContext& ctx, Position& pos, int& dir, Rng& rng) {
+        const GameState& s = *ctx.state;
+        if (s.junc[pos.x][pos.y]) {
+            return policy_detail::random_forward(ctx, pos, dir, rng);
+        }
+        Position next = pos.move(dir);
+        if (dir >= 0 && dir < Direction::COUNT && policy_detail::open_cell(s, next)) {
+            pos = next;
+            return dir;
+        }
+        return policy_detail::random_any(ctx, pos, dir, rng);
+    }
+};
+
+// ============================================================
+// FLEE: Red Zone 도망 (Python 고양이 도망 로직, 막다른 길 정지)
+// ============================================================
+struct FleePolicy {
+    static constexpr MovePolicy KIND = MovePolicy::FLEE;
+    static constexpr bool NEEDS_MOUSE = true;
+    static constexpr bool CORRIDOR_RUNS = false;  // 매 스텝 Red Zone 판정
+
+    template <class Rng>
+    static int step(const MoveContext& ctx, Position& pos, int& dir, Rng& rng) {
+        const GameState& s = *ctx.state;
+
+        // 막다른 길이면 정지
+        if (s.deadend[pos.x][pos.y]) {
+            return ACTION_STAY;
+        }
+
+        const DistanceMap& dist_map = *ctx.mouse_dist;
+        int16_t my_dist = dist_map[pos.x][pos.y];
+
+        // Red Zone: 거리가 늘어나는 방향 중 최대
+        if (my_dist > 0 && my_dist <= s.red_zone) {
+            int best_dir = -1;
+            int16_t max_dist = my_dist;
+            for (int d = 0; d < Direction::COUNT; d++) {
+                Position next = pos.move(d);
+                if (!policy_detail::open_cell(s, next)) continue;
+                int16_t next_dist = dist_map[next.x][next.y];
+                if (next_dist > max_dist) {
+                    max_dist = next_dist;
+                    best_dir = d;
+                }
+            }
+            if (best_dir >= 0) {
+                pos = pos.move(best_dir);
+                dir = best_dir;
+                return best_dir;
+            }
+        }
+
+        // 교차로: 랜덤 방향 (뒤로 가지 않음)
+        const TransitionTable& t = *ctx.transitions;
+        int cell = pos.x * MAP_SIZE + pos.y;
+        if (s.junc[pos.x][pos.y] && t.count[cell][TransitionTable::slot(dir)] > 0) {
+            return policy_detail::random_forward(ctx, pos, dir, rng);
+        }
+
+        // 현재 방향 유지
+        Position next = pos.move(dir);
+        if (policy_detail::open_cell(s, next)) {
+            pos = next;
+            return dir;
+        }
+
+        // 랜덤 방향 (못 찾으면 정지)
+        if (t.count[cell][TRANSITION_ANY] > 0) {
+            return policy_detail::random_any(ctx, pos, dir, rng);
+        }
+        return ACTION_STAY;
+    }
+};
+
+// ============================================================
+// CHASE: 마우스 방향 최단 경로 (다음 칸 테이블), 도달 불가 시 랜덤 워크
+// ============================================================
+struct ChasePolicy {
+    static constexpr MovePolicy KIND = MovePolicy::CHASE;
+    static constexpr bool NEEDS_MOUSE = true;
+    static constexpr bool CORRIDOR_RUNS = false;  // 매 스텝 마우스 방향
+
+    template <class Rng>
+    static int step(const MoveContext& ctx, Position& pos, int& dir, Rng& rng) {
+        if (pos.is_valid()) {
+            int hop = (*ctx.mouse_next_hop)[pos.x * MAP_SIZE + pos.y];
+            if (hop >= 0) {
+                pos = pos.move(hop);
+                dir = hop;
+                return hop;
+            }
+        }
+        return RandomWalkPolicy::step(ctx, pos, dir, rng);
+    }
+};
+
+// ============================================================
+// 거리 맵 → 다음 칸 테이블 (목표 칸으로 가는 첫 방향)
+// ============================================================
+inline void compute_next_hop(const DistanceMap& dist_map, NextHopMap& next_hop) {
+    for (int i = 0; i < MAP_SIZE; i++) {
+        for (int j = 0; j < MAP_SIZE; j++) {
+            int8_t hop = -1;
+            int16_t d = dist_map[i][j];
+            if (d > 1) {
+                for (int dir = 0; dir < Direction::COUNT; dir++) {
+                    int ni = i + Direction::DX[dir];
+                    int nj = j + Direction::DY[dir];
+                    if (ni < 0 || ni >= MAP_SIZE || nj < 0 || nj >= MAP_SIZE) continue;
+                    if (dist_map[ni][nj] == d - 1) {
+                        hop = static_cast<int8_t>(dir);
+                        break;
+                    }
+                }
+            }
+            next_hop[i * MAP_SIZE + j] = hop;
+        }
+    }
+}
+
+} // namespace simulator
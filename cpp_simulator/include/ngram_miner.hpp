@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "function_library.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 프로그램 단위 (문법 단위 = 함수 본문이 될 수 있는 최소 조각)
+// 방향 1토큰 / LOOP n d 3토큰 / IF n d 3토큰 → 1..72 기호 (0 = 구분자)
+// ============================================================
+namespace ProgramUnit {
+    constexpr int NUM_DIR = Direction::COUNT;                 // 1..4
+    constexpr int LOOP_BASE = 1 + NUM_DIR;                    // 5..44   (100..109 x 4)
+    constexpr int IF_BASE = LOOP_BASE + 10 * NUM_DIR;         // 45..72  (101..107 x 4)
+    constexpr int NUM_SYMBOLS = IF_BASE + 7 * NUM_DIR;        // 73 (0 포함)
+    constexpr int BITS = 7;                                   // 기호당 비트
+    constexpr int MAX_UNITS = 9;                              // 9 x 7 = 63비트 → 키 충돌 없음
+    constexpr int MAX_BODY_TOKENS = 10;                       // 기존 라이브러리 최대 본문 길이
+
+    int token_length(int sym);
+    void append_tokens(int sym, std::vector<int>& out);
+
+    // 토큰 → 단위 기호열. 함수 ID는 inline_functions면 파싱 규칙대로 본문 전개
+    // (처음 두 종류만, 세 번째 이후는 무시), 아니면 구분자. 잘못된 토큰도 구분자
+    void tokenize(const int* tokens, size_t n, const FunctionLibrary* inline_functions,
+                  std::vector<uint8_t>& units);
+}
+
+// ============================================================
+// 데이터셋 n-gram 채굴기
+// 토큰 n-gram (작성된 그대로) / 전개 n-gram (함수 본문 전개 후 실제 실행 순서)을
+// 단위 2..MAX_UNITS 길이로 셈. 키 = 단위 기호 7비트 패킹 (정확, 해시 충돌 없음)
+// add_programs는 OpenMP 스레드별 테이블에 센 뒤 병합 (호출 간 누적)
+// ============================================================
+class NgramMiner {
+public:
+    struct Candidate {
+        std::vector<int> body;   // 함수 본문 토큰
+        uint64_t gain;           // 압축 이득 (줄어드는 토큰 수 합)
+        uint32_t token_count;    // 토큰 스트림 출현 수 (프로그램 내 비중첩)
+        uint32_t programs;       // 토큰 스트림에 등장한 프로그램 수
+        uint32_t expanded_count; // 전개 스트림 출현 수 (프로그램 내 비중첩)
+    };
+
+    explicit NgramMiner(int max_units = ProgramUnit::MAX_UNITS);
+
+    // 프로그램 묶음 추가 (CSR: programs[offsets[i] .. offsets[i+1]))
+    void add_programs(const int* tokens, const int64_t* offsets, size_t n_programs,
+                      int num_threads = 0);
+
+    // 압축 이득 순 후보 (라이브러리에 이미 있는 본문 / 최소 프로그램 수 미만 제외)
+    std::vector<Candidate> candidates(size_t top_n, uint32_t min_programs = 2) const;
+
+    // 후보를 라이브러리의 재사용 가능 ID(중복 본문)에 배정한 평면 형식
+    std::vector<int> emit_flat(const std::vector<Candidate>& cands) const;
+
+    size_t num_programs() const { return num_programs_; }
+    size_t num_ngrams() const { return table_.size(); }
+
+    // 패킹 키 오픈 어드레싱 테이블 (키 0 = 빈 칸)
+    struct Counts {
+        uint64_t gain = 0;
+        uint32_t token_count = 0;
+        uint32_t programs = 0;
+        uint32_t expanded_count = 0;
+    };
+    class FlatTable {
+    public:
+        FlatTable() { rehash(1024); }
+        Counts& at(uint64_t key);
+        void merge(const FlatTable& other);
+        size_t size() const { return size_; }
+        template <class F>
+        void for_each(F&& f) const {
+            for (size_t i = 0; i < keys_.size(); i++) {
+                if (keys_[i]) f(keys_[i], vals_[i]);
+            }
+        }
+    private:
+        std::vector<uint64_t> keys_;
+        std::vector<Counts> vals_;
+        size_t size_ = 0;
+        void rehash(size_t capacity);
+    };
+
+private:
+    int max_units_;
+    FunctionLibrary lib_;
+    size_t num_programs_ = 0;
+    FlatTable table_;
+
+    void count_program(const int* tokens, size_t n, FlatTable& table,
+                       std::vector<uint8_t>& units, std::vector<std::pair<uint64_t, int>>& occ) const;
+};
+
+} // namespace simulator
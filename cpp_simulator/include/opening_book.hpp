@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "game_state.hpp"
+#include "symmetry.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 오프닝 북 (초반 런 상태 → 미리 계산한 top-K 프로그램 + 점수 통계)
+// 키 = 맵 대칭 정규화 상태 해시, 프로그램은 대표 상태 기준으로 저장하고 조회 시 원래 방향으로 복원
+// 파일 (리틀 엔디언, 읽기 전용 mmap):
+//   헤더 32B: "MAOB" / 버전 / 항목 수 / 수(move) 수 / 토큰 수
+//   항목 24B x N (키 오름차순): key / 첫 수 / 수 개수 / 방문 수
+//   수 24B x M (항목별 평균 점수 내림차순): 첫 토큰 / 토큰 수 / 평균 / 표준편차 / 시뮬레이션 수
+//   토큰 int16 x T
+// ============================================================
+namespace OpeningBookFormat {
+    constexpr char MAGIC[4] = {'M', 'A', 'O', 'B'};
+    constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t n_entries;
+        uint64_t n_moves;
+        uint64_t n_tokens;
+    };
+    struct Entry {
+        uint64_t key;
+        uint32_t first_move;
+        uint32_t n_moves;
+        uint32_t visits;
+        uint32_t reserved;
+    };
+    struct Move {
+        uint32_t first_token;
+        uint32_t n_tokens;
+        float mean;
+        float stddev;
+        uint32_t sims;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(Header) == 32 && sizeof(Entry) == 24 && sizeof(Move) == 24,
+                  "opening book records must be packed");
+}
+
+struct BookMove {
+    std::vector<int> program;
+    float mean = 0.0f;
+    float stddev = 0.0f;
+    uint32_t sims = 0;
+};
+
+// 대칭 정규화 키 (sym: 원본 → 대표 변환)
+uint64_t opening_key(const MapSymmetry& symmetry, const GameState& state, Symmetry& sym);
+
+// ============================================================
+// 오프라인 생성기 (메모리에 모은 뒤 한 번에 저장)
+// 같은 키가 다시 들어오면 방문 수는 합산, 같은 프로그램의 통계는 합동(pooled) 평균 / 분산
+// ============================================================
+class OpeningBookWriter {
+public:
+    OpeningBookWriter(const GameState& map_state, const FunctionLibrary& lib, int max_moves = 8);
+
+    // 대칭 변환이 안 되는 프로그램은 제외, 추가된 수 반환
+    int add(const GameState& state, const std::vector<BookMove>& moves, uint32_t visits = 1);
+    // 임시 파일에 쓴 뒤 rename
+    bool save(const std::string& path) const;
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Pending {
+        uint32_t visits = 0;
+        std::vector<BookMove> moves;
+    };
+
+    MapSymmetry symmetry_;
+    int max_moves_;
+    std::map<uint64_t, Pending> entries_;
+};
+
+// ============================================================
+// 조회 (파일 mmap, 읽기 전용 → 스레드 / 프로세스 간 공유)
+// ============================================================
+class OpeningBook {
+public:
+    OpeningBook(const GameState& map_state, const FunctionLibrary& lib);
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // 형식이 맞지 않으면 false (이전에 열린 파일은 닫힘)
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return base_ != nullptr; }
+
+    // 상태의 수 (원래 방향으로 복원, 평균 점수 내림차순), 없으면 false
+    bool lookup(const GameState& state, std::vector<BookMove>& moves, uint32_t& visits) const;
+
+    uint64_t key(const GameState& state) const;
+    size_t size() const { return n_entries_; }
+
+private:
+    MapSymmetry symmetry_;
+    void* base_ = nullptr;
+    size_t bytes_ = 0;
+    const OpeningBookFormat::Entry* entries_ = nullptr;
+    const OpeningBookFormat::Move* moves_ = nullptr;
+    const int16_t* tokens_ = nullptr;
+    size_t n_entries_ = 0;
+};
+
+} // namespace simulator
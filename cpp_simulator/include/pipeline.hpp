@@ -0,0 +1,375 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game_state.hpp"
+#include "run_stats.hpp"
+#include "sample_dedupe.hpp"
+#include "symmetry.hpp"
+#include "tournament.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 대기 (스핀 → yield → 짧은 sleep, 스레드 수가 코어 수보다 많아도 진행)
+// ============================================================
+class Backoff {
+public:
+    void pause() {
+        if (n_ < 32) {
+            n_++;
+        } else if (n_ < 96) {
+            n_++;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+private:
+    int n_ = 0;
+};
+
+// ============================================================
+// 잠금 없는 유한 큐 (다중 생산자 / 다중 소비자, 칸별 시퀀스 번호 링 버퍼)
+// - 가득 차면 push가 빈 칸이 날 때까지 대기 (backpressure → 앞 단계가 느려짐)
+// - 생산자가 모두 producer_done()을 부르면 닫힘: 남은 항목을 다 꺼낸 뒤 pop이 false
+// - 용량은 2의 거듭제곱으로 올림, depth / high_water는 근사값 (모니터링용)
+// ============================================================
+template <typename T>
+class BoundedQueue {
+public:
+    BoundedQueue(size_t capacity, int producers)
+        : producers_(std::max(producers, 1)) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        mask_ = n - 1;
+        cells_.reset(new Cell[n]);
+        for (size_t i = 0; i < n; i++) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // 성공하면 value를 옮김
+    bool try_push(T& value) {
+        Cell* cell;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        track_depth();
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        Cell* cell;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 가득 차 있으면 대기, 대기 시간(마이크로초)을 wait_us에 더함
+    void push(T&& value, uint64_t& wait_us) {
+        if (try_push(value)) return;
+        full_waits_.fetch_add(1, std::memory_order_relaxed);
+        const auto t0 = std::chrono::steady_clock::now();
+        Backoff backoff;
+        do {
+            backoff.pause();
+        } while (!try_push(value));
+        wait_us += elapsed_us(t0);
+    }
+
+    // 비어 있으면 대기, 닫히고 비었으면 false
+    bool pop(T& out, uint64_t& wait_us) {
+        if (try_pop(out)) return true;
+        const auto t0 = std::chrono::steady_clock::now();
+        Backoff backoff;
+        for (;;) {
+            const bool was_closed = closed_.load(std::memory_order_acquire);
+            if (try_pop(out)) break;
+            if (was_closed) {
+                wait_us += elapsed_us(t0);
+                return false;
+            }
+            backoff.pause();
+        }
+        wait_us += elapsed_us(t0);
+        return true;
+    }
+
+    void producer_done() {
+        if (producers_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            closed_.store(true, std::memory_order_release);
+        }
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+    size_t capacity() const { return mask_ + 1; }
+    size_t depth() const {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_relaxed);
+        return head > tail ? std::min(head - tail, capacity()) : 0;
+    }
+    size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
+    uint64_t pushed() const { return pushed_.load(std::memory_order_relaxed); }
+    uint64_t full_waits() const { return full_waits_.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};    // 다음 push 위치
+    alignas(64) std::atomic<size_t> tail_{0};    // 다음 pop 위치
+    alignas(64) std::atomic<int> producers_;
+    std::atomic<bool> closed_{false};
+    std::atomic<size_t> high_water_{0};
+    std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> full_waits_{0};
+
+    void track_depth() {
+        const size_t d = depth();
+        size_t hw = high_water_.load(std::memory_order_relaxed);
+        while (d > hw && !high_water_.compare_exchange_weak(hw, d, std::memory_order_relaxed)) {
+        }
+    }
+
+    static uint64_t elapsed_us(std::chrono::steady_clock::time_point t0) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+    }
+};
+
+// ============================================================
+// 관측 인코더: GameState → 828차원 상태 벡터 (game_worker.get_state_vector_list와 동일)
+// 먹힌 미친 빅치즈 / 빈 슬롯은 (-1, -1), 이동 빅치즈는 벡터에 없음
+// ============================================================
+void encode_state_vector(const GameState& state, float* out);
+
+// ============================================================
+// 샘플 샤드 파일 (리틀 엔디언, 앞에서부터 순서대로 읽음)
+//   헤더 16B: "MASS" / 버전 / 상태 벡터 차원 / 예약
+//   샘플: game i64 / run i32 / mirrored u8 + 패딩 3B / count u32 / 프로그램 수 u32 / 상태 벡터 f32 x 차원
+//         프로그램마다: 점수 f32 / 토큰 수 u32 / 토큰 i32 x 토큰 수
+// 기록 도중 끊긴 마지막 샘플은 읽을 때 버림
+// ============================================================
+namespace SampleShardFormat {
+    constexpr char MAGIC[4] = {'M', 'A', 'S', 'S'};
+    constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t dim;
+        uint32_t reserved;
+    };
+    struct Record {
+        int64_t game;
+        int32_t run;
+        uint8_t mirrored;
+        uint8_t pad[3];
+        uint32_t count;
+        uint32_t n_programs;
+    };
+    static_assert(sizeof(Header) == 16 && sizeof(Record) == 24, "sample shard records must be packed");
+}
+
+struct PipelineSample {
+    int64_t game = 0;
+    int32_t run = 0;
+    bool mirrored = false;
+    uint32_t count = 1;                       // 중복 제거 시 합쳐진 샘플 수
+    std::vector<float> state_vec;             // StateVec::DIM
+    std::vector<std::vector<int>> programs;   // 점수 내림차순 top-K (END 포함)
+    std::vector<float> scores;                // 런 시작 대비 평균 점수 변화
+};
+
+// 샤드 파일 전체 읽기 (헤더가 다르거나 열 수 없으면 false)
+bool read_sample_shard(const std::string& path, std::vector<PipelineSample>& out);
+
+// ============================================================
+// 생성 파이프라인 설정
+// 단계별 스레드 수 / 큐 용량은 따로 정함 (큐가 차면 앞 단계가 대기)
+// ============================================================
+struct PipelineConfig {
+    int64_t games = 100;
+    int64_t first_game = 0;          // 게임 번호 시작 (시드는 (seed, 게임 번호)에서 파생)
+    uint64_t seed = 0;
+    int max_runs = Config::MAX_RUNS;
+    int top_k = 1;                   // 런마다 저장할 프로그램 수
+    SearchPolicy policy;
+    std::vector<GameState> starts;   // 게임 m의 시작 상태 = starts[m % size] (비어 있으면 레벨 3)
+    MovePolicy cat_policy = MovePolicy::RANDOM;
+    MovePolicy crzbc_policy = MovePolicy::RANDOM;
+    std::vector<int> functions;      // 평면 형식 함수 교체
+    RuleSet rules;
+
+    // 단계 크기
+    int search_workers = 0;          // 0 = 하드웨어 스레드 - 인코더 - 2 (최소 1)
+    int encode_workers = 1;
+    size_t run_queue = 64;           // 탐색 → 인코더
+    size_t sample_queue = 256;       // 인코더 → 증강 / 중복 제거
+    size_t write_queue = 1024;       // 증강 / 중복 제거 → 기록기
+
+    // 증강 / 중복 제거 (중복 제거는 그룹을 모두 모은 뒤 입력이 끝나면 기록기로 보냄)
+    bool mirror = false;             // 맵이 좌우 대칭일 때만 적용
+    bool dedupe = false;
+    DedupeConfig dedupe_config;
+
+    std::string output_path;
+    size_t write_buffer = 1 << 20;   // 이만큼 모이면 파일에 씀 (바이트)
+};
+
+struct StageReport {
+    std::string name;
+    int threads = 0;
+    uint64_t items = 0;              // 처리한 입력 수
+    uint64_t busy_us = 0;            // 처리 시간 합
+    uint64_t wait_in_us = 0;         // 입력 큐가 비어 대기
+    uint64_t wait_out_us = 0;        // 출력 큐가 가득 차 대기 (backpressure)
+};
+
+struct QueueReport {
+    std::string name;
+    size_t capacity = 0;
+    size_t depth = 0;
+    size_t high_water = 0;
+    uint64_t pushed = 0;
+    uint64_t full_waits = 0;         // 가득 차서 대기한 push 수
+};
+
+struct PipelineReport {
+    std::vector<StageReport> stages;
+    std::vector<QueueReport> queues;
+    int64_t games_done = 0;
+    uint64_t samples_written = 0;
+    uint64_t mirrored = 0;
+    uint64_t bytes_written = 0;
+    double elapsed_sec = 0.0;
+    bool finished = false;
+    std::string error;               // 기록 실패 시 메시지
+};
+
+// ============================================================
+// 데이터 생성 파이프라인
+//   탐색 (search_workers) → [runs] → 인코더 (encode_workers) → [samples]
+//   → 증강 / 중복 제거 (1) → [write] → 샤드 기록기 (1)
+// 탐색 워커는 게임 단위로 일을 가져가 런마다 search_run → execute_program, 결과 (상태, top-K)를 넘김
+// 게임별 결과는 스레드 수와 무관 (시드 파생은 run_tournament와 같음), 파일 안 샘플 순서는 스케줄에 따름
+// 런 / 게임 통계는 RunStats에 누적 (실행 중에도 읽기 가능)
+// ============================================================
+class GenerationPipeline {
+public:
+    explicit GenerationPipeline(const PipelineConfig& config);
+    ~GenerationPipeline();
+
+    GenerationPipeline(const GenerationPipeline&) = delete;
+    GenerationPipeline& operator=(const GenerationPipeline&) = delete;
+
+    // 출력 파일을 열고 스레드 시작 (파일을 열 수 없거나 이미 시작했으면 false)
+    bool start();
+    // 끝날 때까지 대기 (timeout_sec < 0: 무한), 끝났으면 true
+    bool wait(double timeout_sec = -1.0);
+    // 새 게임 / 런을 시작하지 않음 (이미 나온 샘플은 모두 기록)
+    void cancel();
+
+    PipelineReport report() const;
+    const RunStats& stats() const { return stats_; }
+    SampleDeduper::Stats dedupe_stats() const { return deduper_.stats(); }
+    const PipelineConfig& config() const { return config_; }
+
+private:
+    struct RunItem {
+        int64_t game = 0;
+        int32_t run = 0;
+        GameState state;
+        std::vector<std::vector<int>> programs;
+        std::vector<float> scores;
+    };
+
+    struct StageCounters {
+        std::atomic<uint64_t> items{0};
+        std::atomic<uint64_t> busy_us{0};
+        std::atomic<uint64_t> wait_in_us{0};
+        std::atomic<uint64_t> wait_out_us{0};
+    };
+    enum Stage { SEARCH = 0, ENCODE, AUGMENT, WRITE, NUM_STAGES };
+
+    PipelineConfig config_;
+    TournamentConfig search_config_;
+    std::vector<float> probs_;
+    std::unique_ptr<MapSymmetry> mirror_;    // 좌우 대칭 맵일 때만
+    RunStats stats_;
+    SampleDeduper deduper_;
+
+    int n_search_;                           // 큐 생산자 수라서 큐보다 먼저 초기화
+    BoundedQueue<RunItem> runs_;
+    BoundedQueue<PipelineSample> samples_;
+    BoundedQueue<PipelineSample> writes_;
+    StageCounters counters_[NUM_STAGES];
+
+    std::atomic<int64_t> next_game_{0};
+    std::atomic<int64_t> games_done_{0};
+    std::atomic<uint64_t> samples_written_{0};
+    std::atomic<uint64_t> mirrored_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<bool> cancel_{false};
+
+    std::FILE* file_ = nullptr;
+    std::vector<std::thread> threads_;
+    mutable std::mutex mutex_;
+    std::condition_variable done_cv_;
+    std::mutex join_mutex_;
+    bool started_ = false;
+    bool finished_ = false;
+    std::string error_;
+    std::chrono::steady_clock::time_point start_time_, end_time_;
+
+    void search_worker();
+    void encode_worker();
+    void augment_worker();
+    void write_worker();
+    void join();
+};
+
+} // namespace simulator
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "program_grammar.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 임의 프로그램 생성 설정 (가중치는 음수가 아니면 되고 합으로 정규화)
+// ============================================================
+struct ProgramGenConfig {
+    uint64_t seed = 0;
+    int num_threads = 0;              // 0 = 자동 감지
+    int min_tokens = 1;               // 본문 (END 제외) 길이 하한, 이보다 짧으면 END를 고르지 않음
+    int max_tokens = 10;              // 본문 길이 상한
+    int max_func_calls = Config::DEFAULT_FUNC_CHANCE;  // 라이브러리 호출 횟수 상한 (음수 = 제한 없음)
+
+    // 단위 종류 가중치 (문법상 허용된 것끼리 재정규화)
+    float direction_weight = 1.0f;
+    float loop_weight = 0.5f;
+    float if_weight = 0.2f;
+    float function_weight = 0.2f;
+    float end_weight = 0.15f;
+
+    std::vector<float> direction_weights = std::vector<float>(4, 1.0f);    // UP, DOWN, LEFT, RIGHT
+    std::vector<float> loop_count_weights = std::vector<float>(10, 1.0f);  // 토큰 100..109
+    std::vector<float> if_count_weights = std::vector<float>(7, 1.0f);     // 토큰 101..107
+    std::vector<int> functions;       // 평면 형식 함수 교체 (batch_simulate와 동일)
+};
+
+// ============================================================
+// 문법 유효 임의 프로그램 생성기 (ProgramGrammar로 매 토큰 검사)
+// 단위: 방향 | LOOP NUM 방향 | IF NUM 방향 | 라이브러리 ID, 마지막은 END
+// 라이브러리 ID는 등록된 함수 중 균등 (서로 다른 ID 두 개, 호출 max_func_calls회까지)
+// 프로그램 i는 (seed, i)로 정해지는 RNG만 사용 → 스레드 수 / 배치 경계와 무관하게 재현
+// ============================================================
+class ProgramGenerator {
+public:
+    explicit ProgramGenerator(const ProgramGenConfig& config = ProgramGenConfig());
+
+    const ProgramGenConfig& config() const { return config_; }
+    int row_width() const { return config_.max_tokens + 1; }   // END 포함 최대 길이
+
+    // index번째 프로그램을 out에 기록 (row_width() 이상), END 포함 길이 반환
+    int generate_one(uint64_t index, int* out) const;
+    std::vector<int> generate_one(uint64_t index) const;
+
+    // [first, first + n): 한 행 row_width(), END 뒤는 EMPTY (ProgramRegistry.intern_array 형식)
+    void generate_padded(uint64_t first, size_t n, int* out) const;
+    // [first, first + n): 평면 토큰 + offsets (n + 1개, programs[i] = tokens[offsets[i]:offsets[i+1]])
+    void generate_flat(uint64_t first, size_t n, std::vector<int>& tokens, std::vector<int64_t>& offsets) const;
+
+private:
+    ProgramGenConfig config_;
+    std::vector<uint8_t> library_ok_;   // ProgramGrammar::library_mask
+    std::vector<int> library_ids_;      // 등록된 라이브러리 ID
+};
+
+} // namespace simulator
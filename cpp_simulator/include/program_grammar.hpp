@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "function_library.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 프로그램 문법 상태 기계 (토큰 단위로 유효한 다음 토큰 판정)
+// 단위: 방향 | LOOP NUM(100-109) 방향 | IF NUM(101-107) 방향 | 라이브러리 ID | END
+// - 본문(END 제외)은 max_tokens 이하, 남은 자리에 못 들어가는 단위는 금지, 자리가 없으면 END만
+// - 라이브러리 ID: 등록된 함수만, 서로 다른 ID는 두 개까지 (parse_program이 세 번째부터 무시)
+//   max_calls >= 0이면 호출 횟수도 그 이하 (Python func_chance 검사)
+// - F1 / F2(10 / 11), EMPTY는 생성하지 않음 (프로그램은 라이브러리 ID로 함수를 부름)
+// ============================================================
+class ProgramGrammar {
+public:
+    // 문법 슬롯 (다음 토큰이 채울 자리)
+    enum Slot : int {
+        UNIT = 0,       // 단위 시작 또는 END
+        LOOP_NUM = 1,
+        LOOP_DIR = 2,
+        IF_NUM = 3,
+        IF_DIR = 4,
+        NUM_SLOTS = 5,
+        DONE = 5        // END 이후
+    };
+
+    // library_ok[t]: 토큰 t가 등록된 라이브러리 ID인지 (크기 Token::EMPTY + 1)
+    static std::vector<uint8_t> library_mask(const FunctionLibrary& lib) {
+        std::vector<uint8_t> ok(Token::EMPTY + 1, 0);
+        lib.for_each_function([&](int id, const std::vector<int>& body) {
+            if (Token::is_func_lib(id) && !body.empty()) ok[id] = 1;
+        });
+        return ok;
+    }
+
+    ProgramGrammar(int max_tokens, const uint8_t* library_ok, int max_calls = -1)
+        : max_tokens_(max_tokens), library_ok_(library_ok), max_calls_(max_calls) {}
+
+    Slot slot() const { return slot_; }
+    bool done() const { return slot_ == DONE; }
+    int length() const { return length_; }  // END 제외 본문 토큰 수
+
+    bool allows(int token) const {
+        const int room = max_tokens_ - length_;
+        switch (slot_) {
+            case UNIT:
+                if (token == Token::END) return true;
+                if (room < 1) return false;
+                if (Token::is_direction(token)) return true;
+                if (token == Token::LOOP || token == Token::IF) return room >= 3;
+                if (Token::is_func_lib(token)) {
+                    if (!library_ok_[token]) return false;
+                    if (max_calls_ >= 0 && calls_ >= max_calls_) return false;
+                    return func1_ < 0 || token == func1_ || func2_ < 0 || token == func2_;
+                }
+                return false;
+            case LOOP_NUM: return Token::is_num(token);
+            case IF_NUM: return Token::is_if_num(token);
+            case LOOP_DIR:
+            case IF_DIR: return Token::is_direction(token);
+            default: return false;
+        }
+    }
+
+    // allows(token)인 토큰만 넣을 것
+    void push(int token) {
+        switch (slot_) {
+            case UNIT:
+                if (token == Token::END) { slot_ = DONE; return; }
+                if (token == Token::LOOP) slot_ = LOOP_NUM;
+                else if (token == Token::IF) slot_ = IF_NUM;
+                else if (Token::is_func_lib(token)) {
+                    calls_++;
+                    if (func1_ < 0) func1_ = token;
+                    else if (token != func1_ && func2_ < 0) func2_ = token;
+                }
+                break;
+            case LOOP_NUM: slot_ = LOOP_DIR; break;
+            case IF_NUM: slot_ = IF_DIR; break;
+            default: slot_ = UNIT; break;
+        }
+        length_++;
+    }
+
+private:
+    int max_tokens_;
+    const uint8_t* library_ok_;
+    int max_calls_;
+    Slot slot_ = UNIT;
+    int length_ = 0;
+    int func1_ = -1;
+    int func2_ = -1;
+    int calls_ = 0;
+};
+
+} // namespace simulator
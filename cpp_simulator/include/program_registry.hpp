@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include "simulator.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 프로그램 인턴 레지스트리 (토큰열 → 고정 int32 핸들)
+// 정규형 = 첫 END까지 (뒤 토큰은 파싱 / command_length에 영향 없음)
+// 핸들마다 정규형과 컴파일 결과를 한 번만 만들어 두고 배치 평가에서 재사용
+// 함수 라이브러리는 생성할 때 고정 (컴파일 결과에 함수 본문이 들어감)
+// intern은 여러 스레드에서 동시에 호출 가능, 핸들은 레지스트리 수명 동안 유효
+// ============================================================
+class ProgramRegistry {
+public:
+    // functions: 평면 형식 [id, len, tokens...] 라이브러리 교체 (형식 오류면 기본 라이브러리 유지)
+    explicit ProgramRegistry(const std::vector<int>& functions = {});
+
+    // 토큰열 인턴 (같은 정규형이면 같은 핸들)
+    int32_t intern(const int* tokens, size_t n);
+    int32_t intern(const std::vector<int>& tokens) { return intern(tokens.data(), tokens.size()); }
+
+    bool valid(int32_t handle) const;
+    // 정규형 토큰 / 컴파일 결과 (handle은 valid여야 함)
+    const std::vector<int>& tokens(int32_t handle) const;
+    const CompiledProgram& compiled(int32_t handle) const;
+    // 핸들 배열 → 컴파일 결과 포인터 (잘못된 핸들이 있으면 빈 벡터)
+    std::vector<const CompiledProgram*> resolve(const int32_t* handles, size_t n) const;
+
+    size_t size() const;
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::vector<int> tokens;
+        CompiledProgram compiled;
+    };
+    struct TokenHash {
+        size_t operator()(const std::vector<int>& v) const;
+    };
+
+    Simulator compiler_;
+    mutable std::shared_mutex mutex_;
+    std::vector<std::unique_ptr<Entry>> entries_;   // 포인터 고정 (resolve 결과는 잠금 밖에서 사용)
+    std::unordered_map<std::vector<int>, int32_t, TokenHash> index_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace simulator
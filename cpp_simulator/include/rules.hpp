@@ -0,0 +1,63 @@
+#pragma once
+
+#include "constants.hpp"
+#include "game_state.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 게임 규칙 (점수 / 한도 / 승리 보너스)
+// 기본값 = constants.hpp의 Score / Config (Python과 동일)
+// step_limit / red_zone: 음수(기본 -1)면 상태 값 그대로, 0 이상이면 규칙 값으로 덮어씀
+// ============================================================
+struct RuleSet {
+    int small_cheese = Score::SMALL_CHEESE;
+    int big_cheese = Score::BIG_CHEESE;
+    int cat_collision = Score::CAT_COLLISION;
+    int wall_collision = Score::WALL_COLLISION;
+    int step_limit = -1;
+    int red_zone = -1;
+    // 승리 보너스 = run * victory_run_weight + step * victory_step_weight
+    int victory_run_weight = 10;
+    int victory_step_weight = 1;
+
+    bool is_default() const {
+        const RuleSet d;
+        return small_cheese == d.small_cheese && big_cheese == d.big_cheese &&
+               cat_collision == d.cat_collision && wall_collision == d.wall_collision &&
+               step_limit < 0 && red_zone < 0 &&
+               victory_run_weight == d.victory_run_weight &&
+               victory_step_weight == d.victory_step_weight;
+    }
+};
+
+// ============================================================
+// 시뮬레이션 루프용 규칙 접근자 (정책과 같이 템플릿 인자로 디스패치)
+// DefaultRules: 상수 폴딩 (기존 성능 그대로), RuntimeRules: 임의 RuleSet
+// ============================================================
+struct DefaultRules {
+    static constexpr int small_cheese() { return Score::SMALL_CHEESE; }
+    static constexpr int big_cheese() { return Score::BIG_CHEESE; }
+    static constexpr int cat_collision() { return Score::CAT_COLLISION; }
+    static constexpr int wall_collision() { return Score::WALL_COLLISION; }
+    static constexpr int victory_bonus(int run, int step) { return run * 10 + step; }
+    static void apply(GameState&) {}
+};
+
+struct RuntimeRules {
+    const RuleSet* rules;
+
+    int small_cheese() const { return rules->small_cheese; }
+    int big_cheese() const { return rules->big_cheese; }
+    int cat_collision() const { return rules->cat_collision; }
+    int wall_collision() const { return rules->wall_collision; }
+    int victory_bonus(int run, int step) const {
+        return run * rules->victory_run_weight + step * rules->victory_step_weight;
+    }
+    void apply(GameState& state) const {
+        if (rules->step_limit >= 0) state.step_limit = static_cast<int16_t>(rules->step_limit);
+        if (rules->red_zone >= 0) state.red_zone = static_cast<int8_t>(rules->red_zone);
+    }
+};
+
+} // namespace simulator
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "constants.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 생성 통계 누적기 (잠금 없음: 모든 카운터가 relaxed atomic)
+// 게임 / 런 기록은 여러 스레드에서 동시에 호출 가능, 스냅샷은 카운터 복사만
+// 프로세스별 누적기는 serialize → merge_serialized로 합침 (설정이 같아야 함)
+// 히스토그램 구간: [min, max)를 bin 폭으로 나누고 양끝에 미만 / 이상 칸 하나씩
+// ============================================================
+struct StatsConfig {
+    int score_min = -5000;       // 게임 최종 점수
+    int score_max = 10000;
+    int score_bin = 250;
+    int delta_min = -2000;       // 런별 점수 변화
+    int delta_max = 2000;
+    int delta_bin = 50;
+    int max_runs = Config::MAX_RUNS;   // 런 순번 기록 한도 (넘으면 마지막 칸)
+};
+
+// 탐색 시간 히스토그램: 마이크로초, 2의 거듭제곱 구간마다 8칸 (상대 오차 ~12%)
+namespace SearchTimeBuckets {
+    constexpr int SUB = 8;
+    constexpr int OCTAVES = 40;
+    constexpr int COUNT = OCTAVES * SUB;
+}
+
+struct StatsSnapshot {
+    StatsConfig config;
+    uint64_t games = 0;
+    uint64_t wins = 0;
+    int64_t score_sum = 0;
+    double score_sq_sum = 0.0;
+    uint64_t runs_sum = 0;           // 게임별 진행 런 수 합
+    uint64_t win_runs_sum = 0;       // 이긴 게임의 런 수 합
+    std::vector<uint64_t> score_hist;            // 점수 구간 + 2
+
+    // 런 순번별
+    std::vector<uint64_t> runs;
+    std::vector<int64_t> delta_sum;
+    std::vector<uint64_t> small_cheese;
+    std::vector<uint64_t> big_cheese;
+    std::vector<uint64_t> catches;
+    std::vector<uint64_t> wins_at;               // 이 런에서 이긴 게임 수
+    std::vector<std::vector<uint64_t>> delta_hist;   // [런][점수 변화 구간 + 2]
+
+    std::vector<uint64_t> search_hist;           // SearchTimeBuckets::COUNT
+    uint64_t search_count = 0;
+    uint64_t search_us_sum = 0;
+
+    // 탐색 시간 분위수 (마이크로초, 구간 내 선형 보간)
+    double search_percentile(double q) const;
+    double score_mean() const { return games ? static_cast<double>(score_sum) / games : 0.0; }
+    double score_std() const;
+    // 히스토그램 구간 경계 (내부 칸 기준, 길이 = 내부 칸 수 + 1)
+    std::vector<int> score_edges() const;
+    std::vector<int> delta_edges() const;
+};
+
+class RunStats {
+public:
+    explicit RunStats(const StatsConfig& config = StatsConfig());
+
+    RunStats(const RunStats&) = delete;
+    RunStats& operator=(const RunStats&) = delete;
+
+    // 런 하나 (run: 0부터), 탐색 시간은 마이크로초
+    void record_run(int run, int score_delta, int small_cheese, int big_cheese, int catches,
+                    uint64_t search_us, bool won = false);
+    // 게임 하나 (runs: 진행한 런 수)
+    void record_game(int final_score, bool won, int runs);
+
+    StatsSnapshot snapshot() const;
+    void reset();
+
+    // 같은 설정의 누적기 / 직렬화 기록 합치기 (형식 / 설정이 다르면 false)
+    bool merge(const RunStats& other);
+    std::string serialize() const;
+    bool merge_serialized(const std::string& blob);
+
+    const StatsConfig& config() const { return config_; }
+
+private:
+    StatsConfig config_;
+    int n_score_;                // 점수 칸 수 (양끝 포함)
+    int n_delta_;
+    int n_runs_;
+
+    // 평면 카운터 배열 (오프셋은 생성자에서 계산)
+    size_t n_counters_;
+    std::unique_ptr<std::atomic<int64_t>[]> counters_;
+    size_t off_score_hist_, off_per_run_, off_delta_hist_, off_search_hist_;
+
+    std::atomic<int64_t>& at(size_t i) const { return counters_[i]; }
+    void add(size_t i, int64_t v) { counters_[i].fetch_add(v, std::memory_order_relaxed); }
+    static int bucket(int value, int lo, int hi, int width, int n);
+};
+
+} // namespace simulator
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "constants.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 샘플 중복 제거 키 (828차원 상태 벡터 = 모델 입력 기준)
+// 그리드 / 마우스 / 목숨 / 런 / 승패는 항상 정확히, 나머지는 설정에 따라 뭉갬
+// score_bucket / step_bucket: 0 = 무시, 1 = 정확히, k = k 단위 구간
+// (step은 벡터의 step / step_limit 비율을 기본 step_limit 기준 스텝 수로 환산)
+// ============================================================
+struct DedupeConfig {
+    int top_k = 1;             // 그룹별로 남길 프로그램 수
+    int score_bucket = 1;
+    int step_bucket = 1;
+    bool entities = true;      // 고양이 / 미친 빅치즈 위치 포함
+};
+
+uint64_t sample_key(const float* state_vec, const DedupeConfig& config);
+
+// ============================================================
+// 동시 중복 제거 집합 (스트라이프별 잠금 해시 맵)
+// 같은 키의 샘플은 한 그룹으로 합침: 대표 = 가장 먼저 들어온(가장 작은 순번) 샘플
+// 그룹 안에서 같은 프로그램의 점수는 평균, 평균 점수↓ / 횟수↓ / 먼저 본 순으로 top_k 출력
+// 결과는 스레드 수 / 삽입 순서와 무관
+// ============================================================
+class SampleDeduper {
+public:
+    struct Group {
+        uint64_t key;
+        int64_t index;                        // 대표 샘플 순번 (add 누적)
+        uint32_t count;                       // 합쳐진 샘플 수
+        std::vector<std::vector<int>> programs;
+        std::vector<float> scores;            // 프로그램별 평균 점수
+        std::vector<uint32_t> counts;         // 프로그램별 관측 수
+    };
+
+    struct Stats {
+        uint64_t samples = 0;
+        uint64_t unique = 0;
+        uint64_t duplicates = 0;
+        double ratio = 0.0;       // duplicates / samples
+    };
+
+    explicit SampleDeduper(const DedupeConfig& config = DedupeConfig(), int num_stripes = 64);
+
+    // 샘플 n개 추가 (vecs: n x 828), 샘플별 그룹 키 반환
+    // created: 샘플별 1 = 새 그룹을 만듦 (이 샘플이 대표), nullptr이면 기록 안 함
+    std::vector<uint64_t> add(const float* vecs, size_t n,
+                              const std::vector<std::vector<std::vector<int>>>& programs,
+                              const std::vector<std::vector<float>>& scores,
+                              int num_threads = 0, std::vector<uint8_t>* created = nullptr);
+
+    // 대표 순번 오름차순
+    std::vector<Group> groups() const;
+    Stats stats() const;
+    void clear();
+
+    const DedupeConfig& config() const { return config_; }
+
+private:
+    struct Candidate {
+        std::vector<int> program;
+        double sum;
+        uint32_t count;
+        int64_t first;            // 처음 관측된 샘플 순번 (동점 순서)
+    };
+    struct Entry {
+        int64_t index;
+        uint32_t count;
+        std::vector<Candidate> candidates;
+    };
+    struct Stripe {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, Entry> entries;
+    };
+
+    DedupeConfig config_;
+    std::vector<std::unique_ptr<Stripe>> stripes_;
+    int64_t next_index_ = 0;                 // 다음 샘플 순번 (add 호출 스레드만 사용)
+    std::atomic<uint64_t> samples_{0};       // 넣은 샘플 수 (스트라이프 삽입 직전에 증가, stats가 실행 중 읽음)
+
+    void merge(Entry& e, int64_t index, const std::vector<std::vector<int>>& programs,
+               const std::vector<float>& scores);
+};
+
+} // namespace simulator
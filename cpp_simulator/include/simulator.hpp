@@ -2,23 +2,46 @@
 
 #include <vector>
 #include <deque>
+#include <atomic>
+#include <cstdint>
 #include <random>
 #include <algorithm>
-#include <set>
+#include <string>
+#include <memory>
 #include "constants.hpp"
 #include "game_state.hpp"
 #include "function_library.hpp"
+#include "move_policy.hpp"
+#include "map_topology.hpp"
+#include "rules.hpp"
+#include "cheese_field.hpp"
+#include "features.hpp"
+#include "step_journal.hpp"
 
 namespace simulator {
 
-// ============================================================
-// 거리 맵 타입 (BFS 결과)
-// ============================================================
-using DistanceMap = std::array<std::array<int16_t, MAP_SIZE>, MAP_SIZE>;
-
 // ============================================================
 // BFS 거리 맵 캐시 (전역 공유, 스레드 안전)
+// 직접 계산하거나, save()로 저장한 파일을 attach()로 읽기 전용 mmap
+// (워커 프로세스마다 BFS를 다시 돌리지 않고 페이지 캐시의 한 벌을 공유)
 // ============================================================
+namespace DistanceCacheFormat {
+    constexpr char MAGIC[4] = {'M', 'A', 'D', 'C'};
+    constexpr uint32_t VERSION = 1;
+
+    // 헤더 뒤: DistanceMap x 121, NextHopMap x 121 (리틀 엔디언)
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t cells;
+        uint32_t reserved;
+        uint64_t checksum;                 // FNV-1a (벽 + 본문)
+        int8_t wall[MAP_SIZE][MAP_SIZE];
+        uint8_t pad[128 - MAP_SIZE * MAP_SIZE];
+    };
+    static_assert(sizeof(Header) == 152, "distance cache header must be packed");
+}
+
 class GlobalDistanceCache {
 public:
     // 싱글톤 인스턴스
@@ -30,20 +53,44 @@ public:
     // 벽 정보를 받아서 모든 위치의 거리 맵을 계산
     void initialize(const std::array<std::array<int8_t, MAP_SIZE>, MAP_SIZE>& wall);
 
+    // 현재 테이블을 파일로 저장 (임시 파일 → rename), 초기화 전이면 false
+    bool save(const std::string& path) const;
+    // 저장된 파일을 읽기 전용 mmap, 형식 / 체크섬 / 벽이 다르면 false (기존 캐시 유지)
+    bool attach(const std::string& path, const std::array<std::array<int8_t, MAP_SIZE>, MAP_SIZE>& wall);
+
     // 특정 위치의 거리 맵 조회 (O(1))
     const DistanceMap& get(int row, int col) const {
-        return cache_[row * MAP_SIZE + col];
+        return maps_[row * MAP_SIZE + col];
+    }
+
+    // (row, col)로 가는 다음 방향 테이블 조회 (O(1))
+    const NextHopMap& next_hop_to(int row, int col) const {
+        return hops_[row * MAP_SIZE + col];
     }
 
     bool is_initialized() const { return initialized_; }
-    void clear() { initialized_ = false; cache_.clear(); }
+    bool is_shared() const { return mapped_ != nullptr; }
+    // 이 벽 배치로 만든 테이블인지 (다른 맵 상태에 거리 조회 방지)
+    bool matches(const std::array<std::array<int8_t, MAP_SIZE>, MAP_SIZE>& wall) const {
+        return initialized_ && wall_ == wall;
+    }
+    void clear();
 
 private:
     GlobalDistanceCache() = default;
+    ~GlobalDistanceCache() { clear(); }
     GlobalDistanceCache(const GlobalDistanceCache&) = delete;
     GlobalDistanceCache& operator=(const GlobalDistanceCache&) = delete;
 
     std::vector<DistanceMap> cache_;  // 121개의 거리 맵
+    std::vector<NextHopMap> next_hop_;  // 121개의 다음 방향 테이블 (목표 기준)
+    std::array<std::array<int8_t, MAP_SIZE>, MAP_SIZE> wall_{};
+
+    // 조회 대상: cache_ / next_hop_ 또는 mmap 영역
+    const DistanceMap* maps_ = nullptr;
+    const NextHopMap* hops_ = nullptr;
+    void* mapped_ = nullptr;
+    size_t mapped_bytes_ = 0;
     bool initialized_ = false;
 
     // 단일 위치에 대한 BFS 거리 맵 계산
@@ -62,12 +109,32 @@ struct ParsedProgram {
     std::vector<int> func2;
 };
 
+// 컴파일된 프로그램 (파싱 + command_length, 상태와 무관 → 여러 상태에서 공유)
+struct CompiledProgram {
+    ParsedProgram parsed;
+    int command_length = 0;  // END 포함 토큰 수 (Python len(command) 매칭)
+};
+
 // ============================================================
 // 액션 결과
 // ============================================================
 struct ActionResult {
     std::vector<int> actions;       // 방향 액션 리스트
-    std::set<int> wall_collisions;  // 벽 충돌 인덱스
+    std::vector<uint8_t> wall_hit;  // 액션별 벽 충돌 여부 (actions와 같은 길이)
+    int moves = 0;                  // 실제 이동 수 (= 증가할 step 수)
+    int move_budget = 0;            // step_limit까지 남은 이동 수 (도달 후 액션은 실행되지 않음)
+
+    bool full() const { return moves >= move_budget; }
+};
+
+// ============================================================
+// 충돌 불가 인증 통계 (전체 시뮬레이션 누적)
+// ============================================================
+struct CollisionCertStats {
+    uint64_t steps = 0;            // 시뮬레이션 루프 스텝 수
+    uint64_t windows = 0;          // 발급된 인증 구간 수 (길이 1 이상)
+    uint64_t cat_skipped = 0;      // 마우스-고양이 충돌 검사를 생략한 스텝 수
+    uint64_t crzbc_skipped = 0;    // 미친 빅치즈 충돌 / 수집 검사를 생략한 스텝 수
 };
 
 // ============================================================
@@ -81,26 +148,88 @@ public:
     // ========== 핵심 API ==========
 
     // 프로그램 실행 후 점수 반환 (상태 변경 안 함)
-    float simulate_program(const std::vector<int>& program);
+    // cat_policy / crzbc_policy: 엔티티 이동 정책 (컴파일 타임 인스턴스로 디스패치)
+    float simulate_program(const std::vector<int>& program,
+                           MovePolicy cat_policy = MovePolicy::RANDOM,
+                           MovePolicy crzbc_policy = MovePolicy::RANDOM);
 
     // 프로그램 실행 후 상태 적용
     float simulate_program_and_apply(const std::vector<int>& program);
 
+    // 런 하나를 실제로 진행 (Python execute_program 매칭): 실행 결과를 상태에 반영하고
+    // 잡혔으면 리스폰, 목숨 / 스텝 소진 또는 MAX_RUNS 도달 시 패배, run 1 증가
+    float execute_program(const std::vector<int>& program,
+                          MovePolicy cat_policy = MovePolicy::RANDOM,
+                          MovePolicy crzbc_policy = MovePolicy::RANDOM);
+
+    // 컴파일 / 컴파일된 프로그램 실행 (같은 프로그램을 여러 상태에서 평가할 때)
+    CompiledProgram compile_program(const std::vector<int>& program) const;
+    float simulate_compiled(const CompiledProgram& compiled,
+                            MovePolicy cat_policy = MovePolicy::RANDOM,
+                            MovePolicy crzbc_policy = MovePolicy::RANDOM);
+    float execute_compiled(const CompiledProgram& compiled,
+                           MovePolicy cat_policy = MovePolicy::RANDOM,
+                           MovePolicy crzbc_policy = MovePolicy::RANDOM);
+
+    // ========== 분기 (트리 탐색) ==========
+
+    // 동적 상태 (게임 상태, 치즈 거리장, RNG, 규칙)만 복사한 사본
+    // 전이 테이블 / 복도 그래프 / 함수 라이브러리는 공유 (바뀌는 쪽이 새로 만듦), 전역 거리 캐시는 원래 공유
+    // RNG 상태도 복사되므로 분기끼리 같은 난수열 (다르게 하려면 seed)
+    Simulator fork() const { return *this; }
+    std::vector<Simulator> fork_n(int k) const { return std::vector<Simulator>(static_cast<size_t>(std::max(k, 0)), *this); }
+
+    // ========== 되돌리기 저널 (깊이 우선 탐색) ==========
+
+    // execute_program과 같이 런 하나를 진행하고, 바뀐 부분 (엔티티 / 먹은 치즈 / 점수 / 목숨 /
+    // RNG 위치)을 journal에 기록 (컴파일된 프로그램이면 scratch_ 용량 안에서 힙 할당 없음)
+    float apply(const CompiledProgram& compiled, StepJournal& journal,
+                MovePolicy cat_policy = MovePolicy::RANDOM,
+                MovePolicy crzbc_policy = MovePolicy::RANDOM);
+    float apply(const std::vector<int>& program, StepJournal& journal,
+                MovePolicy cat_policy = MovePolicy::RANDOM,
+                MovePolicy crzbc_policy = MovePolicy::RANDOM) {
+        return apply(compile_program(program), journal, cat_policy, crzbc_policy);
+    }
+    // 마지막 apply 되돌림 (상태 + RNG), 기록이 없거나 그 사이 seed / restore_state / reset이면 false
+    bool undo(StepJournal& journal);
+
+    // ========== 게임 규칙 ==========
+
+    // 기본 규칙은 상수가 접힌 인스턴스, 사용자 규칙은 범용 인스턴스로 실행
+    void set_rules(const RuleSet& rules) { rules_ = rules; default_rules_ = rules.is_default(); }
+    const RuleSet& get_rules() const { return rules_; }
+
     // ========== 상태 관리 ==========
 
     void restore_state(const GameState& state);
     GameState get_state() const { return state_; }
     void reset();
+    // 엔티티 이동 RNG 시드 (기본: random_device)
+    void seed(uint32_t value) { rng_.seed(value); journal_epoch_++; }
 
     // ========== 캐시 관리 (전역 공유) ==========
 
     // 현재 벽 정보로 전역 캐시 초기화 (한 번만 호출하면 됨)
     void initialize_cache();
+    // 저장된 캐시 파일을 mmap (현재 맵과 벽이 같아야 함), 실패하면 false
+    bool attach_cache(const std::string& path);
+    static bool save_cache(const std::string& path) { return GlobalDistanceCache::instance().save(path); }
+    static bool is_cache_shared() { return GlobalDistanceCache::instance().is_shared(); }
     static void enable_global_cache() { global_cache_enabled_ = true; }
     static void disable_global_cache() { global_cache_enabled_ = false; }
     static bool is_cache_initialized() { return GlobalDistanceCache::instance().is_initialized(); }
     static bool is_cache_enabled() { return global_cache_enabled_; }
 
+    // ========== 충돌 불가 인증 ==========
+
+    // 엔티티가 충분히 멀면 스텝 구간 단위로 충돌 검사 생략 (기본: 활성)
+    static void enable_collision_cert() { collision_cert_enabled_.store(true, std::memory_order_relaxed); }
+    static void disable_collision_cert() { collision_cert_enabled_.store(false, std::memory_order_relaxed); }
+    static bool is_collision_cert_enabled() { return collision_cert_enabled_.load(std::memory_order_relaxed); }
+    static CollisionCertStats collision_cert_stats();
+    static void reset_collision_cert_stats();
+
     // ========== 속성 접근 ==========
 
     int get_score() const { return state_.score; }
@@ -109,15 +238,49 @@ public:
     bool is_win() const { return state_.win_sign; }
     bool is_lose() const { return state_.lose_sign; }
 
+    // 현재 맵의 복도 그래프 (노드 / 직선 간선 / 레이 테이블)
+    const CorridorGraph& corridor_graph() const { return topology_->corridors; }
+    const FunctionLibrary& function_library() const { return func_lib_; }
+    // 평면 형식 [id, len, t1..tlen, ...] 함수 등록 / 교체 (형식 오류면 false, 변경 없음)
+    bool load_functions(const std::vector<int>& flat) { return func_lib_.load_flat(flat); }
+
+    // 현재 상태에서 프로그램의 마우스 액션 전개 (엔티티 무시, step_limit까지)
+    ActionResult expand_mouse_actions(const std::vector<int>& program);
+
+    // 현재 상태의 가장 가까운 치즈 거리장 (조회할 때 동기화, 치즈가 줄기만 했으면 먹은 칸만 복구)
+    const CheeseDistanceField& cheese_distances() { cheese_field_.set_state(state_); return cheese_field_; }
+    // 현재 상태의 get_state_vector 특징 828개 (위 거리장 공유)
+    void feature_vector(float* out) { encode_feature_vector(state_, cheese_field_, out); }
+
 private:
     GameState state_;
     FunctionLibrary func_lib_;
-    std::mt19937 rng_;
+    std::shared_ptr<const MapTopology> topology_;  // 현재 벽 / 교차로 기준 전이 테이블, 복도 그래프 (사본 간 공유)
+    CheeseDistanceField cheese_field_;  // state_의 치즈 거리장 (cheese_distances에서 지연 동기화)
+    CountedRng rng_;
+    uint32_t journal_epoch_ = 0;  // seed / restore_state / reset마다 증가 (이전 저널 기록 무효)
     int level_;
+    RuleSet rules_;
+    bool default_rules_ = true;
 
     // 전역 캐시 활성화 플래그 (static)
     static bool global_cache_enabled_;
 
+    // 충돌 불가 인증 플래그 / 누적 통계 (static, 스레드 간 공유)
+    static std::atomic<bool> collision_cert_enabled_;
+    static std::atomic<uint64_t> cert_steps_;
+    static std::atomic<uint64_t> cert_windows_;
+    static std::atomic<uint64_t> cert_cat_skipped_;
+    static std::atomic<uint64_t> cert_crzbc_skipped_;
+
+    // 런 하나를 state 위에서 바로 진행 (execute_compiled / apply 공통, state는 보통 state_)
+    // eaten: 이번 런에서 먹은 작은 치즈 칸을 추가 (nullptr이면 기록 안 함)
+    float run_compiled(const CompiledProgram& compiled, MovePolicy cat_policy, MovePolicy crzbc_policy,
+                       GameState& state, CellMask* eaten = nullptr);
+
+    // 벽 / 교차로가 바뀐 경우에만 전이 테이블, 복도 그래프 재계산
+    void refresh_topology();
+
     // ========== 이동 함수 ==========
 
     bool movable(const Position& pos, int dir) const;
@@ -129,50 +292,117 @@ private:
 
     // ========== 프로그램 파싱 ==========
 
-    ParsedProgram parse_program(const std::vector<int>& program);
+    ParsedProgram parse_program(const std::vector<int>& program) const;
 
     // ========== 액션 변환 ==========
 
-    ActionResult get_mouse_actions(
+    // out을 비우고 채움 (용량은 유지)
+    void get_mouse_actions(
         const std::vector<int>& command,
         const std::vector<int>& func1,
         const std::vector<int>& func2,
-        const GameState& sim_state
+        const GameState& sim_state,
+        ActionResult& out
     );
 
-    // 재귀적 액션 처리
+    // 재귀적 액션 처리 (LOOP/IF는 복도 레이 단위로 전개)
     void process_commands(
         const std::vector<int>& commands,
         const std::vector<int>& func1,
         const std::vector<int>& func2,
         GameState& sim_state,
-        std::vector<int>& actions,
-        std::set<int>& wall_collisions,
-        int& action_idx
+        ActionResult& out
     );
 
+    // 같은 방향 액션 n개 추가 (이동 moves개 후 벽 충돌 n - moves개), 예산 초과분은 생략
+    void append_run(ActionResult& out, GameState& sim_state, int dir, int n, int moves);
+
     // ========== 고양이 AI ==========
 
     void move_cats(GameState& sim_state, const DistanceMap& dist_map);
-    void move_single_cat(Entity& cat, const GameState& sim_state, const DistanceMap& dist_map);
+    void move_single_cat(int idx, GameState& sim_state, const DistanceMap& dist_map);
 
     // ========== 빅치즈 이동 ==========
 
     void move_movbc(GameState& sim_state);
     void move_crzbc(GameState& sim_state, const DistanceMap& dist_map);
 
+    // ========== 정책별 시뮬레이션 인스턴스 ==========
+
+    // sim_state (state_ 또는 그 사본) 위에서 진행, 끝나면 sim_state = 실행 후 상태 (score / life / catched 포함)
+    // 맵은 state_와 같아야 함 (이동 가능 여부를 state_.wall로 판정)
+    template <class CatPolicyT, class CrzbcPolicyT, class RulesT>
+    float simulate_program_impl(const CompiledProgram& compiled, const RulesT& rules,
+                                GameState& sim_state, CellMask* eaten = nullptr);
+
+    // 잡힌 뒤 리스폰 (Python _retry_after_catched: 마우스 / 고양이 시작 위치, 고양이 방향 랜덤)
+    // 3번째 이후 고양이는 (10, 10)에서 떨어진 빈 칸으로 (행 우선 첫 칸, 상태와 무관하게 결정적)
+    void retry_after_catched(GameState& state);
+
     // ========== Pre-calculate entity actions (exe3.py matching) ==========
 
-    std::array<std::vector<int>, Config::NUM_CATS> pre_calculate_cat_actions(
-        const std::vector<int>& mouse_actions, const GameState& sim_state);
-    std::array<std::vector<int>, Config::NUM_CRZBC> pre_calculate_crzbc_actions(
-        int n_moves, const GameState& sim_state);
+    // mouse_path[t]: t번째 스텝 이동 후 마우스 위치 (정책이 NEEDS_MOUSE일 때만 사용)
+    // 결과는 out에 (엔티티별로 비우고 채움, 용량은 유지)
+    template <class Policy>
+    void pre_calculate_cat_actions(
+        const std::vector<int>& mouse_actions, const std::vector<Position>& mouse_path,
+        const GameState& sim_state, std::array<std::vector<int>, Config::MAX_CATS>& out);
+    template <class Policy>
+    void pre_calculate_crzbc_actions(
+        int n_moves, const std::vector<Position>& mouse_path, const GameState& sim_state,
+        std::array<std::vector<int>, Config::MAX_CRZBC>& out);
+
+    // 실행별 작업 버퍼 (마우스 액션 / 마우스 경로 / 미리 계산한 엔티티 액션)
+    // 실행마다 비우고 다시 쓰므로 용량 안에서는 실행당 힙 할당 없음 (apply / undo 탐색용)
+    // 복사하면 빈 버퍼 (fork 비용 유지, 첫 실행에서 한 번 예약)
+    struct RunScratch {
+        static constexpr size_t ACTION_CAPACITY = 512;  // 기본 step_limit(200) + 벽 충돌 여유
+
+        ActionResult mouse;
+        std::vector<Position> mouse_path;
+        std::array<std::vector<int>, Config::MAX_CATS> cat_actions;
+        std::array<std::vector<int>, Config::MAX_CRZBC> crzbc_actions;
+
+        RunScratch() = default;
+        RunScratch(const RunScratch&) {}
+        RunScratch& operator=(const RunScratch&) { return *this; }
+
+        // 비우고 (처음이면) 예약
+        void reset();
+    };
+    RunScratch scratch_;
+
+    // 정책 컨텍스트용 마우스 기준 거리/다음 방향 테이블 (전역 캐시 없으면 마우스 칸별로 계산)
+    // 복사하면 빈 캐시 (fork 비용을 동적 상태 크기로 유지, 필요한 칸만 다시 계산)
+    struct MouseFieldCache {
+        std::vector<DistanceMap> dist;
+        std::vector<NextHopMap> next_hop;
+        std::vector<uint8_t> ready;
+
+        MouseFieldCache() = default;
+        MouseFieldCache(const MouseFieldCache&) {}
+        MouseFieldCache& operator=(const MouseFieldCache&) {
+            ready.clear();
+            return *this;
+        }
+    };
+    MouseFieldCache mouse_fields_;  // 현재 맵 기준 (프로그램 간 공유, 벽이 바뀌면 초기화)
+    MoveContext mouse_context(const GameState& sim_state, const Position& mouse,
+                              MouseFieldCache& local) const;
 
     // ========== 충돌 감지 ==========
 
     // Crossing 감지 (서로 교차)
     bool check_crossing(const Position& p1, const Position& p1_last,
                         const Position& p2, const Position& p2_last) const;
+
+    // ========== 충돌 불가 인증 ==========
+
+    // 현재 위치 기준으로 이후 몇 스텝 동안 충돌이 불가능한지 계산
+    // (매 스텝 최대 1칸씩 움직이므로 거리 d인 두 엔티티는 (d-1)/2 스텝 동안 만날 수 없음)
+    // cache: sim_state와 벽이 같은 전역 캐시 (런마다 한 번 확인), nullptr이면 맨해튼 거리
+    int certify_cat_window(const GameState& sim_state, const GlobalDistanceCache* cache) const;
+    int certify_crzbc_window(const GameState& sim_state, const GlobalDistanceCache* cache) const;
 };
 
 // ============================================================
@@ -181,7 +411,37 @@ private:
 std::vector<float> batch_simulate(
     const std::vector<std::vector<int>>& programs,
     const GameState& initial_state,
-    int num_threads = 0  // 0 = 자동 감지
+    int num_threads = 0,  // 0 = 자동 감지
+    MovePolicy cat_policy = MovePolicy::RANDOM,
+    MovePolicy crzbc_policy = MovePolicy::RANDOM,
+    const std::vector<int>& functions = {},  // 평면 형식 함수 교체 (채굴한 함수 바로 평가)
+    const RuleSet& rules = RuleSet()
+);
+
+// ============================================================
+// 상태 x 프로그램 점수 행렬 (병렬, out[s * programs.size() + p])
+// 프로그램은 한 번 컴파일해 모든 상태에서 공유, 상태별 캐시(토폴로지 / 거리 맵)는
+// (상태, 프로그램 블록) 타일 안에서 프로그램 간 공유
+// ============================================================
+std::vector<float> evaluate_matrix(
+    const std::vector<GameState>& states,
+    const std::vector<std::vector<int>>& programs,
+    int num_threads = 0,  // 0 = 자동 감지
+    MovePolicy cat_policy = MovePolicy::RANDOM,
+    MovePolicy crzbc_policy = MovePolicy::RANDOM,
+    const std::vector<int>& functions = {},
+    const RuleSet& rules = RuleSet()
+);
+
+// 컴파일된 프로그램 행렬 평가 (evaluate_matrix 본체, ProgramRegistry 핸들 배치 등)
+// 컴파일 결과에 함수 본문이 들어 있으므로 라이브러리 교체는 컴파일할 때 반영
+std::vector<float> evaluate_compiled(
+    const std::vector<GameState>& states,
+    const std::vector<const CompiledProgram*>& programs,
+    int num_threads = 0,
+    MovePolicy cat_policy = MovePolicy::RANDOM,
+    MovePolicy crzbc_policy = MovePolicy::RANDOM,
+    const RuleSet& rules = RuleSet()
 );
 
 } // namespace simulator
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "simulator.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 분기 묶음: Simulator fork 여러 개를 한 번에 진행 / 평가 (트리 탐색용)
+// 포크마다 독립 Simulator라 포크 단위 OpenMP 병렬 (토폴로지 / 함수 라이브러리는 공유)
+// 프로그램 배열은 포크 순서와 1:1 (step / simulate), evaluate만 포크 x 프로그램 전체
+// 이미 끝난 게임 (승리 / 패배)인 포크는 step에서 건너뛰고 점수 0
+// ============================================================
+class SimulatorBatch {
+public:
+    SimulatorBatch() = default;
+    SimulatorBatch(const Simulator& parent, int k) : sims_(parent.fork_n(k)) {}
+    explicit SimulatorBatch(std::vector<Simulator> sims) : sims_(std::move(sims)) {}
+
+    size_t size() const { return sims_.size(); }
+    Simulator& at(size_t i) { return sims_[i]; }
+    const Simulator& at(size_t i) const { return sims_[i]; }
+    void add(const Simulator& sim) { sims_.push_back(sim.fork()); }
+    void clear() { sims_.clear(); }
+
+    // 모든 포크를 같은 상태로 되돌림
+    void restore_all(const GameState& state);
+    // 포크 i마다 엔티티 RNG 시드 = base + i (같은 난수열 해제)
+    void seed_all(uint32_t base);
+
+    // 포크 i에서 programs[i] 실행 후 상태 반영 (execute_program)
+    std::vector<float> step(const std::vector<std::vector<int>>& programs, int num_threads = 0,
+                            MovePolicy cat_policy = MovePolicy::RANDOM,
+                            MovePolicy crzbc_policy = MovePolicy::RANDOM);
+    std::vector<float> step(const std::vector<const CompiledProgram*>& programs, int num_threads = 0,
+                            MovePolicy cat_policy = MovePolicy::RANDOM,
+                            MovePolicy crzbc_policy = MovePolicy::RANDOM);
+
+    // 포크 i에서 programs[i] 평가 (상태 변경 없음)
+    std::vector<float> simulate(const std::vector<std::vector<int>>& programs, int num_threads = 0,
+                                MovePolicy cat_policy = MovePolicy::RANDOM,
+                                MovePolicy crzbc_policy = MovePolicy::RANDOM);
+    std::vector<float> simulate(const std::vector<const CompiledProgram*>& programs, int num_threads = 0,
+                                MovePolicy cat_policy = MovePolicy::RANDOM,
+                                MovePolicy crzbc_policy = MovePolicy::RANDOM);
+
+    // 모든 포크 x 모든 프로그램 평가, out[f * programs.size() + p]
+    std::vector<float> evaluate(const std::vector<const CompiledProgram*>& programs, int num_threads = 0,
+                                MovePolicy cat_policy = MovePolicy::RANDOM,
+                                MovePolicy crzbc_policy = MovePolicy::RANDOM);
+
+private:
+    std::vector<Simulator> sims_;
+};
+
+} // namespace simulator
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "game_state.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 고정 길이 상태 레코드 (여러 상태를 한 버퍼로 주고받기 위한 압축 형식)
+// wall / junc / deadend: 121비트 (0 아닌 값 = 1), sc: 칸당 1바이트
+// 엔티티: 개수 + 슬롯별 (x, y, last_x, last_y, direction, active)
+// 스칼라: score(4) life / step / step_limit / run(2) func_chance / red_zone(1) 플래그(1)
+// 리틀 엔디언, 빌드와 무관한 바이트 배치
+// ============================================================
+namespace StateCodec {
+    constexpr size_t MASK_BYTES = (TOTAL_CELLS + 7) / 8;                        // 16
+    constexpr size_t ENTITY_SLOT_BYTES = 6;
+    constexpr size_t RECORD_SIZE =
+        3 * MASK_BYTES + TOTAL_CELLS                                             // 그리드
+        + 4                                                                      // 마우스
+        + 3 + ENTITY_SLOT_BYTES * (Config::MAX_CATS + Config::MAX_MOVBC + Config::MAX_CRZBC)
+        + 4 + 2 * 4 + 2 + 1;                                                     // 스칼라
+
+    void encode(const GameState& state, uint8_t* out);
+    // 맵 마스크 (앞 3 * MASK_BYTES)는 건드리지 않고 나머지만 기록 (같은 맵 상태를 연속으로 쓸 때)
+    void encode_dynamic(const GameState& state, uint8_t* out);
+    // 엔티티 개수가 [0, MAX_N] 밖이거나 마우스 / 엔티티 위치가 맵 밖이면 false (빈 슬롯 (-1, -1)은 허용)
+    bool decode(const uint8_t* in, GameState& state);
+
+    // n개 레코드 연속 버퍼 (잘못된 레코드가 하나라도 있으면 false, states는 비움)
+    std::vector<uint8_t> encode_all(const std::vector<GameState>& states);
+    bool decode_all(const uint8_t* blob, size_t n, std::vector<GameState>& states);
+}
+
+} // namespace simulator
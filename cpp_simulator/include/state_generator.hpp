@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "game_state.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 임의 중반 상태 생성 설정 (범위는 양 끝 포함)
+// ============================================================
+struct StateGenConfig {
+    uint64_t seed = 0;
+    int num_threads = 0;              // 0 = 자동 감지
+
+    // 작은 치즈: 상태마다 남길 비율 u ~ U[cheese_min, cheese_max], 후보 칸마다 확률 u로 남김
+    float cheese_min = 0.0f;
+    float cheese_max = 1.0f;
+    // 마우스: 이 확률로 시작 칸 (10, 10), 나머지는 빈 칸 균등
+    float mouse_at_start = 0.0f;
+    // 고양이 수와 마우스까지 BFS 거리 하한 (바로 잡히는 배치 제외)
+    int num_cats = Config::NUM_CATS;
+    int min_cat_distance = 3;
+    // 빅치즈마다 아직 남아 있을 확률 (먹혔으면 (-1, -1), active = 0)
+    float movbc_alive = 0.5f;
+    float crzbc_alive = 0.5f;
+
+    int life_min = 1;
+    int life_max = Config::DEFAULT_LIFE;
+    int run_min = 0;
+    int run_max = Config::MAX_RUNS - 1;
+    int step_min = 0;
+    int step_max = Config::DEFAULT_STEP_LIMIT - 1;
+    // true: 점수 = 먹은 치즈 / 빅치즈 + 잃은 목숨 점수 (벽 충돌 제외), false: 0
+    bool consistent_score = true;
+};
+
+// ============================================================
+// 임의 유효 상태 생성기 (기준 맵의 벽 / 교차로 / 치즈 후보 위에 무작위 중반 상태)
+// - 엔티티는 빈 칸, 서로 다른 칸, 방향은 막히지 않은 쪽, last = 현재 위치
+// - 고양이는 마우스에서 min_cat_distance 이상 (불가능하면 가장 먼 칸)
+// - 작은 치즈 1개 이상, 마우스 칸 치즈 없음, 진행 중 (승리 / 패배 / catched 아님)
+// - 규칙과 어긋나지 않게: step >= 먹은 치즈 수, life >= 기본 목숨 - run, step < step_limit
+// 상태 i는 (seed, i)로 정해지는 RNG만 사용 → 스레드 수와 무관하게 재현
+// ============================================================
+class StateGenerator {
+public:
+    explicit StateGenerator(const StateGenConfig& config = StateGenConfig());
+    StateGenerator(const StateGenConfig& config, const GameState& base);
+
+    const StateGenConfig& config() const { return config_; }
+    // 치즈 후보 칸이 2개 이상 (마우스 칸을 빼도 치즈 하나를 남길 수 있음), 아니면 generate_one은 기준 상태 그대로
+    bool valid() const { return cheese_.size() >= 2; }
+
+    // index번째 상태
+    void generate_one(uint64_t index, GameState& out) const;
+    // [first, first + n) 상태를 StateCodec 레코드로 out에 기록 (n * RECORD_SIZE 바이트, 병렬)
+    void generate(uint64_t first, size_t n, uint8_t* out) const;
+    std::vector<uint8_t> generate(uint64_t first, size_t n) const;
+
+private:
+    StateGenConfig config_;
+    GameState base_;                  // 벽 / 교차로 / 막다른 길 + 스칼라 기본값
+    std::vector<int16_t> open_;       // 빈 칸 번호
+    std::vector<int16_t> cheese_;     // 치즈 후보 칸 번호
+    std::vector<uint8_t> dist_;       // 칸 x 칸 BFS 거리 (255 = 도달 불가)
+    std::vector<uint8_t> open_dirs_;  // 칸별 막히지 않은 방향 비트마스크
+    uint8_t map_masks_[3 * ((TOTAL_CELLS + 7) / 8)];  // 레코드 앞부분 (벽 / 교차로 / 막다른 길)
+
+    void init();
+};
+
+} // namespace simulator
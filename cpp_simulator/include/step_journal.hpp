@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "constants.hpp"
+#include "game_state.hpp"
+#include "bitboard.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 뽑은 횟수를 세는 mt19937 (저널이 RNG 위치를 draws로 기록)
+// ============================================================
+class CountedRng {
+public:
+    using result_type = std::mt19937::result_type;
+    static constexpr result_type min() { return std::mt19937::min(); }
+    static constexpr result_type max() { return std::mt19937::max(); }
+
+    explicit CountedRng(result_type value = std::mt19937::default_seed) : engine_(value) {}
+
+    result_type operator()() {
+        draws_++;
+        return engine_();
+    }
+    void seed(result_type value) {
+        engine_.seed(value);
+        draws_ = 0;
+    }
+
+    uint64_t draws() const { return draws_; }
+    const std::mt19937& engine() const { return engine_; }
+    // saved (saved_draws 위치)에서 target 위치까지 다시 진행
+    void rewind(const std::mt19937& saved, uint64_t saved_draws, uint64_t target) {
+        engine_ = saved;
+        engine_.discard(target - saved_draws);
+        draws_ = target;
+    }
+
+private:
+    std::mt19937 engine_;
+    uint64_t draws_ = 0;
+};
+
+// ============================================================
+// 런 하나의 되돌리기 기록 (고정 크기, 런 전에 채우고 먹은 치즈는 런 중에 추가)
+// 맵 (벽 / 교차로 / 막다른 길)은 런에서 바뀌지 않으므로 기록하지 않음
+// 작은 치즈는 먹은 칸 비트만, 엔티티는 배열째 (합쳐서 100바이트 남짓)
+// ============================================================
+struct JournalEntry {
+    CellMask eaten;                         // 이번 런에서 먹은 작은 치즈 (시뮬레이션 루프가 기록)
+    Position mouse, mouse_last;             // 이전 마우스 위치
+    CatArray cats;                          // 이전 엔티티
+    MovbcArray movbc;
+    CrzbcArray crzbc;
+
+    int32_t score = 0;                      // 이전 스칼라
+    int16_t life = 0;
+    int16_t step = 0;
+    int16_t run = 0;
+    int16_t step_limit = 0;                 // 규칙이 덮어쓰는 값도 이전 값 그대로
+    int8_t func_chance = 0;
+    int8_t red_zone = 0;
+    bool win_sign = false;
+    bool lose_sign = false;
+    bool catched = false;
+
+    uint64_t rng_draws = 0;                 // 런 시작 시점 RNG 위치
+
+    // 런 시작 전 상태 기록 (eaten은 비움)
+    void capture(const GameState& before, uint64_t draws);
+    // 런 후 상태를 capture 시점으로 되돌림
+    void revert(GameState& state) const;
+};
+
+// ============================================================
+// 되돌리기 저널 (깊이 우선 탐색 / MCTS 하강용)
+// Simulator::apply가 런마다 기록을 쌓고 undo가 하나씩 되돌림 (상태 복사 없음)
+// 기록은 미리 잡아 둔 버퍼에 쌓이므로 capacity 안에서는 힙 할당 없음
+// RNG는 위치 (draws)만 기록하고, 약 CHECKPOINT_INTERVAL번 뽑을 때마다 엔진 사본 하나를 남겨
+// 되돌릴 때 가장 가까운 사본에서 다시 진행 (사본은 깊이 + 1개 이하 → capacity + 1개 미리 확보)
+// 한 Simulator 전용, seed / restore_state / reset 후에는 이전 기록을 버림
+// ============================================================
+class StepJournal {
+public:
+    static constexpr uint64_t CHECKPOINT_INTERVAL = 1024;
+
+    explicit StepJournal(size_t capacity = 256);
+
+    size_t depth() const { return depth_; }
+    bool empty() const { return depth_ == 0; }
+    size_t capacity() const { return entries_.size(); }
+    const JournalEntry& back() const { return entries_[depth_ - 1]; }
+    void clear();
+
+    // ========== Simulator 전용 ==========
+
+    uint32_t epoch() const { return epoch_; }
+    // 새 런 시작: 다른 시점 (epoch)의 기록이면 버리고, 필요하면 RNG 사본 저장
+    JournalEntry& begin(uint32_t epoch, const CountedRng& rng);
+    // 마지막 기록 꺼내고 RNG를 그 런 시작 위치로 되돌림
+    const JournalEntry& pop(CountedRng& rng);
+
+private:
+    struct RngCheckpoint {
+        uint64_t draws;
+        std::mt19937 engine;
+    };
+
+    std::vector<JournalEntry> entries_;
+    size_t depth_ = 0;
+    std::vector<RngCheckpoint> checkpoints_;
+    uint32_t epoch_ = 0;
+};
+
+} // namespace simulator
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "constants.hpp"
+#include "game_state.hpp"
+#include "function_library.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 맵 대칭 (정사각형 격자의 8가지 대칭 = D4)
+// 레벨 3: wall / sc / junc / deadend 가 5열 기준 좌우 대칭 (MIRROR_LR)
+// ============================================================
+enum class Symmetry : uint8_t {
+    IDENTITY = 0,
+    MIRROR_LR = 1,       // (x, y) → (x, 10-y)       LEFT ↔ RIGHT
+    MIRROR_UD = 2,       // (x, y) → (10-x, y)       UP ↔ DOWN
+    ROT180 = 3,          // (x, y) → (10-x, 10-y)
+    TRANSPOSE = 4,       // (x, y) → (y, x)
+    ANTI_TRANSPOSE = 5,  // (x, y) → (10-y, 10-x)
+    ROT90 = 6,           // (x, y) → (y, 10-x)
+    ROT270 = 7,          // (x, y) → (10-y, x)
+};
+constexpr int NUM_SYMMETRIES = 8;
+
+// 828차원 벡터 배치 (StateVec / FeatureVec 차원이 같아서 호출자가 명시)
+enum class VectorLayout : uint8_t {
+    STATE_VEC = 0,       // 격자 4장 + 위치 (x, y) + 스칼라: 대칭 변환 가능
+    FEATURE_VEC = 1,     // 방향 / 좌우 의존 항목 포함: 변환 불가
+};
+
+namespace symmetry_detail {
+    // 좌표 변환: x' = A*x + B*y (+10), y' = C*x + D*y (+10), 음수 계수면 +10
+    constexpr int8_t MAT[NUM_SYMMETRIES][4] = {
+        { 1,  0,  0,  1},
+        { 1,  0,  0, -1},
+        {-1,  0,  0,  1},
+        {-1,  0,  0, -1},
+        { 0,  1,  1,  0},
+        { 0, -1, -1,  0},
+        { 0,  1, -1,  0},
+        { 0, -1,  1,  0},
+    };
+    // 방향 변환 (UP, DOWN, LEFT, RIGHT 순)
+    constexpr int8_t DIR[NUM_SYMMETRIES][Direction::COUNT] = {
+        {0, 1, 2, 3},
+        {0, 1, 3, 2},
+        {1, 0, 2, 3},
+        {1, 0, 3, 2},
+        {2, 3, 0, 1},
+        {3, 2, 1, 0},
+        {3, 2, 0, 1},
+        {2, 3, 1, 0},
+    };
+    // 역변환 (ROT90 ↔ ROT270, 나머지는 자기 자신)
+    constexpr uint8_t INVERSE[NUM_SYMMETRIES] = {0, 1, 2, 3, 4, 5, 7, 6};
+}
+
+inline Symmetry inverse(Symmetry sym) {
+    return static_cast<Symmetry>(symmetry_detail::INVERSE[static_cast<int>(sym)]);
+}
+
+// 칸 좌표 변환 (맵 밖 좌표 = 빈 슬롯은 그대로)
+inline Position transform_pos(const Position& p, Symmetry sym) {
+    if (!p.is_valid()) return p;
+    const int8_t* m = symmetry_detail::MAT[static_cast<int>(sym)];
+    int x = m[0] * p.x + m[1] * p.y + ((m[0] + m[1]) < 0 ? MAP_SIZE - 1 : 0);
+    int y = m[2] * p.x + m[3] * p.y + ((m[2] + m[3]) < 0 ? MAP_SIZE - 1 : 0);
+    return Position(static_cast<int8_t>(x), static_cast<int8_t>(y));
+}
+
+// 방향 변환 (범위 밖 값은 그대로)
+inline int transform_dir(int dir, Symmetry sym) {
+    if (dir < 0 || dir >= Direction::COUNT) return dir;
+    return symmetry_detail::DIR[static_cast<int>(sym)][dir];
+}
+
+// 함수 본문 변환: 방향 토큰만 바뀜 (LOOP/IF 횟수 토큰은 100번대라 충돌 없음)
+inline std::vector<int> transform_body(const std::vector<int>& body, Symmetry sym) {
+    std::vector<int> out(body);
+    for (int& t : out) {
+        if (Token::is_direction(t)) t = transform_dir(t, sym);
+    }
+    return out;
+}
+
+void transform_grid(const GridMap& in, GridMap& out, Symmetry sym);
+GameState transform_state(const GameState& state, Symmetry sym);
+
+// 벽 / 교차로 / 막다른 길을 보존하는 대칭 비트마스크 (bit i = Symmetry i, IDENTITY 항상 포함)
+uint8_t detect_map_symmetries(const GameState& state);
+
+// 상태 해시 (맵 + 엔티티 + 스칼라 전체, 전치 테이블 / 데이터셋 중복 키)
+uint64_t state_hash(const GameState& state);
+
+// ============================================================
+// 맵 대칭 정규화기
+// 생성 시 맵 대칭 검출 + 함수 라이브러리 대칭 ID 테이블 구축 (1회)
+// 이후 (상태, 프로그램) 정규화와 상태 벡터 증강은 읽기 전용 (스레드 안전)
+// ============================================================
+class MapSymmetry {
+public:
+    struct Canonical {
+        GameState state;
+        std::vector<int> program;
+        Symmetry sym;       // 원본 → 대표 변환 (복원: inverse(sym))
+        uint64_t hash;
+    };
+
+    MapSymmetry(const GameState& map_state, const FunctionLibrary& lib);
+
+    uint8_t mask() const { return mask_; }
+    bool has(Symmetry sym) const { return (mask_ >> static_cast<int>(sym)) & 1u; }
+    std::vector<Symmetry> symmetries() const;
+
+    // 함수 ID의 대칭 이미지 (본문이 같은 가장 작은 ID, 없으면 -1)
+    int transform_function(int func_id, Symmetry sym) const;
+    // 라이브러리 중 대칭 이미지가 있는 함수 수
+    int mappable_functions(Symmetry sym) const;
+
+    // 프로그램 토큰 변환 (대응 함수가 없거나 F1/F2 배정이 바뀌면 false)
+    bool transform_program(const std::vector<int>& program, Symmetry sym,
+                           std::vector<int>& out) const;
+
+    // 맵 대칭 중 해시가 가장 작은 대표로 정규화 (프로그램 변환 불가 대칭은 제외)
+    Canonical canonicalize(const GameState& state, const std::vector<int>& program) const;
+
+    // 828차원 상태 벡터 n개 변환 (in/out: n x StateVec::DIM, 행 우선)
+    // StateVec 배치만 지원, 다른 layout이면 out을 건드리지 않고 false
+    static bool transform_state_vectors(const float* in, float* out, size_t n, Symmetry sym,
+                                        VectorLayout layout = VectorLayout::STATE_VEC);
+
+private:
+    uint8_t mask_;
+    // func_map_[sym][id - FUNC_LIB_START] = 대칭 ID (-1 = 없음)
+    std::array<std::vector<int16_t>, NUM_SYMMETRIES> func_map_;
+};
+
+} // namespace simulator
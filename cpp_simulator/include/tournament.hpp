@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "game_state.hpp"
+#include "move_policy.hpp"
+#include "rules.hpp"
+
+namespace simulator {
+
+// ============================================================
+// 탐색 정책 (런마다 프로그램 하나를 고르는 방법)
+// - RUNNING_MAX: game_worker.generate_running_max_standalone 포팅
+//   (토큰마다 방향 4개 +15 / LOOP 후보 96개 x0.5 중 최고, budget = 그룹 크기)
+// - SAMPLED: 확률표에서 문법 유효 프로그램 budget개 샘플 (grpo_sampler와 같은 방식)
+//   확률표가 비어 있으면 방향 / 구조 토큰 균등 (라이브러리 함수 제외)
+// 그룹에서 최종 선택 = evals회 평균 점수 최고 (동점이면 짧은 프로그램)
+// ============================================================
+enum class SearchKind : int {
+    RUNNING_MAX = 0,
+    SAMPLED = 1,
+};
+
+struct SearchPolicy {
+    std::string name;
+    SearchKind kind = SearchKind::RUNNING_MAX;
+    int budget = 32;             // 그룹 크기 (후보 프로그램 수)
+    int max_tokens = 10;
+    int evals = 1;               // 최종 선택 평가 반복
+    // SAMPLED 확률표 (grpo_sampler 형식: positions x slots x vocab)
+    std::vector<float> probs;
+    int n_positions = 0;
+    int n_slots = 1;
+    int vocab = 0;
+    float temperature = 1.0f;
+};
+
+struct TournamentConfig {
+    int games = 100;             // 정책별 게임 수
+    int max_runs = Config::MAX_RUNS;
+    uint64_t seed = 0;
+    int num_threads = 0;         // 0 = 자동 감지
+    MovePolicy cat_policy = MovePolicy::RANDOM;
+    MovePolicy crzbc_policy = MovePolicy::RANDOM;
+    std::vector<int> functions;  // 평면 형식 함수 교체 (batch_simulate와 동일)
+    RuleSet rules;
+};
+
+// 신뢰 구간은 95% (승률: Wilson, 나머지: 정규 근사)
+struct Interval {
+    double mean = 0.0;
+    double lo = 0.0;
+    double hi = 0.0;
+};
+
+struct PolicyReport {
+    std::string name;
+    int games = 0;
+    int wins = 0;
+    Interval win_rate;
+    Interval score;
+    double score_std = 0.0;
+    std::vector<double> score_quantiles;   // 10 / 25 / 50 / 75 / 90%
+    Interval runs_to_win;                  // 이긴 게임만
+    double sims_per_decision = 0.0;
+    uint64_t decisions = 0;
+    Interval score_diff;                   // 첫 정책 대비 게임별 점수 차 (같은 시드끼리 대응)
+    // 게임별 원자료 (게임 순번 = 시드 순번)
+    std::vector<float> scores;
+    std::vector<int> runs;
+    std::vector<uint8_t> won;
+};
+
+class Simulator;
+
+// ============================================================
+// 한 런의 탐색 (토너먼트 / 생성 파이프라인 공용)
+// 런 시작 상태에서 후보 그룹 생성 → evals회 평균 점수 순 정렬 (동점이면 짧은 프로그램, 먼저 만든 순)
+// sim은 탐색 전용 (상태 / 시드를 덮어씀), probs는 search_probs(policy) 결과
+// ============================================================
+struct SearchResult {
+    std::vector<std::vector<int>> programs;   // END 포함
+    std::vector<double> scores;               // 런 시작 대비 평균 점수 변화
+    uint64_t sims = 0;
+};
+
+SearchResult search_run(Simulator& sim, const GameState& state, const SearchPolicy& policy,
+                        const TournamentConfig& config, const std::vector<float>& probs,
+                        std::mt19937_64& rng);
+
+// SAMPLED 확률표 (비어 있으면 방향 / 구조 토큰 균등), RUNNING_MAX는 빈 벡터
+std::vector<float> search_probs(const SearchPolicy& policy);
+
+// 게임 m의 실제 게임 / 탐색 RNG 시드 (seed, m에서 파생)
+uint64_t game_seed(uint64_t seed, int64_t game);
+uint64_t search_seed(uint64_t seed, int64_t game);
+
+// ============================================================
+// 토너먼트: 정책마다 같은 시드 집합으로 games판 (공통 난수)
+// 게임 m: 시작 상태 starts[m % starts.size()], 실제 게임 / 탐색 RNG 모두 (seed, m)에서 파생
+// → 정책 간 차이는 탐색 결과에서만 생김. (정책, 게임) 단위 OpenMP 병렬, 결과는 스레드 수와 무관
+// ============================================================
+std::vector<PolicyReport> run_tournament(const std::vector<GameState>& starts,
+                                         const std::vector<SearchPolicy>& policies,
+                                         const TournamentConfig& config);
+
+} // namespace simulator
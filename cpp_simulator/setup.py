@@ -24,6 +24,24 @@ ext_modules = [
         "cpp_simulator",
         sources=[
             "src/simulator.cpp",
+            "src/symmetry.cpp",
+            "src/function_index.cpp",
+            "src/ngram_miner.cpp",
+            "src/state_codec.cpp",
+            "src/grpo_sampler.cpp",
+            "src/checkpoint_store.cpp",
+            "src/sample_dedupe.cpp",
+            "src/opening_book.cpp",
+            "src/tournament.cpp",
+            "src/run_stats.cpp",
+            "src/pipeline.cpp",
+            "src/cheese_field.cpp",
+            "src/features.cpp",
+            "src/program_registry.cpp",
+            "src/simulator_batch.cpp",
+            "src/step_journal.cpp",
+            "src/state_generator.cpp",
+            "src/program_generator.cpp",
             "src/bindings.cpp",
         ],
         include_dirs=["include"],
@@ -5,6 +5,24 @@
 #include "simulator.hpp"
 #include "game_state.hpp"
 #include "constants.hpp"
+#include "symmetry.hpp"
+#include "function_index.hpp"
+#include "ngram_miner.hpp"
+#include "state_codec.hpp"
+#include "grpo_sampler.hpp"
+#include "checkpoint_store.hpp"
+#include "sample_dedupe.hpp"
+#include "opening_book.hpp"
+#include "tournament.hpp"
+#include "run_stats.hpp"
+#include "pipeline.hpp"
+#include "features.hpp"
+#include "program_registry.hpp"
+#include "simulator_batch.hpp"
+#include "state_generator.hpp"
+#include "program_generator.hpp"
+#include <cstring>
+#include <algorithm>
 
 namespace py = pybind11;
 
@@ -28,29 +46,25 @@ simulator::GameState dict_to_state(py::dict state_dict) {
         state.mouse_last = state.mouse;
     }
 
-    // cat
+    // cat (개수 = 리스트 길이, 최대 MAX_CATS)
     auto cat = state_dict["cat"].cast<std::vector<std::vector<int>>>();
-    for (size_t i = 0; i < cat.size() && i < simulator::Config::NUM_CATS; i++) {
-        state.cats[i].pos.x = cat[i][0];
-        state.cats[i].pos.y = cat[i][1];
-        state.cats[i].last_pos = state.cats[i].pos;
-        state.cats[i].active = true;
+    for (size_t i = 0; i < cat.size() && i < simulator::Config::MAX_CATS; i++) {
+        state.cats.add(simulator::Position(cat[i][0], cat[i][1]));
     }
 
     // cat_last_pos (옵션)
     if (state_dict.contains("cat_last_pos")) {
         auto cl = state_dict["cat_last_pos"].cast<std::vector<std::vector<int>>>();
-        for (size_t i = 0; i < cl.size() && i < simulator::Config::NUM_CATS; i++) {
-            state.cats[i].last_pos.x = cl[i][0];
-            state.cats[i].last_pos.y = cl[i][1];
+        for (size_t i = 0; i < cl.size() && (int)i < state.cats.count; i++) {
+            state.cats.set_last_pos(i, simulator::Position(cl[i][0], cl[i][1]));
         }
     }
 
     // cat_direction (옵션)
     if (state_dict.contains("cat_direction")) {
         auto cd = state_dict["cat_direction"].cast<std::vector<int>>();
-        for (size_t i = 0; i < cd.size() && i < simulator::Config::NUM_CATS; i++) {
-            state.cats[i].direction = cd[i];
+        for (size_t i = 0; i < cd.size() && (int)i < state.cats.count; i++) {
+            state.cats.direction[i] = cd[i];
         }
     }
 
@@ -88,27 +102,21 @@ simulator::GameState dict_to_state(py::dict state_dict) {
 
     // movbc
     auto movbc = state_dict["movbc"].cast<std::vector<std::vector<int>>>();
-    for (size_t i = 0; i < movbc.size() && i < simulator::Config::NUM_MOVBC; i++) {
-        state.movbc[i].pos.x = movbc[i][0];
-        state.movbc[i].pos.y = movbc[i][1];
-        state.movbc[i].last_pos = state.movbc[i].pos;
-        state.movbc[i].active = true;
+    for (size_t i = 0; i < movbc.size() && i < simulator::Config::MAX_MOVBC; i++) {
+        state.movbc.add(simulator::Position(movbc[i][0], movbc[i][1]));
     }
 
     // crzbc
     auto crzbc = state_dict["crzbc"].cast<std::vector<std::vector<int>>>();
-    for (size_t i = 0; i < crzbc.size() && i < simulator::Config::NUM_CRZBC; i++) {
-        state.crzbc[i].pos.x = crzbc[i][0];
-        state.crzbc[i].pos.y = crzbc[i][1];
-        state.crzbc[i].last_pos = state.crzbc[i].pos;
-        state.crzbc[i].active = true;
+    for (size_t i = 0; i < crzbc.size() && i < simulator::Config::MAX_CRZBC; i++) {
+        state.crzbc.add(simulator::Position(crzbc[i][0], crzbc[i][1]));
     }
 
     // crzbc_direction (옵션)
     if (state_dict.contains("crzbc_direction")) {
         auto cd = state_dict["crzbc_direction"].cast<std::vector<int>>();
-        for (size_t i = 0; i < cd.size() && i < simulator::Config::NUM_CRZBC; i++) {
-            state.crzbc[i].direction = cd[i];
+        for (size_t i = 0; i < cd.size() && (int)i < state.crzbc.count; i++) {
+            state.crzbc.direction[i] = cd[i];
         }
     }
 
@@ -150,10 +158,10 @@ py::dict state_to_dict(const simulator::GameState& state) {
     std::vector<std::vector<int>> cat_vec;
     std::vector<std::vector<int>> cat_last_vec;
     std::vector<int> cat_dir_vec;
-    for (const auto& c : state.cats) {
-        cat_vec.push_back({c.pos.x, c.pos.y});
-        cat_last_vec.push_back({c.last_pos.x, c.last_pos.y});
-        cat_dir_vec.push_back(c.direction);
+    for (int i = 0; i < state.cats.count; i++) {
+        cat_vec.push_back({state.cats.x[i], state.cats.y[i]});
+        cat_last_vec.push_back({state.cats.last_x[i], state.cats.last_y[i]});
+        cat_dir_vec.push_back(state.cats.direction[i]);
     }
     result["cat"] = cat_vec;
     result["cat_last_pos"] = cat_last_vec;
@@ -180,17 +188,17 @@ py::dict state_to_dict(const simulator::GameState& state) {
 
     // movbc
     std::vector<std::vector<int>> movbc_vec;
-    for (const auto& bc : state.movbc) {
-        movbc_vec.push_back({bc.pos.x, bc.pos.y});
+    for (int i = 0; i < state.movbc.count; i++) {
+        movbc_vec.push_back({state.movbc.x[i], state.movbc.y[i]});
     }
     result["movbc"] = movbc_vec;
 
     // crzbc
     std::vector<std::vector<int>> crzbc_vec;
     std::vector<int> crzbc_dir_vec;
-    for (const auto& bc : state.crzbc) {
-        crzbc_vec.push_back({bc.pos.x, bc.pos.y});
-        crzbc_dir_vec.push_back(bc.direction);
+    for (int i = 0; i < state.crzbc.count; i++) {
+        crzbc_vec.push_back({state.crzbc.x[i], state.crzbc.y[i]});
+        crzbc_dir_vec.push_back(state.crzbc.direction[i]);
     }
     result["crzbc"] = crzbc_vec;
     result["crzbc_direction"] = crzbc_dir_vec;
@@ -212,6 +220,73 @@ py::dict state_to_dict(const simulator::GameState& state) {
     return result;
 }
 
+// ============================================================
+// StatsSnapshot → Python dict 변환 헬퍼
+// ============================================================
+py::dict snapshot_to_dict(const simulator::StatsSnapshot& s) {
+    py::dict d;
+    d["games"] = s.games;
+    d["wins"] = s.wins;
+    d["win_rate"] = s.games ? static_cast<double>(s.wins) / s.games : 0.0;
+    d["score_mean"] = s.score_mean();
+    d["score_std"] = s.score_std();
+    d["runs_mean"] = s.games ? static_cast<double>(s.runs_sum) / s.games : 0.0;
+    d["runs_to_win_mean"] = s.wins ? static_cast<double>(s.win_runs_sum) / s.wins : 0.0;
+
+    py::dict score_hist;
+    score_hist["edges"] = s.score_edges();
+    score_hist["counts"] = s.score_hist;
+    d["score_hist"] = score_hist;
+
+    std::vector<double> delta_mean;
+    for (size_t r = 0; r < s.runs.size(); r++) {
+        delta_mean.push_back(s.runs[r] ? static_cast<double>(s.delta_sum[r]) / s.runs[r] : 0.0);
+    }
+    py::dict per_run;
+    per_run["runs"] = s.runs;
+    per_run["delta_mean"] = delta_mean;
+    per_run["small_cheese"] = s.small_cheese;
+    per_run["big_cheese"] = s.big_cheese;
+    per_run["catches"] = s.catches;
+    per_run["wins"] = s.wins_at;
+    d["per_run"] = per_run;
+
+    py::dict delta_hist;
+    delta_hist["edges"] = s.delta_edges();
+    delta_hist["counts"] = s.delta_hist;
+    d["delta_hist"] = delta_hist;
+
+    py::dict search;
+    search["count"] = s.search_count;
+    search["mean"] = s.search_count ? static_cast<double>(s.search_us_sum) / s.search_count : 0.0;
+    search["p50"] = s.search_percentile(0.50);
+    search["p90"] = s.search_percentile(0.90);
+    search["p99"] = s.search_percentile(0.99);
+    d["search_us"] = search;
+    return d;
+}
+
+// ============================================================
+// 핸들 배열 → 컴파일된 프로그램 (잘못된 핸들이면 IndexError)
+// ============================================================
+std::vector<const simulator::CompiledProgram*> resolve_handles(
+    const simulator::ProgramRegistry& registry,
+    const py::array_t<int32_t, py::array::c_style | py::array::forcecast>& handles) {
+    if (handles.ndim() != 1) throw py::value_error("handles must be a 1-D int32 array");
+    const size_t n = static_cast<size_t>(handles.shape(0));
+    std::vector<const simulator::CompiledProgram*> compiled = registry.resolve(handles.data(), n);
+    if (compiled.size() != n) throw py::index_error("invalid program handle");
+    return compiled;
+}
+
+// 점수 벡터 → float32 배열
+py::array_t<float> to_float_array(const std::vector<float>& v) {
+    py::array_t<float> out(static_cast<py::ssize_t>(v.size()));
+    if (!v.empty()) std::memcpy(out.mutable_data(), v.data(), v.size() * sizeof(float));
+    return out;
+}
+
+
 // ============================================================
 // pybind11 모듈 정의
 // ============================================================
@@ -228,7 +303,122 @@ PYBIND11_MODULE(cpp_simulator, m) {
         .def_readwrite("life", &simulator::GameState::life)
         .def_readwrite("step", &simulator::GameState::step)
         .def_readwrite("win_sign", &simulator::GameState::win_sign)
-        .def_readwrite("lose_sign", &simulator::GameState::lose_sign);
+        .def_readwrite("lose_sign", &simulator::GameState::lose_sign)
+        .def_property_readonly("num_cats", [](const simulator::GameState& s) { return (int)s.cats.count; })
+        .def_property_readonly("num_movbc", [](const simulator::GameState& s) { return (int)s.movbc.count; })
+        .def_property_readonly("num_crzbc", [](const simulator::GameState& s) { return (int)s.crzbc.count; });
+
+    // 엔티티 이동 정책
+    py::enum_<simulator::MovePolicy>(m, "MovePolicy")
+        .value("RANDOM", simulator::MovePolicy::RANDOM)
+        .value("FLEE", simulator::MovePolicy::FLEE)
+        .value("CHASE", simulator::MovePolicy::CHASE);
+
+    // 게임 규칙 (기본값이면 상수 폴딩 경로, 아니면 범용 경로)
+    py::class_<simulator::RuleSet>(m, "RuleSet")
+        .def(py::init<>(), "Default rules (same as the Python game)")
+        .def_readwrite("small_cheese", &simulator::RuleSet::small_cheese)
+        .def_readwrite("big_cheese", &simulator::RuleSet::big_cheese)
+        .def_readwrite("cat_collision", &simulator::RuleSet::cat_collision)
+        .def_readwrite("wall_collision", &simulator::RuleSet::wall_collision)
+        .def_readwrite("step_limit", &simulator::RuleSet::step_limit)
+        .def_readwrite("red_zone", &simulator::RuleSet::red_zone)
+        .def_readwrite("victory_run_weight", &simulator::RuleSet::victory_run_weight)
+        .def_readwrite("victory_step_weight", &simulator::RuleSet::victory_step_weight)
+        .def("is_default", &simulator::RuleSet::is_default);
+
+    // 프로그램 인턴 레지스트리 (토큰열 → int32 핸들, 컴파일 결과 재사용)
+    py::class_<simulator::ProgramRegistry>(m, "ProgramRegistry")
+        .def(py::init([](const std::vector<int>& functions) {
+            if (!functions.empty() && !simulator::FunctionLibrary().load_flat(functions)) {
+                throw py::value_error("functions must be a flat library [id, len, tokens...]");
+            }
+            return std::make_unique<simulator::ProgramRegistry>(functions);
+        }), py::arg("functions") = std::vector<int>(),
+           "Intern programs as int32 handles (functions: flat library used for compilation)")
+        .def("intern", [](simulator::ProgramRegistry& self, const std::vector<int>& tokens) {
+            return self.intern(tokens);
+        }, py::arg("tokens"), "Handle of a token list (tokens after the first END are ignored)")
+        .def("intern_batch", [](simulator::ProgramRegistry& self, const std::vector<std::vector<int>>& programs) {
+            py::array_t<int32_t> out(static_cast<py::ssize_t>(programs.size()));
+            int32_t* dst = out.mutable_data();
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < programs.size(); i++) dst[i] = self.intern(programs[i]);
+            return out;
+        }, py::arg("programs"), "List of token lists -> int32 handle array")
+        .def("intern_array", [](simulator::ProgramRegistry& self,
+                                py::array_t<int, py::array::c_style | py::array::forcecast> tokens) {
+            if (tokens.ndim() != 2) throw py::value_error("tokens must be 2-D (n_programs, max_len)");
+            const size_t n = static_cast<size_t>(tokens.shape(0));
+            const size_t len = static_cast<size_t>(tokens.shape(1));
+            py::array_t<int32_t> out(static_cast<py::ssize_t>(n));
+            int32_t* dst = out.mutable_data();
+            const int* src = tokens.data();
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < n; i++) dst[i] = self.intern(src + i * len, len);
+            return out;
+        }, py::arg("tokens"), "Padded (n_programs, max_len) token array (END-terminated rows) -> handles")
+        .def("intern_flat", [](simulator::ProgramRegistry& self,
+                               py::array_t<int, py::array::c_style | py::array::forcecast> tokens,
+                               py::array_t<int64_t, py::array::c_style | py::array::forcecast> offsets) {
+            if (tokens.ndim() != 1 || offsets.ndim() != 1 || offsets.shape(0) < 1) {
+                throw py::value_error("tokens and offsets must be 1-D (offsets: n_programs + 1)");
+            }
+            const size_t n = static_cast<size_t>(offsets.shape(0) - 1);
+            const int64_t* off = offsets.data();
+            for (size_t i = 0; i < n; i++) {
+                if (off[i] < 0 || off[i] > off[i + 1] || off[i + 1] > tokens.shape(0)) {
+                    throw py::value_error("offsets must be non-decreasing and within tokens");
+                }
+            }
+            py::array_t<int32_t> out(static_cast<py::ssize_t>(n));
+            int32_t* dst = out.mutable_data();
+            const int* src = tokens.data();
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = self.intern(src + off[i], static_cast<size_t>(off[i + 1] - off[i]));
+            }
+            return out;
+        }, py::arg("tokens"), py::arg("offsets"),
+           "CSR batch (programs[i] = tokens[offsets[i]:offsets[i+1]]) -> handles")
+        .def("tokens", [](const simulator::ProgramRegistry& self, int32_t handle) {
+            if (!self.valid(handle)) throw py::index_error("invalid program handle");
+            return self.tokens(handle);
+        }, py::arg("handle"), "Canonical token list of a handle")
+        .def_property_readonly("stats", [](const simulator::ProgramRegistry& self) {
+            py::dict d;
+            d["programs"] = self.size();
+            d["hits"] = self.hits();
+            d["misses"] = self.misses();
+            return d;
+        })
+        .def("__len__", &simulator::ProgramRegistry::size);
+
+    // 되돌리기 저널 (Simulator.apply / undo)
+    py::class_<simulator::StepJournal>(m, "StepJournal")
+        .def(py::init<size_t>(), py::arg("capacity") = 256,
+             "Undo stack for Simulator.apply (capacity runs preallocated, grows if exceeded)")
+        .def("__len__", &simulator::StepJournal::depth)
+        .def_property_readonly("capacity", &simulator::StepJournal::capacity)
+        .def("clear", &simulator::StepJournal::clear)
+        .def("last", [](const simulator::StepJournal& self) {
+            if (self.empty()) throw py::index_error("journal is empty");
+            const simulator::JournalEntry& e = self.back();
+            py::list eaten;
+            for (int cell = 0; cell < simulator::TOTAL_CELLS; cell++) {
+                if (e.eaten.test(cell)) {
+                    eaten.append(py::make_tuple(cell / simulator::MAP_SIZE, cell % simulator::MAP_SIZE));
+                }
+            }
+            py::dict d;
+            d["eaten"] = eaten;
+            d["score"] = e.score;
+            d["life"] = e.life;
+            d["step"] = e.step;
+            d["run"] = e.run;
+            d["rng_draws"] = e.rng_draws;
+            return d;
+        }, "Cheese eaten by the most recent apply and the scalars it will restore");
 
     // Simulator 클래스
     py::class_<simulator::Simulator>(m, "Simulator")
@@ -237,12 +427,59 @@ PYBIND11_MODULE(cpp_simulator, m) {
         // 핵심 API - GIL 해제로 병렬 실행 가능
         .def("simulate_program", &simulator::Simulator::simulate_program,
              py::arg("program"),
+             py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+             py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
              py::call_guard<py::gil_scoped_release>(),
              "Execute program and return score (does not modify state)")
+        .def("simulate_handle", [](simulator::Simulator& self, const simulator::ProgramRegistry& registry,
+                                   int32_t handle, simulator::MovePolicy cat_policy,
+                                   simulator::MovePolicy crzbc_policy) {
+            if (!registry.valid(handle)) throw py::index_error("invalid program handle");
+            const simulator::CompiledProgram& compiled = registry.compiled(handle);
+            py::gil_scoped_release release;
+            return self.simulate_compiled(compiled, cat_policy, crzbc_policy);
+        }, py::arg("registry"), py::arg("handle"),
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "simulate_program for an interned program (compiled once in the registry)")
 
+        .def_property("rules", &simulator::Simulator::get_rules, &simulator::Simulator::set_rules,
+             "Game rules used by simulate_program (step_limit / red_zone >= 0 override the state)")
+        .def("load_functions", &simulator::Simulator::load_functions, py::arg("flat"),
+             "Add / replace library functions from a flat [id, len, tokens...] list")
         .def("simulate_program_and_apply", &simulator::Simulator::simulate_program_and_apply,
              py::arg("program"),
              py::call_guard<py::gil_scoped_release>())
+        .def("execute_program", &simulator::Simulator::execute_program,
+             py::arg("program"),
+             py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+             py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+             py::call_guard<py::gil_scoped_release>(),
+             "Play one run and apply it to the state (respawn after a catch, run += 1, "
+             "lose at life / step / run limits); returns the new score")
+        .def("apply", [](simulator::Simulator& self, const std::vector<int>& program,
+                         simulator::StepJournal& journal, simulator::MovePolicy cat_policy,
+                         simulator::MovePolicy crzbc_policy) {
+            py::gil_scoped_release release;
+            return self.apply(program, journal, cat_policy, crzbc_policy);
+        }, py::arg("program"), py::arg("journal"),
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "execute_program that records the run in journal (undo with undo(journal))")
+        .def("apply_handle", [](simulator::Simulator& self, const simulator::ProgramRegistry& registry,
+                                int32_t handle, simulator::StepJournal& journal,
+                                simulator::MovePolicy cat_policy, simulator::MovePolicy crzbc_policy) {
+            if (!registry.valid(handle)) throw py::index_error("invalid program handle");
+            const simulator::CompiledProgram& compiled = registry.compiled(handle);
+            py::gil_scoped_release release;
+            return self.apply(compiled, journal, cat_policy, crzbc_policy);
+        }, py::arg("registry"), py::arg("handle"), py::arg("journal"),
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "apply for an interned program")
+        .def("undo", &simulator::Simulator::undo, py::arg("journal"),
+             "Revert the last apply (state and RNG); False if the journal is empty or the state "
+             "was replaced (seed / restore_state / reset) since")
 
         // 상태 관리 (dict 호환)
         .def("restore_state", [](simulator::Simulator& self, py::dict state_dict) {
@@ -254,11 +491,98 @@ PYBIND11_MODULE(cpp_simulator, m) {
             return state_to_dict(self.get_state());
         }, "Get state as Python dict")
 
+        // 분기 (동적 상태만 복사, 토폴로지 / 함수 라이브러리 공유)
+        .def("fork", [](const simulator::Simulator& self, int64_t seed) {
+            simulator::Simulator child = self.fork();
+            if (seed >= 0) child.seed(static_cast<uint32_t>(seed));
+            return child;
+        }, py::arg("seed") = -1,
+           "Copy of the dynamic state sharing topology, caches and function library "
+           "(seed < 0 keeps the parent's RNG state)")
+        .def("fork_n", [](const simulator::Simulator& self, int k, int64_t seed) {
+            std::vector<simulator::Simulator> forks = self.fork_n(k);
+            if (seed >= 0) {
+                for (size_t i = 0; i < forks.size(); i++) forks[i].seed(static_cast<uint32_t>(seed + i));
+            }
+            return forks;
+        }, py::arg("k"), py::arg("seed") = -1, "k forks (seed >= 0: fork i uses seed + i)")
+        .def("fork_batch", [](const simulator::Simulator& self, int k, int64_t seed) {
+            simulator::SimulatorBatch batch(self, k);
+            if (seed >= 0) batch.seed_all(static_cast<uint32_t>(seed));
+            return batch;
+        }, py::arg("k"), py::arg("seed") = -1, "SimulatorBatch of k forks")
+
         .def("reset", &simulator::Simulator::reset)
 
+        .def("corridor_graph", [](const simulator::Simulator& self) {
+            const simulator::CorridorGraph& g = self.corridor_graph();
+            py::list nodes;
+            for (int16_t cell : g.nodes) {
+                nodes.append(py::make_tuple(cell / simulator::MAP_SIZE, cell % simulator::MAP_SIZE));
+            }
+            py::list edges;
+            for (const auto& e : g.edges) {
+                py::list cells;
+                for (int k = 0; k < e.length; k++) {
+                    int16_t cell = g.edge_cells[e.cell_offset + k];
+                    cells.append(py::make_tuple(cell / simulator::MAP_SIZE, cell % simulator::MAP_SIZE));
+                }
+                py::dict d;
+                d["from"] = e.from;
+                d["to"] = e.to;
+                d["dir"] = e.dir;
+                d["length"] = e.length;
+                d["cells"] = cells;
+                edges.append(d);
+            }
+            py::dict result;
+            result["nodes"] = nodes;
+            result["edges"] = edges;
+            return result;
+        }, "Corridor graph of the current map: nodes [(x, y)] and straight edges")
+
+        // 가장 가까운 치즈 거리장 (치즈를 먹은 칸만 증분 복구, 도달 불가 = 999)
+        .def("cheese_distance", [](simulator::Simulator& self, int x, int y) {
+            if (x < 0 || x >= simulator::MAP_SIZE || y < 0 || y >= simulator::MAP_SIZE) {
+                throw py::index_error("cheese_distance: position out of map");
+            }
+            uint8_t d = self.cheese_distances().distance(simulator::Position(x, y));
+            return d == simulator::CheeseDistanceField::NONE ? 999 : static_cast<int>(d);
+        }, py::arg("x"), py::arg("y"),
+           "Wall-aware distance from (x, y) to the nearest remaining cheese (999 = unreachable)")
+        .def("cheese_distances", [](simulator::Simulator& self) {
+            const auto& dist = self.cheese_distances().distances();
+            std::vector<int> out(simulator::TOTAL_CELLS);
+            for (int c = 0; c < simulator::TOTAL_CELLS; c++) {
+                out[c] = dist[c] == simulator::CheeseDistanceField::NONE ? 999 : dist[c];
+            }
+            return out;
+        }, "121 nearest-cheese distances in row-major order (x * 11 + y), 999 = unreachable; "
+           "same values as lightweight_simulator._compute_cheese_distances_bfs() * 20")
+        .def("cheese_field_stats", [](simulator::Simulator& self) {
+            const simulator::CheeseDistanceField& f = self.cheese_distances();
+            py::dict d;
+            d["rebuilds"] = f.rebuilds();
+            d["removals"] = f.removals();
+            d["repaired_cells"] = f.repaired_cells();
+            return d;
+        }, "Distance field counters: full rebuilds, incremental removals, cells repaired by removals")
+        .def("feature_vector", [](simulator::Simulator& self) {
+            py::array_t<float> out(simulator::FeatureVec::DIM);
+            self.feature_vector(out.mutable_data());
+            return out;
+        }, "828 float32 features of the current state (lightweight_simulator.get_state_vector layout)")
+
         // 캐시 관리 (전역 공유)
         .def("initialize_cache", &simulator::Simulator::initialize_cache,
              "Pre-compute BFS distance maps for all 121 positions (shared globally)")
+        .def("attach_cache", &simulator::Simulator::attach_cache, py::arg("path"),
+             "Memory-map a cache file written by save_cache (read-only, shared across processes); "
+             "False if the file is invalid or was built for a different map")
+        .def_static("save_cache", &simulator::Simulator::save_cache, py::arg("path"),
+             "Write the initialized global distance cache to a file (atomic rename)")
+        .def_static("is_cache_shared", &simulator::Simulator::is_cache_shared,
+             "Check if the global cache is memory-mapped from a file")
         .def_static("enable_global_cache", &simulator::Simulator::enable_global_cache,
              "Enable using the pre-computed global distance cache")
         .def_static("disable_global_cache", &simulator::Simulator::disable_global_cache,
@@ -268,6 +592,25 @@ PYBIND11_MODULE(cpp_simulator, m) {
         .def_static("is_cache_enabled", &simulator::Simulator::is_cache_enabled,
              "Check if global cache is enabled")
 
+        // 충돌 불가 인증 (전역 통계)
+        .def_static("enable_collision_cert", &simulator::Simulator::enable_collision_cert,
+             "Skip collision checks in steps where entities are provably too far apart")
+        .def_static("disable_collision_cert", &simulator::Simulator::disable_collision_cert,
+             "Check collisions on every step")
+        .def_static("is_collision_cert_enabled", &simulator::Simulator::is_collision_cert_enabled,
+             "Check if collision certification is enabled")
+        .def_static("collision_cert_stats", []() {
+            simulator::CollisionCertStats s = simulator::Simulator::collision_cert_stats();
+            py::dict d;
+            d["steps"] = s.steps;
+            d["windows"] = s.windows;
+            d["cat_skipped"] = s.cat_skipped;
+            d["crzbc_skipped"] = s.crzbc_skipped;
+            return d;
+        }, "Accumulated certification counters: steps, windows, cat_skipped, crzbc_skipped")
+        .def_static("reset_collision_cert_stats", &simulator::Simulator::reset_collision_cert_stats,
+             "Reset certification counters")
+
         // 속성
         .def_property_readonly("score", &simulator::Simulator::get_score)
         .def_property_readonly("life", &simulator::Simulator::get_life)
@@ -275,29 +618,1242 @@ PYBIND11_MODULE(cpp_simulator, m) {
         .def_property_readonly("win_sign", &simulator::Simulator::is_win)
         .def_property_readonly("lose_sign", &simulator::Simulator::is_lose);
 
+    // 분기 묶음 (포크 여러 개를 GIL 없이 함께 진행 / 평가)
+    py::class_<simulator::SimulatorBatch>(m, "SimulatorBatch")
+        .def(py::init([](const simulator::Simulator& parent, int k, int64_t seed) {
+            simulator::SimulatorBatch batch(parent, k);
+            if (seed >= 0) batch.seed_all(static_cast<uint32_t>(seed));
+            return batch;
+        }), py::arg("parent"), py::arg("k"), py::arg("seed") = -1,
+           "k forks of parent (seed >= 0: fork i uses seed + i)")
+        .def("__len__", &simulator::SimulatorBatch::size)
+        .def("__getitem__", [](simulator::SimulatorBatch& self, size_t i) -> simulator::Simulator& {
+            if (i >= self.size()) throw py::index_error("fork index out of range");
+            return self.at(i);
+        }, py::return_value_policy::reference_internal, "Fork i (a view, valid while the batch lives)")
+        .def("add", &simulator::SimulatorBatch::add, py::arg("sim"), "Append a fork of sim")
+        .def("restore_all", [](simulator::SimulatorBatch& self, py::dict state_dict) {
+            self.restore_all(dict_to_state(state_dict));
+        }, py::arg("state_dict"), "Reset every fork to the same state")
+        .def("seed_all", &simulator::SimulatorBatch::seed_all, py::arg("base"),
+             "Seed fork i with base + i")
+        .def("step", [](simulator::SimulatorBatch& self, const std::vector<std::vector<int>>& programs,
+                        int num_threads, simulator::MovePolicy cat_policy, simulator::MovePolicy crzbc_policy) {
+            if (programs.size() != self.size()) throw py::value_error("need one program per fork");
+            std::vector<float> scores;
+            {
+                py::gil_scoped_release release;
+                scores = self.step(programs, num_threads, cat_policy, crzbc_policy);
+            }
+            return to_float_array(scores);
+        }, py::arg("programs"), py::arg("num_threads") = 0,
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "execute_program(programs[i]) on fork i (finished games are skipped, score 0)")
+        .def("step", [](simulator::SimulatorBatch& self, const simulator::ProgramRegistry& registry,
+                        py::array_t<int32_t, py::array::c_style | py::array::forcecast> handles,
+                        int num_threads, simulator::MovePolicy cat_policy, simulator::MovePolicy crzbc_policy) {
+            std::vector<const simulator::CompiledProgram*> compiled = resolve_handles(registry, handles);
+            if (compiled.size() != self.size()) throw py::value_error("need one handle per fork");
+            std::vector<float> scores;
+            {
+                py::gil_scoped_release release;
+                scores = self.step(compiled, num_threads, cat_policy, crzbc_policy);
+            }
+            return to_float_array(scores);
+        }, py::arg("registry"), py::arg("handles"), py::arg("num_threads") = 0,
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "step with interned programs (one handle per fork)")
+        .def("simulate", [](simulator::SimulatorBatch& self, const std::vector<std::vector<int>>& programs,
+                            int num_threads, simulator::MovePolicy cat_policy, simulator::MovePolicy crzbc_policy) {
+            if (programs.size() != self.size()) throw py::value_error("need one program per fork");
+            std::vector<float> scores;
+            {
+                py::gil_scoped_release release;
+                scores = self.simulate(programs, num_threads, cat_policy, crzbc_policy);
+            }
+            return to_float_array(scores);
+        }, py::arg("programs"), py::arg("num_threads") = 0,
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "simulate_program(programs[i]) on fork i (states unchanged)")
+        .def("simulate", [](simulator::SimulatorBatch& self, const simulator::ProgramRegistry& registry,
+                            py::array_t<int32_t, py::array::c_style | py::array::forcecast> handles,
+                            int num_threads, simulator::MovePolicy cat_policy, simulator::MovePolicy crzbc_policy) {
+            std::vector<const simulator::CompiledProgram*> compiled = resolve_handles(registry, handles);
+            if (compiled.size() != self.size()) throw py::value_error("need one handle per fork");
+            std::vector<float> scores;
+            {
+                py::gil_scoped_release release;
+                scores = self.simulate(compiled, num_threads, cat_policy, crzbc_policy);
+            }
+            return to_float_array(scores);
+        }, py::arg("registry"), py::arg("handles"), py::arg("num_threads") = 0,
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "simulate with interned programs (one handle per fork)")
+        .def("evaluate", [](simulator::SimulatorBatch& self, const simulator::ProgramRegistry& registry,
+                            py::array_t<int32_t, py::array::c_style | py::array::forcecast> handles,
+                            int num_threads, simulator::MovePolicy cat_policy, simulator::MovePolicy crzbc_policy) {
+            std::vector<const simulator::CompiledProgram*> compiled = resolve_handles(registry, handles);
+            py::array_t<float> out({static_cast<py::ssize_t>(self.size()), static_cast<py::ssize_t>(compiled.size())});
+            {
+                py::gil_scoped_release release;
+                std::vector<float> results = self.evaluate(compiled, num_threads, cat_policy, crzbc_policy);
+                if (!results.empty()) std::memcpy(out.mutable_data(), results.data(), results.size() * sizeof(float));
+            }
+            return out;
+        }, py::arg("registry"), py::arg("handles"), py::arg("num_threads") = 0,
+           py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+           py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+           "Score matrix (n_forks, n_handles): every interned program from every fork's state")
+        .def("states", [](const simulator::SimulatorBatch& self) {
+            py::list out;
+            for (size_t i = 0; i < self.size(); i++) out.append(state_to_dict(self.at(i).get_state()));
+            return out;
+        }, "State dict of every fork")
+        .def("done", [](const simulator::SimulatorBatch& self) {
+            std::vector<bool> done(self.size());
+            for (size_t i = 0; i < self.size(); i++) done[i] = self.at(i).is_win() || self.at(i).is_lose();
+            return done;
+        }, "Per-fork flag: game already won or lost");
+
+    // 맵 대칭 (정규화 / 데이터 증강)
+    py::enum_<simulator::Symmetry>(m, "Symmetry")
+        .value("IDENTITY", simulator::Symmetry::IDENTITY)
+        .value("MIRROR_LR", simulator::Symmetry::MIRROR_LR)
+        .value("MIRROR_UD", simulator::Symmetry::MIRROR_UD)
+        .value("ROT180", simulator::Symmetry::ROT180)
+        .value("TRANSPOSE", simulator::Symmetry::TRANSPOSE)
+        .value("ANTI_TRANSPOSE", simulator::Symmetry::ANTI_TRANSPOSE)
+        .value("ROT90", simulator::Symmetry::ROT90)
+        .value("ROT270", simulator::Symmetry::ROT270);
+
+    py::enum_<simulator::VectorLayout>(m, "VectorLayout")
+        .value("STATE_VEC", simulator::VectorLayout::STATE_VEC)
+        .value("FEATURE_VEC", simulator::VectorLayout::FEATURE_VEC);
+
+    py::class_<simulator::MapSymmetry>(m, "MapSymmetry")
+        .def(py::init([](py::object state_dict) {
+            simulator::GameState map_state;
+            if (state_dict.is_none()) {
+                map_state.init_level3();
+            } else {
+                map_state = dict_to_state(state_dict.cast<py::dict>());
+            }
+            return simulator::MapSymmetry(map_state, simulator::FunctionLibrary());
+        }), py::arg("state_dict") = py::none(),
+           "Detect map symmetries (default: level 3 map) and build function mirror tables")
+
+        .def_property_readonly("mask", &simulator::MapSymmetry::mask)
+        .def("symmetries", &simulator::MapSymmetry::symmetries,
+             "Symmetries preserving wall / junc / deadend (IDENTITY included)")
+        .def("has", &simulator::MapSymmetry::has, py::arg("sym"))
+        .def("transform_function", &simulator::MapSymmetry::transform_function,
+             py::arg("func_id"), py::arg("sym"),
+             "Library function ID whose body is the symmetric image (-1 if none)")
+        .def("mappable_functions", &simulator::MapSymmetry::mappable_functions, py::arg("sym"))
+
+        .def("transform_program", [](const simulator::MapSymmetry& self,
+                                     const std::vector<int>& program,
+                                     simulator::Symmetry sym) -> py::object {
+            std::vector<int> out;
+            if (!self.transform_program(program, sym, out)) return py::none();
+            return py::cast(out);
+        }, py::arg("program"), py::arg("sym"),
+           "Transformed program tokens, or None if a function has no symmetric image")
+
+        .def("transform_state", [](const simulator::MapSymmetry&, py::dict state_dict,
+                                   simulator::Symmetry sym) {
+            return state_to_dict(simulator::transform_state(dict_to_state(state_dict), sym));
+        }, py::arg("state_dict"), py::arg("sym"))
+
+        .def("canonicalize", [](const simulator::MapSymmetry& self, py::dict state_dict,
+                                const std::vector<int>& program) {
+            auto c = self.canonicalize(dict_to_state(state_dict), program);
+            return py::make_tuple(state_to_dict(c.state), c.program, c.sym, c.hash);
+        }, py::arg("state_dict"), py::arg("program"),
+           "Canonical representative -> (state_dict, program, sym, hash)")
+
+        .def("augment", [](const simulator::MapSymmetry& self,
+                           py::array_t<float, py::array::c_style | py::array::forcecast> state_vecs,
+                           const std::vector<std::vector<std::vector<int>>>& programs,
+                           simulator::Symmetry sym, simulator::VectorLayout layout) {
+            if (layout != simulator::VectorLayout::STATE_VEC) {
+                throw py::value_error("augment only supports StateVec layout (feature vectors have direction-dependent fields)");
+            }
+            if (state_vecs.ndim() != 2 || state_vecs.shape(1) != simulator::StateVec::DIM) {
+                throw py::value_error("state_vecs must have shape (N, 828)");
+            }
+            size_t n = static_cast<size_t>(state_vecs.shape(0));
+            if (programs.size() != n) {
+                throw py::value_error("programs must have one entry per state vector");
+            }
+
+            py::array_t<float> out_vecs({static_cast<py::ssize_t>(n),
+                                         static_cast<py::ssize_t>(simulator::StateVec::DIM)});
+            const float* src = state_vecs.data();
+            float* dst = out_vecs.mutable_data();
+            std::vector<std::vector<std::vector<int>>> mapped(n);
+            std::vector<std::vector<uint8_t>> ok(n);
+            {
+                py::gil_scoped_release release;
+                simulator::MapSymmetry::transform_state_vectors(src, dst, n, sym, layout);
+                for (size_t i = 0; i < n; i++) {
+                    mapped[i].resize(programs[i].size());
+                    ok[i].resize(programs[i].size());
+                    for (size_t k = 0; k < programs[i].size(); k++) {
+                        ok[i][k] = self.transform_program(programs[i][k], sym, mapped[i][k]);
+                    }
+                }
+            }
+
+            // 변환 불가 프로그램은 None
+            py::list out_programs;
+            for (size_t i = 0; i < n; i++) {
+                py::list progs;
+                for (size_t k = 0; k < mapped[i].size(); k++) {
+                    if (ok[i][k]) progs.append(py::cast(mapped[i][k]));
+                    else progs.append(py::none());
+                }
+                out_programs.append(progs);
+            }
+            return py::make_tuple(out_vecs, out_programs);
+        }, py::arg("state_vecs"), py::arg("programs"),
+           py::arg("sym") = simulator::Symmetry::MIRROR_LR,
+           py::arg("layout") = simulator::VectorLayout::STATE_VEC,
+           "Transform (N, 828) StateVec rows and per-sample programs -> (vecs, programs)");
+
+    // 상태별 함수 라이브러리 순위 인덱스 (함수 토큰 후보 축소)
+    py::class_<simulator::FunctionIndex>(m, "FunctionIndex")
+        .def(py::init<>(), "Rank library functions by cheese / wall hits from the mouse cell")
+        .def("set_state", [](simulator::FunctionIndex& self, py::dict state_dict) {
+            self.set_state(dict_to_state(state_dict));
+        }, py::arg("state_dict"), "Re-rank for a state (path cache is reused while the map is unchanged)")
+        .def("eat_cheese", [](simulator::FunctionIndex& self, int x, int y) {
+            self.eat_cheese(simulator::Position(x, y));
+        }, py::arg("x"), py::arg("y"), "Remove one cheese cell and update affected functions")
+        .def("top_ids", &simulator::FunctionIndex::top_ids,
+             py::arg("n") = 32, py::arg("distinct") = true,
+             "Top-n function IDs (distinct: skip functions whose body duplicates a smaller ID)")
+        .def("top", [](simulator::FunctionIndex& self, int n, bool distinct) {
+            py::list result;
+            for (const auto& e : self.top(n, distinct)) {
+                result.append(py::make_tuple(e.func_id, e.cheese, e.wall_hits, e.moves,
+                                             py::make_tuple(e.end.x, e.end.y)));
+            }
+            return result;
+        }, py::arg("n") = 32, py::arg("distinct") = true,
+           "Top-n entries: (func_id, cheese, wall_hits, moves, (end_x, end_y))")
+        .def("__len__", &simulator::FunctionIndex::size);
+
+    // 데이터셋 n-gram 채굴 (새 매크로 함수 후보)
+    py::class_<simulator::NgramMiner>(m, "NgramMiner")
+        .def(py::init<int>(), py::arg("max_units") = simulator::ProgramUnit::MAX_UNITS,
+             "Count token / expanded n-grams (up to max_units grammar units) over program batches")
+        .def("add_programs", [](simulator::NgramMiner& self,
+                                py::array_t<int, py::array::c_style | py::array::forcecast> tokens,
+                                py::array_t<int64_t, py::array::c_style | py::array::forcecast> offsets,
+                                int num_threads) {
+            if (tokens.ndim() != 1 || offsets.ndim() != 1 || offsets.shape(0) < 1) {
+                throw py::value_error("tokens and offsets must be 1-D (offsets: n_programs + 1)");
+            }
+            size_t n_programs = static_cast<size_t>(offsets.shape(0) - 1);
+            const int64_t* off = offsets.data();
+            for (size_t i = 0; i < n_programs; i++) {
+                if (off[i] < 0 || off[i] > off[i + 1] || off[i + 1] > tokens.shape(0)) {
+                    throw py::value_error("offsets must be non-decreasing and within tokens");
+                }
+            }
+            py::gil_scoped_release release;
+            self.add_programs(tokens.data(), off, n_programs, num_threads);
+        }, py::arg("tokens"), py::arg("offsets"), py::arg("num_threads") = 0,
+           "Add a CSR batch of programs: programs[i] = tokens[offsets[i]:offsets[i+1]]")
+        .def("candidates", [](const simulator::NgramMiner& self, size_t top_n, uint32_t min_programs) {
+            py::list result;
+            for (const auto& c : self.candidates(top_n, min_programs)) {
+                py::dict d;
+                d["body"] = c.body;
+                d["gain"] = c.gain;
+                d["token_count"] = c.token_count;
+                d["programs"] = c.programs;
+                d["expanded_count"] = c.expanded_count;
+                result.append(d);
+            }
+            return result;
+        }, py::arg("top_n") = 64, py::arg("min_programs") = 2,
+           "Candidate functions ranked by compression gain (tokens saved)")
+        .def("emit_flat", [](const simulator::NgramMiner& self, size_t top_n, uint32_t min_programs) {
+            return self.emit_flat(self.candidates(top_n, min_programs));
+        }, py::arg("top_n") = 64, py::arg("min_programs") = 2,
+           "Top candidates as a flat library [id, len, tokens...] using redundant library IDs")
+        .def_property_readonly("num_programs", &simulator::NgramMiner::num_programs)
+        .def_property_readonly("num_ngrams", &simulator::NgramMiner::num_ngrams);
+
+    // 생성 작업 체크포인트 (백그라운드 원자적 쓰기)
+    py::class_<simulator::CheckpointStore>(m, "CheckpointStore")
+        .def(py::init<std::string, double>(), py::arg("path"), py::arg("interval_sec") = 5.0,
+             "Checkpoint written atomically to path every interval_sec when changed (<= 0: flush() only)")
+        .def("set_counter", &simulator::CheckpointStore::set_counter, py::arg("name"), py::arg("value"))
+        .def("set_shard", &simulator::CheckpointStore::set_shard, py::arg("name"), py::arg("offset"),
+             "Valid byte length of an output file")
+        .def("set_slot", [](simulator::CheckpointStore& self, int slot, int64_t game_id, int run,
+                            py::dict state_dict, py::bytes rng, py::bytes payload, bool finished) {
+            simulator::CheckpointStore::GameSlot game;
+            game.game_id = game_id;
+            game.run = run;
+            game.finished = finished;
+            game.state = dict_to_state(state_dict);
+            game.rng = rng.cast<std::string>();
+            game.payload = payload.cast<std::string>();
+            self.set_slot(slot, game);
+        }, py::arg("slot"), py::arg("game_id"), py::arg("run"), py::arg("state"),
+           py::arg("rng") = py::bytes(), py::arg("payload") = py::bytes(), py::arg("finished") = false,
+           "Record an in-flight game (rng / payload: caller-serialized bytes)")
+        .def("get_slot", [](const simulator::CheckpointStore& self, int slot) -> py::object {
+            simulator::CheckpointStore::GameSlot game;
+            if (!self.get_slot(slot, game)) return py::none();
+            py::dict d;
+            d["game_id"] = game.game_id;
+            d["run"] = game.run;
+            d["finished"] = game.finished;
+            d["state"] = state_to_dict(game.state);
+            d["rng"] = py::bytes(game.rng);
+            d["payload"] = py::bytes(game.payload);
+            return std::move(d);
+        }, py::arg("slot"), "In-flight game dict, or None")
+        .def("clear_slot", &simulator::CheckpointStore::clear_slot, py::arg("slot"))
+        .def("clear", &simulator::CheckpointStore::clear)
+        .def_property_readonly("counters", &simulator::CheckpointStore::counters)
+        .def_property_readonly("shards", &simulator::CheckpointStore::shards)
+        .def_property_readonly("slots", &simulator::CheckpointStore::slot_ids)
+        .def("flush", &simulator::CheckpointStore::flush, py::call_guard<py::gil_scoped_release>(),
+             "Write pending changes now (atomic rename)")
+        .def("load", &simulator::CheckpointStore::load, py::call_guard<py::gil_scoped_release>(),
+             "Replace contents from the file (False if missing or corrupt)")
+        .def("close", &simulator::CheckpointStore::close, py::call_guard<py::gil_scoped_release>(),
+             "Stop the writer thread and flush")
+        .def_property_readonly("path", &simulator::CheckpointStore::path)
+        .def_property_readonly("writes", &simulator::CheckpointStore::writes);
+
+    // 생성 샘플 중복 제거 (상태 벡터 키, 스트라이프 잠금 해시 집합)
+    py::class_<simulator::SampleDeduper>(m, "SampleDeduper")
+        .def(py::init([](int top_k, int score_bucket, int step_bucket, bool entities, int num_stripes) {
+            simulator::DedupeConfig config;
+            config.top_k = top_k;
+            config.score_bucket = score_bucket;
+            config.step_bucket = step_bucket;
+            config.entities = entities;
+            return new simulator::SampleDeduper(config, num_stripes);
+        }), py::arg("top_k") = 1, py::arg("score_bucket") = 1, py::arg("step_bucket") = 1,
+            py::arg("entities") = true, py::arg("num_stripes") = 64,
+            "Merge samples with equal state keys (buckets: 0 = ignore, 1 = exact, k = k-wide bins)")
+        .def("add", [](simulator::SampleDeduper& self,
+                       py::array_t<float, py::array::c_style | py::array::forcecast> state_vecs,
+                       const std::vector<std::vector<std::vector<int>>>& programs,
+                       const std::vector<std::vector<float>>& scores,
+                       int num_threads) {
+            if (state_vecs.ndim() != 2 || state_vecs.shape(1) != simulator::StateVec::DIM) {
+                throw py::value_error("state_vecs must have shape (N, 828)");
+            }
+            size_t n = static_cast<size_t>(state_vecs.shape(0));
+            if (programs.size() != n || scores.size() != n) {
+                throw py::value_error("programs and scores must have one entry per state vector");
+            }
+            py::gil_scoped_release release;
+            return self.add(state_vecs.data(), n, programs, scores, num_threads);
+        }, py::arg("state_vecs"), py::arg("programs"), py::arg("scores"), py::arg("num_threads") = 0,
+           "Add samples, returns each sample's group key")
+        .def("groups", [](const simulator::SampleDeduper& self) {
+            py::list result;
+            for (const auto& g : self.groups()) {
+                py::dict d;
+                d["key"] = g.key;
+                d["index"] = g.index;
+                d["count"] = g.count;
+                d["programs"] = g.programs;
+                d["scores"] = g.scores;
+                d["program_counts"] = g.counts;
+                result.append(d);
+            }
+            return result;
+        }, "Merged groups in order of first sample (index = running sample number)")
+        .def_property_readonly("stats", [](const simulator::SampleDeduper& self) {
+            auto s = self.stats();
+            py::dict d;
+            d["samples"] = s.samples;
+            d["unique"] = s.unique;
+            d["duplicates"] = s.duplicates;
+            d["ratio"] = s.ratio;
+            return d;
+        })
+        .def("clear", &simulator::SampleDeduper::clear)
+        .def("__len__", [](const simulator::SampleDeduper& self) { return self.stats().unique; });
+
+    m.def("sample_key", [](py::array_t<float, py::array::c_style | py::array::forcecast> state_vec,
+                           int score_bucket, int step_bucket, bool entities) {
+        if (state_vec.ndim() != 1 || state_vec.shape(0) != simulator::StateVec::DIM) {
+            throw py::value_error("state_vec must have shape (828,)");
+        }
+        simulator::DedupeConfig config;
+        config.score_bucket = score_bucket;
+        config.step_bucket = step_bucket;
+        config.entities = entities;
+        return simulator::sample_key(state_vec.data(), config);
+    }, py::arg("state_vec"), py::arg("score_bucket") = 1, py::arg("step_bucket") = 1,
+       py::arg("entities") = true, "Dedupe key of one state vector");
+
+    // 오프닝 북 (대칭 정규화 상태 → 미리 계산한 top-K 프로그램)
+    auto map_state_or_level3 = [](py::object state_dict) {
+        simulator::GameState map_state;
+        if (state_dict.is_none()) {
+            map_state.init_level3();
+        } else {
+            map_state = dict_to_state(state_dict.cast<py::dict>());
+        }
+        return map_state;
+    };
+
+    py::class_<simulator::OpeningBookWriter>(m, "OpeningBookWriter")
+        .def(py::init([map_state_or_level3](py::object state_dict, int max_moves) {
+            return new simulator::OpeningBookWriter(map_state_or_level3(state_dict),
+                                                    simulator::FunctionLibrary(), max_moves);
+        }), py::arg("state_dict") = py::none(), py::arg("max_moves") = 8,
+            "Collect book entries (default map: level 3), keep max_moves best programs per state")
+        .def("add", [](simulator::OpeningBookWriter& self, py::dict state_dict,
+                       const std::vector<std::vector<int>>& programs,
+                       const std::vector<float>& means, const std::vector<float>& stds,
+                       const std::vector<uint32_t>& sims, uint32_t visits) {
+            if (means.size() != programs.size() || stds.size() != programs.size() ||
+                sims.size() != programs.size()) {
+                throw py::value_error("means, stds and sims must have one entry per program");
+            }
+            std::vector<simulator::BookMove> moves(programs.size());
+            for (size_t i = 0; i < programs.size(); i++) {
+                moves[i].program = programs[i];
+                moves[i].mean = means[i];
+                moves[i].stddev = stds[i];
+                moves[i].sims = sims[i];
+            }
+            return self.add(dict_to_state(state_dict), moves, visits);
+        }, py::arg("state"), py::arg("programs"), py::arg("means"), py::arg("stds"), py::arg("sims"),
+           py::arg("visits") = 1, "Add (or merge) a state's programs and score statistics")
+        .def("save", &simulator::OpeningBookWriter::save, py::arg("path"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("__len__", &simulator::OpeningBookWriter::size);
+
+    py::class_<simulator::OpeningBook>(m, "OpeningBook")
+        .def(py::init([map_state_or_level3](py::object state_dict) {
+            return new simulator::OpeningBook(map_state_or_level3(state_dict), simulator::FunctionLibrary());
+        }), py::arg("state_dict") = py::none())
+        .def("open", &simulator::OpeningBook::open, py::arg("path"),
+             "Memory-map a book file (False if missing or malformed)")
+        .def("close", &simulator::OpeningBook::close)
+        .def_property_readonly("is_open", &simulator::OpeningBook::is_open)
+        .def("lookup", [](const simulator::OpeningBook& self, py::dict state_dict) -> py::object {
+            simulator::GameState state = dict_to_state(state_dict);
+            std::vector<simulator::BookMove> moves;
+            uint32_t visits = 0;
+            bool found;
+            {
+                py::gil_scoped_release release;
+                found = self.lookup(state, moves, visits);
+            }
+            if (!found) return py::none();
+            std::vector<std::vector<int>> programs;
+            std::vector<float> means, stds;
+            std::vector<uint32_t> sims;
+            for (const auto& mv : moves) {
+                programs.push_back(mv.program);
+                means.push_back(mv.mean);
+                stds.push_back(mv.stddev);
+                sims.push_back(mv.sims);
+            }
+            py::dict d;
+            d["visits"] = visits;
+            d["programs"] = programs;
+            d["means"] = means;
+            d["stds"] = stds;
+            d["sims"] = sims;
+            return std::move(d);
+        }, py::arg("state"), "Best programs for this state (best first), or None")
+        .def("key", [](const simulator::OpeningBook& self, py::dict state_dict) {
+            return self.key(dict_to_state(state_dict));
+        }, py::arg("state"), "Symmetry-canonical state key")
+        .def("__len__", &simulator::OpeningBook::size);
+
+    m.def("state_hash", [](py::dict state_dict) {
+        return simulator::state_hash(dict_to_state(state_dict));
+    }, py::arg("state_dict"), "64-bit hash of the full game state");
+
     // 배치 시뮬레이션 함수
     // 주의: dict_to_state는 GIL 보유 상태에서 실행, batch_simulate만 GIL 해제
     m.def("batch_simulate", [](const std::vector<std::vector<int>>& programs,
                                 py::dict initial_state_dict,
-                                int num_threads) {
+                                int num_threads,
+                                simulator::MovePolicy cat_policy,
+                                simulator::MovePolicy crzbc_policy,
+                                const std::vector<int>& functions,
+                                const simulator::RuleSet& rules) {
         // GIL 보유 상태에서 Python dict → C++ 변환
         simulator::GameState initial_state = dict_to_state(initial_state_dict);
+        if (!functions.empty() && !simulator::FunctionLibrary().load_flat(functions)) {
+            throw py::value_error("functions must be a flat library [id, len, tokens...]");
+        }
 
         // GIL 해제 후 병렬 시뮬레이션
         std::vector<float> results;
         {
             py::gil_scoped_release release;
-            results = simulator::batch_simulate(programs, initial_state, num_threads);
+            results = simulator::batch_simulate(programs, initial_state, num_threads,
+                                                cat_policy, crzbc_policy, functions, rules);
         }
         return results;
     }, py::arg("programs"),
        py::arg("initial_state"),
        py::arg("num_threads") = 0,
-       "Batch simulate multiple programs in parallel");
+       py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("functions") = std::vector<int>(),
+       py::arg("rules") = simulator::RuleSet(),
+       "Batch simulate multiple programs in parallel (functions: flat library overrides)");
+    m.def("batch_simulate", [](const simulator::ProgramRegistry& registry,
+                                py::array_t<int32_t, py::array::c_style | py::array::forcecast> handles,
+                                py::dict initial_state_dict,
+                                int num_threads,
+                                simulator::MovePolicy cat_policy,
+                                simulator::MovePolicy crzbc_policy,
+                                const simulator::RuleSet& rules) {
+        std::vector<simulator::GameState> states{dict_to_state(initial_state_dict)};
+        std::vector<const simulator::CompiledProgram*> compiled = resolve_handles(registry, handles);
+        py::array_t<float> out(static_cast<py::ssize_t>(compiled.size()));
+        {
+            py::gil_scoped_release release;
+            std::vector<float> results = simulator::evaluate_compiled(states, compiled, num_threads,
+                                                                      cat_policy, crzbc_policy, rules);
+            if (!results.empty()) std::memcpy(out.mutable_data(), results.data(), results.size() * sizeof(float));
+        }
+        return out;
+    }, py::arg("registry"),
+       py::arg("handles"),
+       py::arg("initial_state"),
+       py::arg("num_threads") = 0,
+       py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("rules") = simulator::RuleSet(),
+       "Batch simulate interned programs (int32 handles) -> float32 scores");
+
+    // 상태 레코드 (고정 길이 바이너리, evaluate_matrix 입력)
+    m.def("encode_states", [](const std::vector<py::dict>& state_dicts) {
+        std::vector<simulator::GameState> states;
+        states.reserve(state_dicts.size());
+        for (const py::dict& d : state_dicts) states.push_back(dict_to_state(d));
+        std::vector<uint8_t> blob = simulator::StateCodec::encode_all(states);
+        return py::bytes(reinterpret_cast<const char*>(blob.data()), blob.size());
+    }, py::arg("states"), "Pack state dicts into STATE_RECORD_SIZE-byte records");
+
+    m.def("decode_state", [](py::bytes blob, size_t index) {
+        std::string raw = blob;
+        if ((index + 1) * simulator::StateCodec::RECORD_SIZE > raw.size()) {
+            throw py::value_error("state index out of range");
+        }
+        simulator::GameState state;
+        if (!simulator::StateCodec::decode(
+                reinterpret_cast<const uint8_t*>(raw.data()) + index * simulator::StateCodec::RECORD_SIZE, state)) {
+            throw py::value_error("invalid state record (entity count or position out of range)");
+        }
+        return state_to_dict(state);
+    }, py::arg("blob"), py::arg("index") = 0, "Unpack one state record to a dict");
+
+    // 임의 유효 중반 상태 생성 (상태 레코드로 바로 출력)
+    py::class_<simulator::StateGenConfig>(m, "StateGenConfig")
+        .def(py::init<>())
+        .def_readwrite("seed", &simulator::StateGenConfig::seed)
+        .def_readwrite("num_threads", &simulator::StateGenConfig::num_threads)
+        .def_readwrite("cheese_min", &simulator::StateGenConfig::cheese_min)
+        .def_readwrite("cheese_max", &simulator::StateGenConfig::cheese_max)
+        .def_readwrite("mouse_at_start", &simulator::StateGenConfig::mouse_at_start)
+        .def_readwrite("num_cats", &simulator::StateGenConfig::num_cats)
+        .def_readwrite("min_cat_distance", &simulator::StateGenConfig::min_cat_distance)
+        .def_readwrite("movbc_alive", &simulator::StateGenConfig::movbc_alive)
+        .def_readwrite("crzbc_alive", &simulator::StateGenConfig::crzbc_alive)
+        .def_readwrite("life_min", &simulator::StateGenConfig::life_min)
+        .def_readwrite("life_max", &simulator::StateGenConfig::life_max)
+        .def_readwrite("run_min", &simulator::StateGenConfig::run_min)
+        .def_readwrite("run_max", &simulator::StateGenConfig::run_max)
+        .def_readwrite("step_min", &simulator::StateGenConfig::step_min)
+        .def_readwrite("step_max", &simulator::StateGenConfig::step_max)
+        .def_readwrite("consistent_score", &simulator::StateGenConfig::consistent_score);
+
+    py::class_<simulator::StateGenerator>(m, "StateGenerator")
+        .def(py::init([](const simulator::StateGenConfig& config, py::object state_dict) {
+            if (config.cheese_min < 0.0f || config.cheese_max > 1.0f || config.cheese_min > config.cheese_max) {
+                throw py::value_error("need 0 <= cheese_min <= cheese_max <= 1");
+            }
+            if (config.num_cats < 0 || config.num_cats > simulator::Config::MAX_CATS) {
+                throw py::value_error("num_cats must be in [0, 6]");
+            }
+            if (config.life_min < 1 || config.life_min > config.life_max ||
+                config.run_min < 0 || config.run_min > config.run_max ||
+                config.run_max >= simulator::Config::MAX_RUNS ||
+                config.step_min < 0 || config.step_min > config.step_max) {
+                throw py::value_error("life / run / step ranges must satisfy 1 <= life_min <= life_max, "
+                                      "0 <= run_min <= run_max < 20, 0 <= step_min <= step_max");
+            }
+            simulator::StateGenerator gen = state_dict.is_none() ?
+                simulator::StateGenerator(config) :
+                simulator::StateGenerator(config, dict_to_state(state_dict.cast<py::dict>()));
+            if (!gen.valid()) {
+                throw py::value_error("base map needs at least 2 open cheese candidate cells");
+            }
+            return gen;
+        }), py::arg("config") = simulator::StateGenConfig(), py::arg("state_dict") = py::none(),
+           "Seeded random mid-game states on a base map (default: level 3 walls and cheese cells)")
+        .def_property_readonly("config", &simulator::StateGenerator::config)
+        .def("generate", [](const simulator::StateGenerator& self, size_t n, uint64_t first) {
+            std::vector<uint8_t> blob;
+            {
+                py::gil_scoped_release release;
+                blob = self.generate(first, n);
+            }
+            return py::bytes(reinterpret_cast<const char*>(blob.data()), blob.size());
+        }, py::arg("n"), py::arg("first") = 0,
+           "States first .. first + n - 1 as STATE_RECORD_SIZE-byte records (evaluate_matrix / decode_state)")
+        .def("generate_one", [](const simulator::StateGenerator& self, uint64_t index) {
+            simulator::GameState state;
+            self.generate_one(index, state);
+            return state_to_dict(state);
+        }, py::arg("index"), "State index as a dict");
+
+    // 상태 x 프로그램 점수 행렬
+    m.def("evaluate_matrix", [](py::bytes states_blob,
+                                 const std::vector<std::vector<int>>& programs,
+                                 int num_threads,
+                                 simulator::MovePolicy cat_policy,
+                                 simulator::MovePolicy crzbc_policy,
+                                 const std::vector<int>& functions,
+                                 const simulator::RuleSet& rules) {
+        std::string raw = states_blob;
+        if (raw.size() % simulator::StateCodec::RECORD_SIZE != 0) {
+            throw py::value_error("states blob size must be a multiple of STATE_RECORD_SIZE");
+        }
+        if (!functions.empty() && !simulator::FunctionLibrary().load_flat(functions)) {
+            throw py::value_error("functions must be a flat library [id, len, tokens...]");
+        }
+        const size_t n_states = raw.size() / simulator::StateCodec::RECORD_SIZE;
+
+        std::vector<simulator::GameState> states;
+        if (!simulator::StateCodec::decode_all(reinterpret_cast<const uint8_t*>(raw.data()), n_states, states)) {
+            throw py::value_error("invalid state record (entity count or position out of range)");
+        }
+
+        std::vector<float> results;
+        {
+            py::gil_scoped_release release;
+            results = simulator::evaluate_matrix(states, programs, num_threads,
+                                                 cat_policy, crzbc_policy, functions, rules);
+        }
+
+        py::array_t<float> out({static_cast<py::ssize_t>(n_states), static_cast<py::ssize_t>(programs.size())});
+        if (!results.empty()) {
+            std::memcpy(out.mutable_data(), results.data(), results.size() * sizeof(float));
+        }
+        return out;
+    }, py::arg("states_blob"),
+       py::arg("programs"),
+       py::arg("num_threads") = 0,
+       py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("functions") = std::vector<int>(),
+       py::arg("rules") = simulator::RuleSet(),
+       "Score matrix (n_states, n_programs) from encode_states records");
+    m.def("evaluate_matrix", [](py::bytes states_blob,
+                                 const simulator::ProgramRegistry& registry,
+                                 py::array_t<int32_t, py::array::c_style | py::array::forcecast> handles,
+                                 int num_threads,
+                                 simulator::MovePolicy cat_policy,
+                                 simulator::MovePolicy crzbc_policy,
+                                 const simulator::RuleSet& rules) {
+        std::string raw = states_blob;
+        if (raw.size() % simulator::StateCodec::RECORD_SIZE != 0) {
+            throw py::value_error("states blob size must be a multiple of STATE_RECORD_SIZE");
+        }
+        const size_t n_states = raw.size() / simulator::StateCodec::RECORD_SIZE;
+        std::vector<const simulator::CompiledProgram*> compiled = resolve_handles(registry, handles);
+
+        std::vector<simulator::GameState> states;
+        if (!simulator::StateCodec::decode_all(reinterpret_cast<const uint8_t*>(raw.data()), n_states, states)) {
+            throw py::value_error("invalid state record (entity count or position out of range)");
+        }
+
+        py::array_t<float> out({static_cast<py::ssize_t>(n_states), static_cast<py::ssize_t>(compiled.size())});
+        {
+            py::gil_scoped_release release;
+            std::vector<float> results = simulator::evaluate_compiled(states, compiled, num_threads,
+                                                                      cat_policy, crzbc_policy, rules);
+            if (!results.empty()) std::memcpy(out.mutable_data(), results.data(), results.size() * sizeof(float));
+        }
+        return out;
+    }, py::arg("states_blob"),
+       py::arg("registry"),
+       py::arg("handles"),
+       py::arg("num_threads") = 0,
+       py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("rules") = simulator::RuleSet(),
+       "Score matrix (n_states, n_handles) for interned programs");
+
+    // 문법 유효 임의 프로그램 생성 (평면 / 패딩 배치 형식으로 바로 출력)
+    py::class_<simulator::ProgramGenConfig>(m, "ProgramGenConfig")
+        .def(py::init<>())
+        .def_readwrite("seed", &simulator::ProgramGenConfig::seed)
+        .def_readwrite("num_threads", &simulator::ProgramGenConfig::num_threads)
+        .def_readwrite("min_tokens", &simulator::ProgramGenConfig::min_tokens)
+        .def_readwrite("max_tokens", &simulator::ProgramGenConfig::max_tokens)
+        .def_readwrite("max_func_calls", &simulator::ProgramGenConfig::max_func_calls)
+        .def_readwrite("direction_weight", &simulator::ProgramGenConfig::direction_weight)
+        .def_readwrite("loop_weight", &simulator::ProgramGenConfig::loop_weight)
+        .def_readwrite("if_weight", &simulator::ProgramGenConfig::if_weight)
+        .def_readwrite("function_weight", &simulator::ProgramGenConfig::function_weight)
+        .def_readwrite("end_weight", &simulator::ProgramGenConfig::end_weight)
+        .def_readwrite("direction_weights", &simulator::ProgramGenConfig::direction_weights)
+        .def_readwrite("loop_count_weights", &simulator::ProgramGenConfig::loop_count_weights)
+        .def_readwrite("if_count_weights", &simulator::ProgramGenConfig::if_count_weights)
+        .def_readwrite("functions", &simulator::ProgramGenConfig::functions);
+
+    py::class_<simulator::ProgramGenerator>(m, "ProgramGenerator")
+        .def(py::init([](const simulator::ProgramGenConfig& config) {
+            if (config.max_tokens < 1 || config.min_tokens < 0 || config.min_tokens > config.max_tokens) {
+                throw py::value_error("need 0 <= min_tokens <= max_tokens, max_tokens >= 1");
+            }
+            if (config.direction_weights.size() != 4 || config.loop_count_weights.size() != 10 ||
+                config.if_count_weights.size() != 7) {
+                throw py::value_error("direction / loop_count / if_count weights need 4 / 10 / 7 entries");
+            }
+            auto negative = [](const std::vector<float>& w) {
+                return std::any_of(w.begin(), w.end(), [](float x) { return !(x >= 0.0f); });
+            };
+            if (negative({config.direction_weight, config.loop_weight, config.if_weight,
+                          config.function_weight, config.end_weight}) ||
+                negative(config.direction_weights) || negative(config.loop_count_weights) ||
+                negative(config.if_count_weights)) {
+                throw py::value_error("weights must be non-negative");
+            }
+            if (!config.functions.empty() && !simulator::FunctionLibrary().load_flat(config.functions)) {
+                throw py::value_error("functions must be a flat library [id, len, tokens...]");
+            }
+            return simulator::ProgramGenerator(config);
+        }), py::arg("config") = simulator::ProgramGenConfig(),
+           "Seeded random programs that follow the token grammar")
+        .def_property_readonly("config", &simulator::ProgramGenerator::config)
+        .def("generate", [](const simulator::ProgramGenerator& self, size_t n, uint64_t first) {
+            std::vector<int> tokens;
+            std::vector<int64_t> offsets;
+            {
+                py::gil_scoped_release release;
+                self.generate_flat(first, n, tokens, offsets);
+            }
+            py::array_t<int32_t> tok(static_cast<py::ssize_t>(tokens.size()));
+            std::copy(tokens.begin(), tokens.end(), tok.mutable_data());
+            py::array_t<int64_t> off(static_cast<py::ssize_t>(offsets.size()));
+            std::copy(offsets.begin(), offsets.end(), off.mutable_data());
+            return py::make_tuple(tok, off);
+        }, py::arg("n"), py::arg("first") = 0,
+           "Programs first .. first + n - 1 as (tokens int32, offsets int64) for ProgramRegistry.intern_flat")
+        .def("generate_padded", [](const simulator::ProgramGenerator& self, size_t n, uint64_t first) {
+            py::array_t<int> out({static_cast<py::ssize_t>(n), static_cast<py::ssize_t>(self.row_width())});
+            int* dst = out.mutable_data();
+            py::gil_scoped_release release;
+            self.generate_padded(first, n, dst);
+            return out;
+        }, py::arg("n"), py::arg("first") = 0,
+           "(n, max_tokens + 1) int array, EMPTY after END (ProgramRegistry.intern_array)")
+        .def("generate_lists", [](const simulator::ProgramGenerator& self, size_t n, uint64_t first) {
+            std::vector<std::vector<int>> programs(n);
+            {
+                py::gil_scoped_release release;
+                for (size_t i = 0; i < n; i++) programs[i] = self.generate_one(first + i);
+            }
+            return programs;
+        }, py::arg("n"), py::arg("first") = 0, "Programs as token lists (batch_simulate input)")
+        .def("generate_one", [](const simulator::ProgramGenerator& self, uint64_t index) {
+            return self.generate_one(index);
+        }, py::arg("index"), "Program index as a token list");
+
+    // GRPO 그룹 샘플러 (확률표 → 문법 유효 프로그램 샘플 + 평가)
+    m.def("grpo_sample", [](py::dict state_dict,
+                             py::array_t<float, py::array::c_style | py::array::forcecast> probs,
+                             int group_size,
+                             uint64_t seed,
+                             int max_tokens,
+                             float temperature,
+                             int num_threads,
+                             simulator::MovePolicy cat_policy,
+                             simulator::MovePolicy crzbc_policy,
+                             const std::vector<int>& functions,
+                             const simulator::RuleSet& rules) {
+        int n_slots = 1;
+        if (probs.ndim() == 3) {
+            n_slots = static_cast<int>(probs.shape(1));
+            if (n_slots != simulator::ProgramGrammar::NUM_SLOTS) {
+                throw py::value_error("3-D probs must be (positions, 5 grammar slots, vocab)");
+            }
+        } else if (probs.ndim() != 2) {
+            throw py::value_error("probs must be (positions, vocab) or (positions, 5, vocab)");
+        }
+        const int n_positions = static_cast<int>(probs.shape(0));
+        const int vocab = static_cast<int>(probs.shape(probs.ndim() - 1));
+        if (n_positions < 1 || vocab < 1) {
+            throw py::value_error("probs must have at least one position and one token");
+        }
+        if (!functions.empty() && !simulator::FunctionLibrary().load_flat(functions)) {
+            throw py::value_error("functions must be a flat library [id, len, tokens...]");
+        }
+
+        simulator::GameState state = dict_to_state(state_dict);
+        simulator::GroupSamplerConfig config;
+        config.group_size = group_size;
+        config.seed = seed;
+        config.max_tokens = max_tokens;
+        config.temperature = temperature;
+        config.num_threads = num_threads;
+        config.cat_policy = cat_policy;
+        config.crzbc_policy = crzbc_policy;
+        config.functions = functions;
+        config.rules = rules;
+
+        simulator::GroupSample sample;
+        {
+            py::gil_scoped_release release;
+            sample = simulator::sample_group(state, probs.data(), n_positions, n_slots, vocab, config);
+        }
+
+        py::dict result;
+        result["programs"] = sample.programs;
+        result["token_log_probs"] = sample.token_log_probs;
+        result["log_probs"] = sample.log_probs;
+        result["scores"] = sample.scores;
+        result["advantages"] = sample.advantages;
+        return result;
+    }, py::arg("state"),
+       py::arg("probs"),
+       py::arg("group_size") = 16,
+       py::arg("seed") = 0,
+       py::arg("max_tokens") = 10,
+       py::arg("temperature") = 1.0f,
+       py::arg("num_threads") = 0,
+       py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("functions") = std::vector<int>(),
+       py::arg("rules") = simulator::RuleSet(),
+       "Sample a group of grammar-valid programs from token probabilities, score them, "
+       "and return log-probs and group-normalized advantages");
+
+    // 정책 토너먼트 (공통 난수 시드로 정책별 게임 반복 → 승률 / 점수 / 신뢰 구간)
+    py::enum_<simulator::SearchKind>(m, "SearchKind")
+        .value("RUNNING_MAX", simulator::SearchKind::RUNNING_MAX)
+        .value("SAMPLED", simulator::SearchKind::SAMPLED);
+
+    py::class_<simulator::SearchPolicy>(m, "SearchPolicy")
+        .def(py::init([](const std::string& name, simulator::SearchKind kind, int budget,
+                         int max_tokens, int evals, float temperature) {
+            simulator::SearchPolicy p;
+            p.name = name;
+            p.kind = kind;
+            p.budget = budget;
+            p.max_tokens = max_tokens;
+            p.evals = evals;
+            p.temperature = temperature;
+            return p;
+        }), py::arg("name") = "",
+            py::arg("kind") = simulator::SearchKind::RUNNING_MAX,
+            py::arg("budget") = 32,
+            py::arg("max_tokens") = 10,
+            py::arg("evals") = 1,
+            py::arg("temperature") = 1.0f)
+        .def_readwrite("name", &simulator::SearchPolicy::name)
+        .def_readwrite("kind", &simulator::SearchPolicy::kind)
+        .def_readwrite("budget", &simulator::SearchPolicy::budget)
+        .def_readwrite("max_tokens", &simulator::SearchPolicy::max_tokens)
+        .def_readwrite("evals", &simulator::SearchPolicy::evals)
+        .def_readwrite("temperature", &simulator::SearchPolicy::temperature)
+        .def("set_probs", [](simulator::SearchPolicy& self,
+                             py::array_t<float, py::array::c_style | py::array::forcecast> probs) {
+            int n_slots = 1;
+            if (probs.ndim() == 3) {
+                n_slots = static_cast<int>(probs.shape(1));
+                if (n_slots != simulator::ProgramGrammar::NUM_SLOTS) {
+                    throw py::value_error("3-D probs must be (positions, 5 grammar slots, vocab)");
+                }
+            } else if (probs.ndim() != 2) {
+                throw py::value_error("probs must be (positions, vocab) or (positions, 5, vocab)");
+            }
+            if (probs.shape(0) < 1 || probs.shape(probs.ndim() - 1) < 1) {
+                throw py::value_error("probs must have at least one position and one token");
+            }
+            self.probs.assign(probs.data(), probs.data() + probs.size());
+            self.n_positions = static_cast<int>(probs.shape(0));
+            self.n_slots = n_slots;
+            self.vocab = static_cast<int>(probs.shape(probs.ndim() - 1));
+        }, py::arg("probs"),
+           "Token probabilities for SAMPLED (same layout as grpo_sample); unset = uniform over "
+           "direction / structure tokens")
+        .def("__repr__", [](const simulator::SearchPolicy& p) {
+            return "<SearchPolicy '" + p.name + "' " +
+                   (p.kind == simulator::SearchKind::SAMPLED ? "SAMPLED" : "RUNNING_MAX") +
+                   " budget=" + std::to_string(p.budget) + ">";
+        });
+
+    m.def("run_tournament", [](const std::vector<simulator::SearchPolicy>& policies,
+                               int games,
+                               int max_runs,
+                               uint64_t seed,
+                               int num_threads,
+                               py::object states,
+                               simulator::MovePolicy cat_policy,
+                               simulator::MovePolicy crzbc_policy,
+                               const std::vector<int>& functions,
+                               const simulator::RuleSet& rules) {
+        if (!functions.empty() && !simulator::FunctionLibrary().load_flat(functions)) {
+            throw py::value_error("functions must be a flat library [id, len, tokens...]");
+        }
+        std::vector<simulator::GameState> starts;
+        if (!states.is_none()) {
+            for (const py::handle& d : states) starts.push_back(dict_to_state(d.cast<py::dict>()));
+        }
+
+        simulator::TournamentConfig config;
+        config.games = games;
+        config.max_runs = max_runs;
+        config.seed = seed;
+        config.num_threads = num_threads;
+        config.cat_policy = cat_policy;
+        config.crzbc_policy = crzbc_policy;
+        config.functions = functions;
+        config.rules = rules;
+
+        std::vector<simulator::PolicyReport> reports;
+        {
+            py::gil_scoped_release release;
+            reports = simulator::run_tournament(starts, policies, config);
+        }
+
+        auto interval = [](const simulator::Interval& v) { return py::make_tuple(v.mean, v.lo, v.hi); };
+        py::list out;
+        for (const auto& r : reports) {
+            py::dict d;
+            d["name"] = r.name;
+            d["games"] = r.games;
+            d["wins"] = r.wins;
+            d["win_rate"] = interval(r.win_rate);
+            d["score"] = interval(r.score);
+            d["score_std"] = r.score_std;
+            d["score_quantiles"] = r.score_quantiles;
+            d["runs_to_win"] = interval(r.runs_to_win);
+            d["sims_per_decision"] = r.sims_per_decision;
+            d["decisions"] = r.decisions;
+            d["score_diff"] = interval(r.score_diff);
+            d["scores"] = r.scores;
+            d["runs"] = r.runs;
+            d["won"] = std::vector<bool>(r.won.begin(), r.won.end());
+            out.append(d);
+        }
+        return out;
+    }, py::arg("policies"),
+       py::arg("games") = 100,
+       py::arg("max_runs") = simulator::Config::MAX_RUNS,
+       py::arg("seed") = 0,
+       py::arg("num_threads") = 0,
+       py::arg("states") = py::none(),
+       py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+       py::arg("functions") = std::vector<int>(),
+       py::arg("rules") = simulator::RuleSet(),
+       "Play `games` games per policy on identical seeds (common random numbers). Each report has "
+       "(mean, lo, hi) 95% intervals for win_rate, score, runs_to_win and score_diff vs the first policy");
+
+    // 생성 통계 누적기 (잠금 없는 카운터, 프로세스별 누적기는 serialize → merge)
+    py::class_<simulator::RunStats>(m, "RunStats")
+        .def(py::init([](int score_min, int score_max, int score_bin,
+                         int delta_min, int delta_max, int delta_bin, int max_runs) {
+            simulator::StatsConfig c;
+            c.score_min = score_min;
+            c.score_max = score_max;
+            c.score_bin = score_bin;
+            c.delta_min = delta_min;
+            c.delta_max = delta_max;
+            c.delta_bin = delta_bin;
+            c.max_runs = max_runs;
+            return new simulator::RunStats(c);
+        }), py::arg("score_min") = -5000,
+            py::arg("score_max") = 10000,
+            py::arg("score_bin") = 250,
+            py::arg("delta_min") = -2000,
+            py::arg("delta_max") = 2000,
+            py::arg("delta_bin") = 50,
+            py::arg("max_runs") = simulator::Config::MAX_RUNS)
+        .def("record_run", &simulator::RunStats::record_run,
+             py::arg("run"), py::arg("score_delta"), py::arg("small_cheese"), py::arg("big_cheese"),
+             py::arg("catches"), py::arg("search_us"), py::arg("won") = false,
+             "Record one run (run index from 0, search time in microseconds)")
+        .def("record_game", &simulator::RunStats::record_game,
+             py::arg("final_score"), py::arg("won"), py::arg("runs"),
+             "Record one finished game")
+        .def("serialize", [](const simulator::RunStats& self) {
+            return py::bytes(self.serialize());
+        }, "Counters as bytes (send from a worker process, merge in the parent)")
+        .def("merge", [](simulator::RunStats& self, const simulator::RunStats& other) {
+            if (!self.merge(other)) throw py::value_error("stats have a different histogram config");
+        }, py::arg("other"), "Add another RunStats with the same config")
+        .def("merge", [](simulator::RunStats& self, py::bytes blob) {
+            if (!self.merge_serialized(blob.cast<std::string>())) {
+                throw py::value_error("stats shard has a different format or histogram config");
+            }
+        }, py::arg("blob"), "Add serialize() bytes from another RunStats with the same config")
+        .def("reset", &simulator::RunStats::reset)
+        .def("snapshot", [](const simulator::RunStats& self) {
+            return snapshot_to_dict(self.snapshot());
+        }, "Copy of all counters: score / per-run histograms, per-run cheese and catch counts, "
+           "search-time percentiles (microseconds)");
+
+    // 관측 인코더 (game_worker.get_state_vector_list와 같은 828차원 벡터)
+    m.def("encode_state_vectors", [](const std::vector<py::dict>& state_dicts) {
+        std::vector<simulator::GameState> states;
+        for (const auto& d : state_dicts) states.push_back(dict_to_state(d));
+        py::array_t<float> out({static_cast<py::ssize_t>(states.size()),
+                                static_cast<py::ssize_t>(simulator::StateVec::DIM)});
+        float* dst = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < states.size(); i++) {
+                simulator::encode_state_vector(states[i], dst + i * simulator::StateVec::DIM);
+            }
+        }
+        return out;
+    }, py::arg("state_dicts"), "State dicts -> (N, 828) float32 state vectors");
+
+    // 보조 특징 벡터 (lightweight_simulator.get_state_vector와 같은 정의)
+    // 거리장 하나를 배치 전체에 재사용 → 같은 게임의 연속 상태는 먹은 치즈만 복구
+    m.def("encode_feature_vectors", [](const std::vector<py::dict>& state_dicts,
+                                       py::array_t<float, py::array::c_style> out) {
+        if (out.ndim() != 2 || out.shape(0) != static_cast<py::ssize_t>(state_dicts.size()) ||
+            out.shape(1) != simulator::FeatureVec::DIM) {
+            throw py::value_error("out must have shape (len(state_dicts), 828)");
+        }
+        std::vector<simulator::GameState> states;
+        for (const auto& d : state_dicts) states.push_back(dict_to_state(d));
+        float* dst = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            simulator::CheeseDistanceField field;
+            for (size_t i = 0; i < states.size(); i++) {
+                simulator::encode_feature_vector(states[i], field, dst + i * simulator::FeatureVec::DIM);
+            }
+        }
+        return out;
+    }, py::arg("state_dicts"), py::arg("out").noconvert(),
+       "Write (N, 828) get_state_vector features into a preallocated C-contiguous float32 buffer");
+    m.def("encode_feature_vectors", [](const std::vector<py::dict>& state_dicts) {
+        std::vector<simulator::GameState> states;
+        for (const auto& d : state_dicts) states.push_back(dict_to_state(d));
+        py::array_t<float> out({static_cast<py::ssize_t>(states.size()),
+                                static_cast<py::ssize_t>(simulator::FeatureVec::DIM)});
+        float* dst = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            simulator::CheeseDistanceField field;
+            for (size_t i = 0; i < states.size(); i++) {
+                simulator::encode_feature_vector(states[i], field, dst + i * simulator::FeatureVec::DIM);
+            }
+        }
+        return out;
+    }, py::arg("state_dicts"),
+       "State dicts -> (N, 828) float32 features, same definitions as "
+       "lightweight_simulator.get_state_vector (cat escape / cheese BFS / cat threat / region cheese)");
+
+    // 단계별 데이터 생성 파이프라인 (탐색 → 인코딩 → 증강 / 중복 제거 → 샤드 기록)
+    py::class_<simulator::GenerationPipeline>(m, "GenerationPipeline")
+        .def(py::init([](const std::string& output_path,
+                         const simulator::SearchPolicy& policy,
+                         int64_t games,
+                         int64_t first_game,
+                         uint64_t seed,
+                         int max_runs,
+                         int top_k,
+                         int search_workers,
+                         int encode_workers,
+                         size_t run_queue,
+                         size_t sample_queue,
+                         size_t write_queue,
+                         bool mirror,
+                         bool dedupe,
+                         int dedupe_score_bucket,
+                         int dedupe_step_bucket,
+                         py::object states,
+                         simulator::MovePolicy cat_policy,
+                         simulator::MovePolicy crzbc_policy,
+                         const std::vector<int>& functions,
+                         const simulator::RuleSet& rules) {
+            if (!functions.empty() && !simulator::FunctionLibrary().load_flat(functions)) {
+                throw py::value_error("functions must be a flat library [id, len, tokens...]");
+            }
+            simulator::PipelineConfig config;
+            config.output_path = output_path;
+            config.policy = policy;
+            config.games = games;
+            config.first_game = first_game;
+            config.seed = seed;
+            config.max_runs = max_runs;
+            config.top_k = top_k;
+            config.search_workers = search_workers;
+            config.encode_workers = encode_workers;
+            config.run_queue = run_queue;
+            config.sample_queue = sample_queue;
+            config.write_queue = write_queue;
+            config.mirror = mirror;
+            config.dedupe = dedupe;
+            config.dedupe_config.top_k = top_k;
+            config.dedupe_config.score_bucket = dedupe_score_bucket;
+            config.dedupe_config.step_bucket = dedupe_step_bucket;
+            if (!states.is_none()) {
+                for (const py::handle& d : states) config.starts.push_back(dict_to_state(d.cast<py::dict>()));
+            }
+            config.cat_policy = cat_policy;
+            config.crzbc_policy = crzbc_policy;
+            config.functions = functions;
+            config.rules = rules;
+            return new simulator::GenerationPipeline(config);
+        }), py::arg("output_path"),
+            py::arg("policy") = simulator::SearchPolicy(),
+            py::arg("games") = 100,
+            py::arg("first_game") = 0,
+            py::arg("seed") = 0,
+            py::arg("max_runs") = simulator::Config::MAX_RUNS,
+            py::arg("top_k") = 1,
+            py::arg("search_workers") = 0,
+            py::arg("encode_workers") = 1,
+            py::arg("run_queue") = 64,
+            py::arg("sample_queue") = 256,
+            py::arg("write_queue") = 1024,
+            py::arg("mirror") = false,
+            py::arg("dedupe") = false,
+            py::arg("dedupe_score_bucket") = 1,
+            py::arg("dedupe_step_bucket") = 1,
+            py::arg("states") = py::none(),
+            py::arg("cat_policy") = simulator::MovePolicy::RANDOM,
+            py::arg("crzbc_policy") = simulator::MovePolicy::RANDOM,
+            py::arg("functions") = std::vector<int>(),
+            py::arg("rules") = simulator::RuleSet(),
+            "Staged generator writing a sample shard to output_path (search_workers 0 = auto)")
+        .def("start", [](simulator::GenerationPipeline& self) {
+            if (!self.start()) {
+                throw py::value_error("cannot open " + self.config().output_path + " (or already started)");
+            }
+        }, "Open the shard file and start all stage threads")
+        .def("wait", &simulator::GenerationPipeline::wait, py::arg("timeout") = -1.0,
+             py::call_guard<py::gil_scoped_release>(),
+             "Block until finished or timeout seconds pass (< 0: no limit); True if finished")
+        .def("cancel", &simulator::GenerationPipeline::cancel,
+             "Stop starting new games / runs; samples already produced are still written")
+        .def("report", [](const simulator::GenerationPipeline& self) {
+            const simulator::PipelineReport r = self.report();
+            py::dict d;
+            py::list stages;
+            for (const auto& st : r.stages) {
+                py::dict sd;
+                sd["name"] = st.name;
+                sd["threads"] = st.threads;
+                sd["items"] = st.items;
+                sd["busy_sec"] = st.busy_us / 1e6;
+                sd["wait_in_sec"] = st.wait_in_us / 1e6;
+                sd["wait_out_sec"] = st.wait_out_us / 1e6;
+                stages.append(sd);
+            }
+            py::list queues;
+            for (const auto& q : r.queues) {
+                py::dict qd;
+                qd["name"] = q.name;
+                qd["capacity"] = q.capacity;
+                qd["depth"] = q.depth;
+                qd["high_water"] = q.high_water;
+                qd["pushed"] = q.pushed;
+                qd["full_waits"] = q.full_waits;
+                queues.append(qd);
+            }
+            d["stages"] = stages;
+            d["queues"] = queues;
+            d["games_done"] = r.games_done;
+            d["samples_written"] = r.samples_written;
+            d["mirrored"] = r.mirrored;
+            d["bytes_written"] = r.bytes_written;
+            d["elapsed_sec"] = r.elapsed_sec;
+            d["finished"] = r.finished;
+            d["error"] = r.error;
+            return d;
+        }, "Per-stage busy / wait times, queue depths and progress (safe while running)")
+        .def("stats", [](const simulator::GenerationPipeline& self) {
+            return snapshot_to_dict(self.stats().snapshot());
+        }, "RunStats snapshot of all runs / games so far")
+        .def_property_readonly("dedupe_stats", [](const simulator::GenerationPipeline& self) {
+            auto s = self.dedupe_stats();
+            py::dict d;
+            d["samples"] = s.samples;
+            d["unique"] = s.unique;
+            d["duplicates"] = s.duplicates;
+            d["ratio"] = s.ratio;
+            return d;
+        });
+
+    m.def("read_sample_shard", [](const std::string& path) {
+        std::vector<simulator::PipelineSample> samples;
+        bool ok;
+        {
+            py::gil_scoped_release release;
+            ok = simulator::read_sample_shard(path, samples);
+        }
+        if (!ok) throw py::value_error("not a sample shard: " + path);
+
+        const size_t n = samples.size();
+        py::array_t<float> vecs({static_cast<py::ssize_t>(n), static_cast<py::ssize_t>(simulator::StateVec::DIM)});
+        float* dst = vecs.mutable_data();
+        std::vector<int64_t> games(n);
+        std::vector<int> runs(n);
+        std::vector<bool> mirrored(n);
+        std::vector<uint32_t> counts(n);
+        py::list programs;
+        py::list scores;
+        for (size_t i = 0; i < n; i++) {
+            const auto& s = samples[i];
+            std::memcpy(dst + i * simulator::StateVec::DIM, s.state_vec.data(),
+                        simulator::StateVec::DIM * sizeof(float));
+            games[i] = s.game;
+            runs[i] = s.run;
+            mirrored[i] = s.mirrored;
+            counts[i] = s.count;
+            programs.append(py::cast(s.programs));
+            scores.append(py::cast(s.scores));
+        }
+        py::dict d;
+        d["state_vecs"] = vecs;
+        d["programs"] = programs;
+        d["scores"] = scores;
+        d["games"] = games;
+        d["runs"] = runs;
+        d["mirrored"] = mirrored;
+        d["counts"] = counts;
+        return d;
+    }, py::arg("path"), "Read a pipeline shard -> dict of (N, 828) state_vecs and per-sample lists");
 
     // 상수 노출
     m.attr("MAP_SIZE") = simulator::MAP_SIZE;
     m.attr("TOKEN_END") = simulator::Token::END;
     m.attr("TOKEN_LOOP") = simulator::Token::LOOP;
     m.attr("TOKEN_IF") = simulator::Token::IF;
+    m.attr("MAX_CATS") = simulator::Config::MAX_CATS;
+    m.attr("MAX_MOVBC") = simulator::Config::MAX_MOVBC;
+    m.attr("MAX_CRZBC") = simulator::Config::MAX_CRZBC;
+    m.attr("MAX_RUNS") = simulator::Config::MAX_RUNS;
+    m.attr("STATE_RECORD_SIZE") = simulator::StateCodec::RECORD_SIZE;
+    m.attr("GRAMMAR_SLOTS") = static_cast<int>(simulator::ProgramGrammar::NUM_SLOTS);
 }
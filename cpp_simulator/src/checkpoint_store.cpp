@@ -0,0 +1,327 @@
+#include "checkpoint_store.hpp"
+#include "state_codec.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace simulator {
+
+namespace {
+
+constexpr char MAGIC[4] = {'M', 'A', 'C', 'K'};
+constexpr uint32_t VERSION = 1;
+
+uint64_t fnv1a(const char* data, size_t n) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < n; i++) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+// 리틀 엔디언 직렬화
+struct Out {
+    std::string buf;
+
+    void u64(uint64_t v) {
+        for (int k = 0; k < 8; k++) buf.push_back(static_cast<char>(v >> (8 * k)));
+    }
+    void u32(uint32_t v) {
+        for (int k = 0; k < 4; k++) buf.push_back(static_cast<char>(v >> (8 * k)));
+    }
+    void bytes(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        buf += s;
+    }
+};
+
+struct In {
+    const std::string& buf;
+    size_t pos = 0;
+    bool ok = true;
+
+    bool need(size_t n) {
+        if (!ok || pos + n > buf.size()) ok = false;
+        return ok;
+    }
+    uint64_t u64() {
+        if (!need(8)) return 0;
+        uint64_t v = 0;
+        for (int k = 0; k < 8; k++) v |= static_cast<uint64_t>(static_cast<uint8_t>(buf[pos + k])) << (8 * k);
+        pos += 8;
+        return v;
+    }
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = 0;
+        for (int k = 0; k < 4; k++) v |= static_cast<uint32_t>(static_cast<uint8_t>(buf[pos + k])) << (8 * k);
+        pos += 4;
+        return v;
+    }
+    std::string bytes() {
+        uint32_t n = u32();
+        if (!need(n)) return std::string();
+        std::string s = buf.substr(pos, n);
+        pos += n;
+        return s;
+    }
+};
+
+bool write_all(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, data, n);
+        if (w < 0) return false;
+        data += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+} // namespace
+
+// ============================================================
+// 생성 / 소멸
+// ============================================================
+CheckpointStore::CheckpointStore(std::string path, double interval_sec)
+    : path_(std::move(path)), interval_sec_(interval_sec) {
+    if (interval_sec_ > 0.0) {
+        writer_ = std::thread([this] { writer_loop(); });
+    }
+}
+
+CheckpointStore::~CheckpointStore() {
+    close();
+}
+
+void CheckpointStore::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (writer_.joinable()) writer_.join();
+    flush();
+}
+
+// ============================================================
+// 갱신 / 조회
+// ============================================================
+void CheckpointStore::set_counter(const std::string& name, int64_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_.counters[name] = value;
+    touch_locked();
+}
+
+void CheckpointStore::set_shard(const std::string& name, uint64_t offset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_.shards[name] = offset;
+    touch_locked();
+}
+
+void CheckpointStore::set_slot(int slot, const GameSlot& game) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_.slots[slot] = game;
+    touch_locked();
+}
+
+void CheckpointStore::clear_slot(int slot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (data_.slots.erase(slot)) touch_locked();
+}
+
+void CheckpointStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_ = Snapshot();
+    touch_locked();
+}
+
+std::map<std::string, int64_t> CheckpointStore::counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return data_.counters;
+}
+
+std::map<std::string, uint64_t> CheckpointStore::shards() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return data_.shards;
+}
+
+bool CheckpointStore::get_slot(int slot, GameSlot& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = data_.slots.find(slot);
+    if (it == data_.slots.end()) return false;
+    out = it->second;
+    return true;
+}
+
+std::vector<int> CheckpointStore::slot_ids() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<int> ids;
+    for (const auto& kv : data_.slots) ids.push_back(kv.first);
+    return ids;
+}
+
+uint64_t CheckpointStore::writes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writes_;
+}
+
+// ============================================================
+// 파일 쓰기 / 읽기
+// ============================================================
+bool CheckpointStore::flush() {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+
+    // 스냅샷 복사만 잠금 안에서, 직렬화 / 디스크 I/O는 밖에서
+    Snapshot snap;
+    uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (version_ == written_version_) return true;
+        snap = data_;
+        version = version_;
+    }
+
+    if (!write_atomic(path_, serialize(snap))) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    written_version_ = version;
+    writes_++;
+    return true;
+}
+
+bool CheckpointStore::load() {
+    FILE* f = std::fopen(path_.c_str(), "rb");
+    if (!f) return false;
+    std::string bytes;
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) bytes.append(chunk, n);
+    std::fclose(f);
+
+    Snapshot snap;
+    if (!deserialize(bytes, snap)) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_ = std::move(snap);
+    version_++;
+    written_version_ = version_;  // 파일과 동일
+    return true;
+}
+
+void CheckpointStore::writer_loop() {
+    const auto interval = std::chrono::duration<double>(interval_sec_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        wake_.wait_for(lock, interval, [this] { return stop_; });
+        if (stop_) break;
+        if (version_ == written_version_) continue;
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+std::string CheckpointStore::serialize(const Snapshot& snap) {
+    Out body;
+    body.u32(static_cast<uint32_t>(snap.counters.size()));
+    for (const auto& kv : snap.counters) {
+        body.bytes(kv.first);
+        body.u64(static_cast<uint64_t>(kv.second));
+    }
+    body.u32(static_cast<uint32_t>(snap.shards.size()));
+    for (const auto& kv : snap.shards) {
+        body.bytes(kv.first);
+        body.u64(kv.second);
+    }
+    body.u32(static_cast<uint32_t>(snap.slots.size()));
+    std::string record(StateCodec::RECORD_SIZE, '\0');
+    for (const auto& kv : snap.slots) {
+        const GameSlot& g = kv.second;
+        body.u32(static_cast<uint32_t>(kv.first));
+        body.u64(static_cast<uint64_t>(g.game_id));
+        body.u32(static_cast<uint32_t>(g.run));
+        body.buf.push_back(g.finished ? 1 : 0);
+        StateCodec::encode(g.state, reinterpret_cast<uint8_t*>(&record[0]));
+        body.buf += record;
+        body.bytes(g.rng);
+        body.bytes(g.payload);
+    }
+
+    Out file;
+    file.buf.append(MAGIC, sizeof(MAGIC));
+    file.u32(VERSION);
+    file.u64(body.buf.size());
+    file.buf += body.buf;
+    file.u64(fnv1a(body.buf.data(), body.buf.size()));
+    return file.buf;
+}
+
+bool CheckpointStore::deserialize(const std::string& bytes, Snapshot& snap) {
+    if (bytes.size() < sizeof(MAGIC) + 4 + 8 + 8) return false;
+    if (std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+
+    In in{bytes, sizeof(MAGIC)};
+    if (in.u32() != VERSION) return false;
+    const uint64_t body_size = in.u64();
+    if (body_size != bytes.size() - in.pos - 8) return false;
+    const size_t body_start = in.pos;
+    const uint64_t checksum = In{bytes, body_start + body_size}.u64();
+    if (checksum != fnv1a(bytes.data() + body_start, body_size)) return false;
+
+    uint32_t n = in.u32();
+    for (uint32_t i = 0; i < n && in.ok; i++) {
+        std::string name = in.bytes();
+        snap.counters[name] = static_cast<int64_t>(in.u64());
+    }
+    n = in.u32();
+    for (uint32_t i = 0; i < n && in.ok; i++) {
+        std::string name = in.bytes();
+        snap.shards[name] = in.u64();
+    }
+    n = in.u32();
+    for (uint32_t i = 0; i < n && in.ok; i++) {
+        int slot = static_cast<int>(in.u32());
+        GameSlot g;
+        g.game_id = static_cast<int64_t>(in.u64());
+        g.run = static_cast<int32_t>(in.u32());
+        if (!in.need(1 + StateCodec::RECORD_SIZE)) break;
+        g.finished = bytes[in.pos] != 0;
+        if (!StateCodec::decode(reinterpret_cast<const uint8_t*>(bytes.data() + in.pos + 1), g.state)) {
+            in.ok = false;
+            break;
+        }
+        in.pos += 1 + StateCodec::RECORD_SIZE;
+        g.rng = in.bytes();
+        g.payload = in.bytes();
+        snap.slots[slot] = std::move(g);
+    }
+    return in.ok && in.pos == body_start + body_size;
+}
+
+bool CheckpointStore::write_atomic(const std::string& path, const std::string& bytes) {
+    const std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = write_all(fd, bytes.data(), bytes.size()) && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+
+    // rename 자체를 영속화 (디렉터리 엔트리)
+    std::string dir = ".";
+    size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos) dir = slash == 0 ? "/" : path.substr(0, slash);
+    int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dfd >= 0) {
+        ::fsync(dfd);
+        ::close(dfd);
+    }
+    return true;
+}
+
+} // namespace simulator
@@ -0,0 +1,171 @@
+#include "cheese_field.hpp"
+#include <algorithm>
+
+namespace simulator {
+
+namespace {
+
+// 상하좌우 이웃 칸 (맵 안쪽만), 반환값 = 이웃 수
+inline int neighbors(int cell, int out[4]) {
+    int x = cell / MAP_SIZE, y = cell % MAP_SIZE;
+    int n = 0;
+    if (x > 0) out[n++] = cell - MAP_SIZE;
+    if (x < MAP_SIZE - 1) out[n++] = cell + MAP_SIZE;
+    if (y > 0) out[n++] = cell - 1;
+    if (y < MAP_SIZE - 1) out[n++] = cell + 1;
+    return n;
+}
+
+} // namespace
+
+CheeseDistanceField::CheeseDistanceField() {
+    dist_.fill(NONE);
+}
+
+// ============================================================
+// 상태 반영
+// ============================================================
+void CheeseDistanceField::set_state(const GameState& state) {
+    CellMask now = CellMask::from_grid(state.sc);
+    if (!has_map_ || wall_ != state.wall) {
+        wall_ = state.wall;
+        has_map_ = true;
+        cheese_ = now;
+        rebuild();
+        return;
+    }
+    if (now == cheese_) return;
+
+    // 치즈가 새로 생겼으면 (다른 게임 상태) 전체 재계산
+    if (!((now & cheese_) == now)) {
+        cheese_ = now;
+        rebuild();
+        return;
+    }
+    for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+        if (cheese_.test(cell) && !now.test(cell)) {
+            eat_cheese(Position(cell / MAP_SIZE, cell % MAP_SIZE));
+        }
+    }
+}
+
+// ============================================================
+// 전체 다중 출발 BFS (출발 = 남은 치즈, 벽 칸으로는 진입 불가)
+// ============================================================
+void CheeseDistanceField::rebuild() {
+    rebuilds_++;
+    dist_.fill(NONE);
+    int queue[TOTAL_CELLS];
+    int head = 0, tail = 0;
+    for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+        if (cheese_.test(cell)) {
+            dist_[cell] = 0;
+            queue[tail++] = cell;
+        }
+    }
+    int nb[4];
+    while (head < tail) {
+        int u = queue[head++];
+        int n = neighbors(u, nb);
+        for (int k = 0; k < n; k++) {
+            int v = nb[k];
+            if (dist_[v] != NONE || !open(v)) continue;
+            dist_[v] = static_cast<uint8_t>(dist_[u] + 1);
+            queue[tail++] = v;
+        }
+    }
+}
+
+// ============================================================
+// 치즈 제거 → 영향받는 칸만 복구
+//   1. 제거한 칸부터 거리 +1 방향으로, 남은 지지 칸 (거리 -1 이웃)이 없는 칸을 표시
+//      (레벨 순 FIFO라 한 레벨의 표시는 다음 레벨 검사 전에 끝남)
+//   2. 표시한 칸 = 표시 밖 이웃 중 최소 거리 + 1로 초기화
+//   3. 초기값 정렬 목록과 FIFO를 거리 순으로 합치며 표시 영역 안에서 완화
+// ============================================================
+void CheeseDistanceField::eat_cheese(const Position& p) {
+    if (!p.is_valid()) return;
+    int s = p.x * MAP_SIZE + p.y;
+    if (!cheese_.test(s)) return;
+    cheese_.reset(s);
+    removals_++;
+
+    if (!cheese_.any()) {
+        for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+            if (dist_[cell] != NONE) repaired_++;
+        }
+        dist_.fill(NONE);
+        return;
+    }
+
+    int nb[4], nb2[4];
+    CellMask lost;
+    int lost_cells[TOTAL_CELLS];
+    int n_lost = 0;
+    lost.set(s);
+    lost_cells[n_lost++] = s;
+    for (int head = 0; head < n_lost; head++) {
+        int u = lost_cells[head];
+        int n = neighbors(u, nb);
+        for (int k = 0; k < n; k++) {
+            int v = nb[k];
+            if (lost.test(v) || !open(v) || dist_[v] != dist_[u] + 1) continue;
+            bool supported = false;
+            int m = neighbors(v, nb2);
+            for (int j = 0; j < m && !supported; j++) {
+                int w = nb2[j];
+                supported = !lost.test(w) && dist_[w] != NONE && dist_[w] + 1 == dist_[v];
+            }
+            if (!supported) {
+                lost.set(v);
+                lost_cells[n_lost++] = v;
+            }
+        }
+    }
+    repaired_ += n_lost;
+
+    // 경계 거리로 초기화
+    std::pair<uint8_t, int> seeds[TOTAL_CELLS];
+    int n_seeds = 0;
+    for (int i = 0; i < n_lost; i++) {
+        int v = lost_cells[i];
+        int best = NONE;
+        if (open(v)) {
+            int n = neighbors(v, nb);
+            for (int k = 0; k < n; k++) {
+                int w = nb[k];
+                if (!lost.test(w) && dist_[w] != NONE) best = std::min(best, dist_[w] + 1);
+            }
+        }
+        dist_[v] = static_cast<uint8_t>(best);
+        if (best != NONE) seeds[n_seeds++] = {static_cast<uint8_t>(best), v};
+    }
+    std::sort(seeds, seeds + n_seeds);
+
+    // 정렬 목록 + FIFO 병합 (둘 다 거리 비감소)
+    int fifo[TOTAL_CELLS];
+    int head = 0, tail = 0, next_seed = 0;
+    CellMask settled;
+    while (next_seed < n_seeds || head < tail) {
+        int u;
+        if (head < tail && (next_seed >= n_seeds || dist_[fifo[head]] <= seeds[next_seed].first)) {
+            u = fifo[head++];
+        } else {
+            u = seeds[next_seed].second;
+            if (dist_[u] < seeds[next_seed++].first) continue;   // FIFO에서 더 짧게 갱신됨
+        }
+        if (settled.test(u)) continue;
+        settled.set(u);
+        int n = neighbors(u, nb);
+        for (int k = 0; k < n; k++) {
+            int v = nb[k];
+            if (!lost.test(v) || settled.test(v) || !open(v)) continue;
+            if (dist_[u] + 1 < dist_[v]) {
+                dist_[v] = static_cast<uint8_t>(dist_[u] + 1);
+                fifo[tail++] = v;
+            }
+        }
+    }
+}
+
+} // namespace simulator
@@ -0,0 +1,199 @@
+#include "features.hpp"
+#include "bitboard.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace simulator {
+
+namespace {
+
+// 구역 비트마스크 (좌상 / 우상 / 좌하 / 우하 / 나머지 가운데 십자)
+struct RegionMasks {
+    CellMask masks[FeatureVec::NUM_REGIONS];
+
+    RegionMasks() {
+        for (int i = 0; i < MAP_SIZE; i++) {
+            for (int j = 0; j < MAP_SIZE; j++) {
+                int r = 4;
+                if (i <= 4 && j <= 4) r = 0;
+                else if (i <= 4 && j >= 6) r = 1;
+                else if (i >= 6 && j <= 4) r = 2;
+                else if (i >= 6 && j >= 6) r = 3;
+                masks[r].set(i * MAP_SIZE + j);
+            }
+        }
+    }
+};
+
+const RegionMasks& region_masks() {
+    static const RegionMasks masks;
+    return masks;
+}
+
+inline int manhattan(int x1, int y1, int x2, int y2) {
+    return std::abs(x1 - x2) + std::abs(y1 - y2);
+}
+
+} // namespace
+
+// ============================================================
+// 고양이별 도망 방향
+// ============================================================
+void cat_escape_directions(const GameState& state, float* out) {
+    std::fill(out, out + 8, 0.0f);
+    const int mr = state.mouse.x, mc = state.mouse.y;
+    // Python 순서: up, down, left, right
+    static const int DR[4] = {-1, 1, 0, 0};
+    static const int DC[4] = {0, 0, -1, 1};
+
+    for (int c = 0; c < std::min(2, static_cast<int>(state.cats.count)); c++) {
+        int best_dir = 0, best = -2;
+        for (int d = 0; d < 4; d++) {
+            int nr = mr + DR[d], nc = mc + DC[d];
+            int dist = -1;
+            if (nr >= 0 && nr < MAP_SIZE && nc >= 0 && nc < MAP_SIZE && state.wall[nr][nc] == 0) {
+                dist = manhattan(nr, nc, state.cats.x[c], state.cats.y[c]);
+            }
+            if (dist > best) {
+                best = dist;
+                best_dir = d;
+            }
+        }
+        out[c * 4 + best_dir] = 1.0f;
+    }
+}
+
+// ============================================================
+// 치즈 거리 (CheeseDistanceField 값 그대로 정규화)
+// ============================================================
+void cheese_distance_features(const CheeseDistanceField& field, float* out) {
+    const auto& dist = field.distances();
+    for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+        int d = dist[cell] == CheeseDistanceField::NONE ? 999 : dist[cell];
+        out[cell] = static_cast<float>(d / 20.0);
+    }
+}
+
+// ============================================================
+// 고양이 위협도 (고양이 주변 마름모 25칸만 누적)
+// ============================================================
+void cat_threat_map(const GameState& state, float* out) {
+    double threat[TOTAL_CELLS] = {};
+    for (int c = 0; c < state.cats.count; c++) {
+        const int cr = state.cats.x[c], cc = state.cats.y[c];
+        for (int dr = -3; dr <= 3; dr++) {
+            const int r = cr + dr;
+            if (r < 0 || r >= MAP_SIZE) continue;
+            const int span = 3 - std::abs(dr);
+            for (int dc = -span; dc <= span; dc++) {
+                const int col = cc + dc;
+                if (col < 0 || col >= MAP_SIZE) continue;
+                threat[r * MAP_SIZE + col] += (4 - std::abs(dr) - std::abs(dc)) / 4.0;
+            }
+        }
+    }
+    for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+        out[cell] = static_cast<float>(std::min(1.0, std::max(0.0, threat[cell])));
+    }
+}
+
+// ============================================================
+// 구역별 치즈 비율 (구역 마스크 popcount)
+// ============================================================
+void region_cheese_distribution(const GameState& state, float* out) {
+    std::fill(out, out + FeatureVec::NUM_REGIONS, 0.0f);
+    int total = 0;
+    CellMask cheese;
+    for (int i = 0; i < MAP_SIZE; i++) {
+        for (int j = 0; j < MAP_SIZE; j++) {
+            total += state.sc[i][j];
+            if (state.sc[i][j] == 1) cheese.set(i * MAP_SIZE + j);
+        }
+    }
+    if (total == 0) return;
+
+    const RegionMasks& regions = region_masks();
+    for (int r = 0; r < FeatureVec::NUM_REGIONS; r++) {
+        out[r] = static_cast<float>((cheese & regions.masks[r]).count() / static_cast<double>(total));
+    }
+}
+
+// ============================================================
+// 전체 828차원
+// ============================================================
+void encode_feature_vector(const GameState& state, CheeseDistanceField& field, float* out) {
+    std::fill(out, out + FeatureVec::DIM, 0.0f);
+
+    // Spatial: wall / sc / junc / deadend 원본 값
+    const GridMap* grids[4] = {&state.wall, &state.sc, &state.junc, &state.deadend};
+    for (int g = 0; g < 4; g++) {
+        float* dst = out + FeatureVec::GRID_OFFSET + g * TOTAL_CELLS;
+        for (int i = 0; i < MAP_SIZE; i++) {
+            for (int j = 0; j < MAP_SIZE; j++) dst[i * MAP_SIZE + j] = (*grids[g])[i][j];
+        }
+    }
+
+    // Entity: 위치 / 10, 방향 / 3 (마우스 방향은 항상 0)
+    out[FeatureVec::MOUSE_OFFSET] = static_cast<float>(state.mouse.x / 10.0);
+    out[FeatureVec::MOUSE_OFFSET + 1] = static_cast<float>(state.mouse.y / 10.0);
+    const int n_cats = std::min(2, static_cast<int>(state.cats.count));
+    for (int c = 0; c < n_cats; c++) {
+        out[FeatureVec::CAT_OFFSET + 2 * c] = static_cast<float>(state.cats.x[c] / 10.0);
+        out[FeatureVec::CAT_OFFSET + 2 * c + 1] = static_cast<float>(state.cats.y[c] / 10.0);
+        out[FeatureVec::CAT_OFFSET + 4 + c] = static_cast<float>(state.cats.direction[c] / 3.0);
+    }
+
+    // 빅치즈 4칸: movbc 2 + crzbc 2 (없는 슬롯은 (0, 0), 먹힌 칸은 (-1, -1) 그대로)
+    int bc_x[4] = {0, 0, 0, 0}, bc_y[4] = {0, 0, 0, 0};
+    for (int i = 0; i < std::min(2, static_cast<int>(state.movbc.count)); i++) {
+        bc_x[i] = state.movbc.x[i];
+        bc_y[i] = state.movbc.y[i];
+    }
+    for (int i = 0; i < std::min(2, static_cast<int>(state.crzbc.count)); i++) {
+        bc_x[2 + i] = state.crzbc.x[i];
+        bc_y[2 + i] = state.crzbc.y[i];
+    }
+    for (int b = 0; b < 4; b++) {
+        const float px = static_cast<float>(bc_x[b] / 10.0), py = static_cast<float>(bc_y[b] / 10.0);
+        out[FeatureVec::MOVBC_OFFSET + 2 * b] = px;        // movbc 4 + crzbc 4 연속
+        out[FeatureVec::MOVBC_OFFSET + 2 * b + 1] = py;
+        out[FeatureVec::BC_FUTURE_OFFSET + 2 * b] = px;    // 예측 = 현재 위치
+        out[FeatureVec::BC_FUTURE_OFFSET + 2 * b + 1] = py;
+    }
+
+    int bc_dist[4], nearest = 0;
+    for (int b = 0; b < 4; b++) {
+        bc_dist[b] = manhattan(state.mouse.x, state.mouse.y, bc_x[b], bc_y[b]);
+        if (bc_dist[b] < bc_dist[nearest]) nearest = b;
+    }
+    out[FeatureVec::NEAREST_BC_OFFSET + nearest] = 1.0f;
+
+    cat_escape_directions(state, out + FeatureVec::ESCAPE_OFFSET);
+
+    // GameState 스칼라
+    float* scalars = out + FeatureVec::SCALAR_OFFSET;
+    scalars[0] = static_cast<float>(state.life / 3.0);
+    scalars[1] = static_cast<float>(state.score / 1000.0);
+    scalars[2] = static_cast<float>(state.step / 200.0);
+    scalars[3] = static_cast<float>(state.func_chance / 4.0);
+    scalars[4] = static_cast<float>(state.run / 20.0);
+
+    for (int b = 0; b < 4; b++) {
+        out[FeatureVec::BC_DIST_OFFSET + b] = static_cast<float>(bc_dist[b] / 20.0);
+        if (state.cats.count > 0) {
+            int min_cat = MAP_SIZE * 4;
+            for (int c = 0; c < state.cats.count; c++) {
+                min_cat = std::min(min_cat, manhattan(bc_x[b], bc_y[b], state.cats.x[c], state.cats.y[c]));
+            }
+            out[FeatureVec::BC_THREAT_OFFSET + b] = static_cast<float>(std::max(0.0, (4 - min_cat) / 4.0));
+        }
+    }
+    out[FeatureVec::NEAREST_BC_IDX_OFFSET] = static_cast<float>(nearest / 4.0);
+
+    field.set_state(state);
+    cheese_distance_features(field, out + FeatureVec::CHEESE_DIST_OFFSET);
+    cat_threat_map(state, out + FeatureVec::CAT_THREAT_OFFSET);
+    region_cheese_distribution(state, out + FeatureVec::REGION_OFFSET);
+}
+
+} // namespace simulator
@@ -0,0 +1,167 @@
+#include "function_index.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace simulator {
+
+// ============================================================
+// 생성자: 라이브러리 ID 정렬 + 본문 중복 표시
+// ============================================================
+FunctionIndex::FunctionIndex() : sim_(0) {
+    const FunctionLibrary& lib = sim_.function_library();
+    lib.for_each_function([&](int id, const std::vector<int>&) {
+        if (Token::is_func_lib(id)) func_ids_.push_back(id);
+    });
+    std::sort(func_ids_.begin(), func_ids_.end());
+
+    slot_of_.assign(Token::FUNC_LIB_END - Token::FUNC_LIB_START + 1, -1);
+    duplicate_.assign(func_ids_.size(), 0);
+    std::map<std::vector<int>, int> first_id;
+    for (size_t k = 0; k < func_ids_.size(); k++) {
+        int id = func_ids_[k];
+        slot_of_[id - Token::FUNC_LIB_START] = static_cast<int16_t>(k);
+        if (!first_id.emplace(lib.get_function(id), id).second) duplicate_[k] = 1;
+    }
+
+    entries_.resize(func_ids_.size());
+    order_.resize(func_ids_.size());
+    for (size_t k = 0; k < func_ids_.size(); k++) {
+        entries_[k] = Entry{func_ids_[k], 0, 0, 0, Position(-1, -1)};
+        order_[k] = static_cast<int>(k);
+    }
+}
+
+// ============================================================
+// 시작 칸별 전개 (Simulator 액션 변환 그대로, 벽 충돌 액션은 이동 없음)
+// ============================================================
+const std::vector<FunctionIndex::Expansion>& FunctionIndex::expansions(int cell) {
+    std::vector<Expansion>& out = paths_[cell];
+    if (!out.empty()) return out;
+
+    GameState st;
+    st.wall = wall_;
+    st.junc = junc_;
+    st.mouse = Position(static_cast<int8_t>(cell / MAP_SIZE), static_cast<int8_t>(cell % MAP_SIZE));
+    st.mouse_last = st.mouse;
+    sim_.restore_state(st);
+
+    out.resize(func_ids_.size());
+    std::vector<int> program(2, Token::END);
+    for (size_t k = 0; k < func_ids_.size(); k++) {
+        program[0] = func_ids_[k];
+        ActionResult actions = sim_.expand_mouse_actions(program);
+
+        Expansion& e = out[k];
+        e.wall_hits = 0;
+        Position m = st.mouse;
+        for (size_t t = 0; t < actions.actions.size(); t++) {
+            if (actions.wall_hit[t]) {
+                e.wall_hits++;
+                continue;
+            }
+            m = m.move(actions.actions[t]);
+            e.visited.set(m.x * MAP_SIZE + m.y);
+        }
+        e.moves = static_cast<int16_t>(actions.moves);
+        e.end = m;
+    }
+    return out;
+}
+
+// ============================================================
+// 상태 반영 / 치즈 갱신
+// ============================================================
+void FunctionIndex::set_state(const GameState& state) {
+    if (!has_map_ ||
+        std::memcmp(&wall_, &state.wall, sizeof(GridMap)) != 0 ||
+        std::memcmp(&junc_, &state.junc, sizeof(GridMap)) != 0) {
+        wall_ = state.wall;
+        junc_ = state.junc;
+        has_map_ = true;
+        for (auto& p : paths_) p.clear();
+    }
+
+    cell_ = state.mouse.x * MAP_SIZE + state.mouse.y;
+    cheese_ = CellMask::from_grid(state.sc);
+
+    const std::vector<Expansion>& paths = expansions(cell_);
+    for (size_t k = 0; k < entries_.size(); k++) {
+        const Expansion& e = paths[k];
+        Entry& entry = entries_[k];
+        entry.cheese = (e.visited & cheese_).count();
+        entry.wall_hits = e.wall_hits;
+        entry.moves = e.moves;
+        entry.end = e.end;
+    }
+    std::sort(order_.begin(), order_.end(), [this](int a, int b) { return ranks_before(a, b); });
+    dirty_ = false;
+}
+
+void FunctionIndex::eat_cheese(const Position& p) {
+    if (cell_ < 0 || !p.is_valid()) return;
+    int cell = p.x * MAP_SIZE + p.y;
+    if (!cheese_.test(cell)) return;
+    cheese_.reset(cell);
+
+    const std::vector<Expansion>& paths = paths_[cell_];
+    for (size_t k = 0; k < entries_.size(); k++) {
+        if (paths[k].visited.test(cell)) {
+            entries_[k].cheese--;
+            dirty_ = true;
+        }
+    }
+}
+
+// ============================================================
+// 순위
+// ============================================================
+bool FunctionIndex::ranks_before(int a, int b) const {
+    const Entry& ea = entries_[a];
+    const Entry& eb = entries_[b];
+    if (ea.cheese != eb.cheese) return ea.cheese > eb.cheese;
+    if (ea.wall_hits != eb.wall_hits) return ea.wall_hits < eb.wall_hits;
+    return ea.func_id < eb.func_id;
+}
+
+void FunctionIndex::resort() {
+    if (!dirty_) return;
+    // 치즈 수만 조금 줄어든 상태 → 거의 정렬되어 있어 삽입 정렬이 선형에 가까움
+    for (size_t i = 1; i < order_.size(); i++) {
+        int v = order_[i];
+        size_t j = i;
+        while (j > 0 && ranks_before(v, order_[j - 1])) {
+            order_[j] = order_[j - 1];
+            j--;
+        }
+        order_[j] = v;
+    }
+    dirty_ = false;
+}
+
+std::vector<FunctionIndex::Entry> FunctionIndex::top(int n, bool distinct) {
+    std::vector<Entry> result;
+    if (cell_ < 0 || n <= 0) return result;
+    resort();
+    result.reserve(std::min<size_t>(n, order_.size()));
+    for (int k : order_) {
+        if ((int)result.size() >= n) break;
+        if (distinct && duplicate_[k]) continue;
+        result.push_back(entries_[k]);
+    }
+    return result;
+}
+
+std::vector<int> FunctionIndex::top_ids(int n, bool distinct) {
+    std::vector<int> ids;
+    for (const Entry& e : top(n, distinct)) ids.push_back(e.func_id);
+    return ids;
+}
+
+const FunctionIndex::Entry* FunctionIndex::find(int func_id) const {
+    if (cell_ < 0 || !Token::is_func_lib(func_id)) return nullptr;
+    int k = slot_of_[func_id - Token::FUNC_LIB_START];
+    return k < 0 ? nullptr : &entries_[k];
+}
+
+} // namespace simulator
@@ -0,0 +1,170 @@
+#include "grpo_sampler.hpp"
+#include "simulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+namespace {
+
+// (seed, g) → 샘플별 독립 시드
+inline uint64_t mix_seed(uint64_t seed, uint64_t g) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (g + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct SampleTable {
+    const float* probs;
+    int n_positions;
+    int n_slots;
+    int vocab;
+
+    const float* row(int position, int slot) const {
+        int pos = std::min(position, n_positions - 1);
+        int s = n_slots == 1 ? 0 : slot;
+        return probs + (static_cast<size_t>(pos) * n_slots + s) * vocab;
+    }
+};
+
+// 문법 마스크 + 온도 적용 분포에서 프로그램 하나 샘플
+void sample_program(const SampleTable& table, const uint8_t* library_ok,
+                    int max_tokens, float temperature, std::mt19937_64& rng,
+                    std::vector<int>& program, std::vector<float>& log_probs,
+                    std::vector<int>& cand, std::vector<double>& weight) {
+    ProgramGrammar grammar(max_tokens, library_ok);
+    const double inv_t = 1.0 / temperature;
+    const int vocab_limit = std::min(table.vocab, Token::EMPTY);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    while (!grammar.done()) {
+        const float* p = table.row(grammar.length(), grammar.slot());
+        cand.clear();
+        weight.clear();
+        double total = 0.0;
+        for (int t = 0; t < vocab_limit; t++) {
+            if (!grammar.allows(t)) continue;
+            double w = p[t] > 0.0f ? (inv_t == 1.0 ? p[t] : std::pow(static_cast<double>(p[t]), inv_t)) : 0.0;
+            cand.push_back(t);
+            weight.push_back(w);
+            total += w;
+        }
+        if (cand.empty()) {
+            // 어휘에 허용 토큰이 없음 (END가 어휘 밖 등) → 강제 종료
+            program.push_back(Token::END);
+            log_probs.push_back(0.0f);
+            break;
+        }
+        if (!(total > 0.0)) {
+            std::fill(weight.begin(), weight.end(), 1.0);
+            total = static_cast<double>(cand.size());
+        }
+
+        const double r = uni(rng) * total;
+        double acc = 0.0;
+        size_t k = 0;
+        size_t last = 0;  // 반올림으로 끝까지 간 경우 마지막 양수 항목
+        for (; k < cand.size(); k++) {
+            if (weight[k] <= 0.0) continue;
+            last = k;
+            acc += weight[k];
+            if (r < acc) break;
+        }
+        if (k == cand.size()) k = last;
+
+        grammar.push(cand[k]);
+        program.push_back(cand[k]);
+        log_probs.push_back(static_cast<float>(std::log(weight[k] / total)));
+    }
+}
+
+} // namespace
+
+// ============================================================
+// 그룹 샘플 + 평가 (OpenMP 병렬, 샘플 단위)
+// ============================================================
+GroupSample sample_group(const GameState& state,
+                         const float* probs, int n_positions, int n_slots, int vocab,
+                         const GroupSamplerConfig& config) {
+    const int G = std::max(config.group_size, 0);
+    GroupSample out;
+    out.programs.resize(G);
+    out.token_log_probs.resize(G);
+    out.log_probs.resize(G);
+    out.scores.resize(G);
+    out.advantages.assign(G, 0.0f);
+    if (G == 0) return out;
+
+    FunctionLibrary lib;
+    if (!config.functions.empty()) lib.load_flat(config.functions);
+    const std::vector<uint8_t> library_ok = ProgramGrammar::library_mask(lib);
+    const SampleTable table{probs, n_positions, n_slots, vocab};
+    const float temperature = config.temperature > 0.0f ? config.temperature : 1.0f;
+
+    auto run_sample = [&](Simulator& sim, std::vector<int>& cand, std::vector<double>& weight, int g) {
+        std::mt19937_64 rng(mix_seed(config.seed, g));
+        sample_program(table, library_ok.data(), config.max_tokens, temperature, rng,
+                       out.programs[g], out.token_log_probs[g], cand, weight);
+        double sum = 0.0;
+        for (float lp : out.token_log_probs[g]) sum += lp;
+        out.log_probs[g] = static_cast<float>(sum);
+
+        sim.restore_state(state);
+        sim.seed(static_cast<uint32_t>(rng()));
+        out.scores[g] = sim.simulate_compiled(sim.compile_program(out.programs[g]),
+                                              config.cat_policy, config.crzbc_policy);
+    };
+
+#ifdef USE_OPENMP
+    int num_threads = config.num_threads;
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        Simulator sim(0);
+        if (!config.functions.empty()) sim.load_functions(config.functions);
+        sim.set_rules(config.rules);
+        std::vector<int> cand;
+        std::vector<double> weight;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int g = 0; g < G; g++) {
+            run_sample(sim, cand, weight, g);
+        }
+    }
+#else
+    // 시리얼 버전
+    Simulator sim(0);
+    if (!config.functions.empty()) sim.load_functions(config.functions);
+    sim.set_rules(config.rules);
+    std::vector<int> cand;
+    std::vector<double> weight;
+    for (int g = 0; g < G; g++) {
+        run_sample(sim, cand, weight, g);
+    }
+#endif
+
+    // 그룹 정규화 이점
+    double mean = 0.0;
+    for (float s : out.scores) mean += s;
+    mean /= G;
+    double var = 0.0;
+    for (float s : out.scores) var += (s - mean) * (s - mean);
+    const double stddev = std::sqrt(var / G);
+    if (stddev > 0.0) {
+        for (int g = 0; g < G; g++) {
+            out.advantages[g] = static_cast<float>((out.scores[g] - mean) / (stddev + 1e-6));
+        }
+    }
+    return out;
+}
+
+} // namespace simulator
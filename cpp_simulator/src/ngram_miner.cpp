@@ -0,0 +1,301 @@
+#include "ngram_miner.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+// ============================================================
+// 프로그램 단위 변환
+// ============================================================
+namespace ProgramUnit {
+
+int token_length(int sym) {
+    return sym < LOOP_BASE ? 1 : 3;
+}
+
+void append_tokens(int sym, std::vector<int>& out) {
+    if (sym < LOOP_BASE) {
+        out.push_back(sym - 1);
+    } else if (sym < IF_BASE) {
+        int v = sym - LOOP_BASE;
+        out.push_back(Token::LOOP);
+        out.push_back(Token::NUM_BASE + v / NUM_DIR);
+        out.push_back(v % NUM_DIR);
+    } else {
+        int v = sym - IF_BASE;
+        out.push_back(Token::IF);
+        out.push_back(Token::NUM_1 + v / NUM_DIR);
+        out.push_back(v % NUM_DIR);
+    }
+}
+
+void tokenize(const int* tokens, size_t n, const FunctionLibrary* inline_functions,
+              std::vector<uint8_t>& units) {
+    int func1 = -1;
+    int func2 = -1;
+
+    auto inline_body = [&](int func_id) {
+        const std::vector<int>& body = inline_functions->get_function(func_id);
+        tokenize(body.data(), body.size(), nullptr, units);
+    };
+
+    for (size_t i = 0; i < n; i++) {
+        int t = tokens[i];
+        if (t == Token::END) break;
+        if (t == Token::EMPTY) continue;
+
+        if (Token::is_direction(t)) {
+            units.push_back(static_cast<uint8_t>(1 + t));
+        } else if (t == Token::LOOP && i + 2 < n &&
+                   Token::is_num(tokens[i + 1]) && Token::is_direction(tokens[i + 2])) {
+            units.push_back(static_cast<uint8_t>(
+                LOOP_BASE + (tokens[i + 1] - Token::NUM_BASE) * NUM_DIR + tokens[i + 2]));
+            i += 2;
+        } else if (t == Token::IF && i + 2 < n &&
+                   Token::is_if_num(tokens[i + 1]) && Token::is_direction(tokens[i + 2])) {
+            units.push_back(static_cast<uint8_t>(
+                IF_BASE + (tokens[i + 1] - Token::NUM_1) * NUM_DIR + tokens[i + 2]));
+            i += 2;
+        } else if (inline_functions && Token::is_func_lib(t)) {
+            // Simulator::parse_program과 같은 F1/F2 배정
+            if (func1 < 0) func1 = t;
+            else if (t != func1 && func2 < 0) func2 = t;
+            if (t == func1 || t == func2) inline_body(t);
+        } else if (inline_functions && t == Token::FUNC_F1 && func1 >= 0) {
+            inline_body(func1);
+        } else if (inline_functions && t == Token::FUNC_F2 && func2 >= 0) {
+            inline_body(func2);
+        } else {
+            units.push_back(0);
+        }
+    }
+}
+
+} // namespace ProgramUnit
+
+namespace {
+
+// 패킹 키의 단위 수 (최상위 기호 위치)
+inline int key_units(uint64_t key) {
+    int bits = 64 - __builtin_clzll(key);
+    return (bits + ProgramUnit::BITS - 1) / ProgramUnit::BITS;
+}
+
+std::vector<int> key_to_body(uint64_t key) {
+    int n = key_units(key);
+    std::vector<int> body;
+    for (int k = n - 1; k >= 0; k--) {
+        int sym = static_cast<int>((key >> (k * ProgramUnit::BITS)) & ((1u << ProgramUnit::BITS) - 1));
+        ProgramUnit::append_tokens(sym, body);
+    }
+    return body;
+}
+
+inline size_t probe_start(uint64_t key, size_t mask) {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+} // namespace
+
+// ============================================================
+// 오픈 어드레싱 테이블
+// ============================================================
+void NgramMiner::FlatTable::rehash(size_t capacity) {
+    std::vector<uint64_t> old_keys;
+    std::vector<Counts> old_vals;
+    old_keys.swap(keys_);
+    old_vals.swap(vals_);
+    keys_.assign(capacity, 0);
+    vals_.assign(capacity, Counts{});
+    size_ = 0;
+    for (size_t i = 0; i < old_keys.size(); i++) {
+        if (old_keys[i]) at(old_keys[i]) = old_vals[i];
+    }
+}
+
+NgramMiner::Counts& NgramMiner::FlatTable::at(uint64_t key) {
+    if ((size_ + 1) * 2 > keys_.size()) rehash(keys_.size() * 2);
+    size_t mask = keys_.size() - 1;
+    size_t i = probe_start(key, mask);
+    while (keys_[i] && keys_[i] != key) i = (i + 1) & mask;
+    if (!keys_[i]) {
+        keys_[i] = key;
+        size_++;
+    }
+    return vals_[i];
+}
+
+void NgramMiner::FlatTable::merge(const FlatTable& other) {
+    other.for_each([&](uint64_t key, const Counts& c) {
+        Counts& d = at(key);
+        d.gain += c.gain;
+        d.token_count += c.token_count;
+        d.programs += c.programs;
+        d.expanded_count += c.expanded_count;
+    });
+}
+
+// ============================================================
+// 채굴기
+// ============================================================
+NgramMiner::NgramMiner(int max_units)
+    : max_units_(std::max(1, std::min(max_units, ProgramUnit::MAX_UNITS))) {}
+
+void NgramMiner::count_program(const int* tokens, size_t n, FlatTable& table,
+                               std::vector<uint8_t>& units,
+                               std::vector<std::pair<uint64_t, int>>& occ) const {
+    // 이미 함수 두 종류를 쓰는 프로그램은 새 함수를 넣을 수 없음 → 압축 이득 없음
+    int func1 = -1;
+    bool full = false;
+    for (size_t i = 0; i < n && tokens[i] != Token::END; i++) {
+        if (!Token::is_func_lib(tokens[i])) continue;
+        if (func1 < 0) func1 = tokens[i];
+        else if (tokens[i] != func1) { full = true; break; }
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        const bool expanded = pass == 1;
+        units.clear();
+        ProgramUnit::tokenize(tokens, n, expanded ? &lib_ : nullptr, units);
+
+        occ.clear();
+        for (size_t s = 0; s < units.size(); s++) {
+            uint64_t key = 0;
+            int n_tokens = 0;
+            for (int len = 1; len <= max_units_ && s + len <= units.size(); len++) {
+                int sym = units[s + len - 1];
+                if (sym == 0) break;
+                n_tokens += ProgramUnit::token_length(sym);
+                if (n_tokens > ProgramUnit::MAX_BODY_TOKENS) break;
+                key = (key << ProgramUnit::BITS) | static_cast<uint64_t>(sym);
+                if (n_tokens >= 2) occ.emplace_back(key, static_cast<int>(s));
+            }
+        }
+
+        // 같은 n-gram은 프로그램 안에서 겹치지 않게 왼쪽부터 셈
+        std::sort(occ.begin(), occ.end());
+        for (size_t i = 0; i < occ.size();) {
+            uint64_t key = occ[i].first;
+            int len = key_units(key);
+            int last_end = -1;
+            uint32_t count = 0;
+            for (; i < occ.size() && occ[i].first == key; i++) {
+                if (occ[i].second >= last_end) {
+                    count++;
+                    last_end = occ[i].second + len;
+                }
+            }
+
+            Counts& c = table.at(key);
+            if (expanded) {
+                c.expanded_count += count;
+            } else {
+                c.token_count += count;
+                c.programs += 1;
+                if (!full) {
+                    int n_tokens = 0;
+                    for (int k = 0; k < len; k++) {
+                        n_tokens += ProgramUnit::token_length(
+                            static_cast<int>((key >> (k * ProgramUnit::BITS)) & ((1u << ProgramUnit::BITS) - 1)));
+                    }
+                    c.gain += static_cast<uint64_t>(count) * (n_tokens - 1);
+                }
+            }
+        }
+    }
+}
+
+void NgramMiner::add_programs(const int* tokens, const int64_t* offsets, size_t n_programs,
+                              int num_threads) {
+    const int64_t n = static_cast<int64_t>(n_programs);
+
+#ifdef USE_OPENMP
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+    std::vector<FlatTable> locals(num_threads);
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        FlatTable& local = locals[omp_get_thread_num()];
+        std::vector<uint8_t> units;
+        std::vector<std::pair<uint64_t, int>> occ;
+
+        #pragma omp for schedule(dynamic, 256)
+        for (int64_t i = 0; i < n; i++) {
+            count_program(tokens + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i]),
+                          local, units, occ);
+        }
+    }
+    for (const FlatTable& local : locals) table_.merge(local);
+#else
+    // 시리얼 버전
+    (void)num_threads;
+    std::vector<uint8_t> units;
+    std::vector<std::pair<uint64_t, int>> occ;
+    for (int64_t i = 0; i < n; i++) {
+        count_program(tokens + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i]),
+                      table_, units, occ);
+    }
+#endif
+
+    num_programs_ += n_programs;
+}
+
+std::vector<NgramMiner::Candidate> NgramMiner::candidates(size_t top_n, uint32_t min_programs) const {
+    // 기존 라이브러리 본문 (단위열로 표현되는 것만)
+    std::unordered_set<uint64_t> existing;
+    std::vector<uint8_t> units;
+    lib_.for_each_function([&](int, const std::vector<int>& body) {
+        units.clear();
+        ProgramUnit::tokenize(body.data(), body.size(), nullptr, units);
+        if (units.empty() || (int)units.size() > ProgramUnit::MAX_UNITS) return;
+        uint64_t key = 0;
+        for (uint8_t sym : units) {
+            if (sym == 0) return;
+            key = (key << ProgramUnit::BITS) | sym;
+        }
+        existing.insert(key);
+    });
+
+    std::vector<std::pair<uint64_t, Counts>> ranked;
+    table_.for_each([&](uint64_t key, const Counts& c) {
+        if (c.gain == 0 || c.programs < min_programs || existing.count(key)) return;
+        ranked.emplace_back(key, c);
+    });
+
+    auto better = [](const std::pair<uint64_t, Counts>& a, const std::pair<uint64_t, Counts>& b) {
+        if (a.second.gain != b.second.gain) return a.second.gain > b.second.gain;
+        if (a.second.expanded_count != b.second.expanded_count)
+            return a.second.expanded_count > b.second.expanded_count;
+        return a.first < b.first;
+    };
+    size_t n = std::min(top_n, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(), better);
+
+    std::vector<Candidate> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const Counts& c = ranked[i].second;
+        result.push_back(Candidate{key_to_body(ranked[i].first), c.gain, c.token_count,
+                                   c.programs, c.expanded_count});
+    }
+    return result;
+}
+
+std::vector<int> NgramMiner::emit_flat(const std::vector<Candidate>& cands) const {
+    std::vector<int> free_ids = lib_.redundant_ids();
+    std::vector<int> flat;
+    for (size_t i = 0; i < cands.size() && i < free_ids.size(); i++) {
+        flat.push_back(free_ids[i]);
+        flat.push_back(static_cast<int>(cands[i].body.size()));
+        flat.insert(flat.end(), cands[i].body.begin(), cands[i].body.end());
+    }
+    return flat;
+}
+
+} // namespace simulator
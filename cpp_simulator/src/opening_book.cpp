@@ -0,0 +1,192 @@
+#include "opening_book.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace simulator {
+
+using namespace OpeningBookFormat;
+
+uint64_t opening_key(const MapSymmetry& symmetry, const GameState& state, Symmetry& sym) {
+    MapSymmetry::Canonical c = symmetry.canonicalize(state, {});
+    sym = c.sym;
+    return c.hash;
+}
+
+// ============================================================
+// 생성기
+// ============================================================
+OpeningBookWriter::OpeningBookWriter(const GameState& map_state, const FunctionLibrary& lib, int max_moves)
+    : symmetry_(map_state, lib), max_moves_(std::max(1, max_moves)) {}
+
+int OpeningBookWriter::add(const GameState& state, const std::vector<BookMove>& moves, uint32_t visits) {
+    Symmetry sym;
+    Pending& e = entries_[opening_key(symmetry_, state, sym)];
+    e.visits += visits;
+
+    int added = 0;
+    std::vector<int> canonical;
+    for (const BookMove& m : moves) {
+        if (!symmetry_.transform_program(m.program, sym, canonical)) continue;
+        added++;
+
+        auto it = std::find_if(e.moves.begin(), e.moves.end(),
+                               [&](const BookMove& x) { return x.program == canonical; });
+        if (it == e.moves.end()) {
+            BookMove c = m;
+            c.program = canonical;
+            e.moves.push_back(std::move(c));
+            continue;
+        }
+
+        // 합동 평균 / 분산
+        const double n1 = it->sims, n2 = m.sims;
+        const double n = n1 + n2;
+        if (n <= 0) continue;
+        const double mean = (n1 * it->mean + n2 * m.mean) / n;
+        const double sq = (n1 * (double(it->stddev) * it->stddev + double(it->mean) * it->mean) +
+                           n2 * (double(m.stddev) * m.stddev + double(m.mean) * m.mean)) / n;
+        it->mean = static_cast<float>(mean);
+        it->stddev = static_cast<float>(std::sqrt(std::max(0.0, sq - mean * mean)));
+        it->sims = static_cast<uint32_t>(n);
+    }
+    return added;
+}
+
+bool OpeningBookWriter::save(const std::string& path) const {
+    std::vector<Entry> entries;
+    std::vector<Move> moves;
+    std::vector<int16_t> tokens;
+
+    for (const auto& kv : entries_) {
+        std::vector<const BookMove*> ranked;
+        for (const BookMove& m : kv.second.moves) ranked.push_back(&m);
+        std::stable_sort(ranked.begin(), ranked.end(),
+                         [](const BookMove* a, const BookMove* b) { return a->mean > b->mean; });
+        if (static_cast<int>(ranked.size()) > max_moves_) ranked.resize(max_moves_);
+
+        entries.push_back(Entry{kv.first, static_cast<uint32_t>(moves.size()),
+                                static_cast<uint32_t>(ranked.size()), kv.second.visits, 0});
+        for (const BookMove* m : ranked) {
+            moves.push_back(Move{static_cast<uint32_t>(tokens.size()),
+                                 static_cast<uint32_t>(m->program.size()),
+                                 m->mean, m->stddev, m->sims, 0});
+            for (int t : m->program) tokens.push_back(static_cast<int16_t>(t));
+        }
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.n_entries = entries.size();
+    header.n_moves = moves.size();
+    header.n_tokens = tokens.size();
+
+    const std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && std::fwrite(entries.data(), sizeof(Entry), entries.size(), f) == entries.size();
+    ok = ok && std::fwrite(moves.data(), sizeof(Move), moves.size(), f) == moves.size();
+    ok = ok && std::fwrite(tokens.data(), sizeof(int16_t), tokens.size(), f) == tokens.size();
+    ok = ok && std::fflush(f) == 0 && ::fsync(fileno(f)) == 0;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ============================================================
+// 조회
+// ============================================================
+OpeningBook::OpeningBook(const GameState& map_state, const FunctionLibrary& lib)
+    : symmetry_(map_state, lib) {}
+
+OpeningBook::~OpeningBook() {
+    close();
+}
+
+void OpeningBook::close() {
+    if (base_) ::munmap(base_, bytes_);
+    base_ = nullptr;
+    bytes_ = 0;
+    entries_ = nullptr;
+    moves_ = nullptr;
+    tokens_ = nullptr;
+    n_entries_ = 0;
+}
+
+bool OpeningBook::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    const size_t bytes = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    const Header* h = static_cast<const Header*>(base);
+    const size_t expected = sizeof(Header) + h->n_entries * sizeof(Entry) +
+                            h->n_moves * sizeof(Move) + h->n_tokens * sizeof(int16_t);
+    if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION || expected != bytes) {
+        ::munmap(base, bytes);
+        return false;
+    }
+
+    base_ = base;
+    bytes_ = bytes;
+    const char* p = static_cast<const char*>(base) + sizeof(Header);
+    entries_ = reinterpret_cast<const Entry*>(p);
+    moves_ = reinterpret_cast<const Move*>(p + h->n_entries * sizeof(Entry));
+    tokens_ = reinterpret_cast<const int16_t*>(p + h->n_entries * sizeof(Entry) + h->n_moves * sizeof(Move));
+    n_entries_ = h->n_entries;
+    return true;
+}
+
+uint64_t OpeningBook::key(const GameState& state) const {
+    Symmetry sym;
+    return opening_key(symmetry_, state, sym);
+}
+
+bool OpeningBook::lookup(const GameState& state, std::vector<BookMove>& moves, uint32_t& visits) const {
+    moves.clear();
+    visits = 0;
+    if (!base_) return false;
+
+    Symmetry sym;
+    const uint64_t k = opening_key(symmetry_, state, sym);
+    const Entry* end = entries_ + n_entries_;
+    const Entry* e = std::lower_bound(entries_, end, k,
+                                      [](const Entry& x, uint64_t key) { return x.key < key; });
+    if (e == end || e->key != k) return false;
+
+    // 대표 → 원래 방향
+    const Symmetry back = inverse(sym);
+    std::vector<int> canonical;
+    for (uint32_t i = 0; i < e->n_moves; i++) {
+        const Move& m = moves_[e->first_move + i];
+        canonical.assign(tokens_ + m.first_token, tokens_ + m.first_token + m.n_tokens);
+        BookMove out;
+        if (!symmetry_.transform_program(canonical, back, out.program)) continue;
+        out.mean = m.mean;
+        out.stddev = m.stddev;
+        out.sims = m.sims;
+        moves.push_back(std::move(out));
+    }
+    visits = e->visits;
+    return !moves.empty();
+}
+
+} // namespace simulator
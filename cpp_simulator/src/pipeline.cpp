@@ -0,0 +1,497 @@
+#include "pipeline.hpp"
+#include "function_library.hpp"
+#include "simulator.hpp"
+#include <cstring>
+#include <unistd.h>
+
+namespace simulator {
+
+using namespace SampleShardFormat;
+
+namespace {
+
+uint64_t since_us(std::chrono::steady_clock::time_point t0) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count());
+}
+
+// (남은 작은 치즈 수, 남은 빅치즈 수)
+void count_cheese(const GameState& state, int& small, int& big) {
+    small = 0;
+    big = 0;
+    for (int i = 0; i < MAP_SIZE; i++) {
+        for (int j = 0; j < MAP_SIZE; j++) small += state.sc[i][j] == 1;
+    }
+    for (int i = 0; i < state.movbc.count; i++) big += state.movbc.active[i] != 0;
+    for (int i = 0; i < state.crzbc.count; i++) big += state.crzbc.active[i] != 0;
+}
+
+template <typename T>
+void put(std::string& buf, const T& v) {
+    buf.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+void append_sample(std::string& buf, const PipelineSample& s) {
+    Record r{};
+    r.game = s.game;
+    r.run = s.run;
+    r.mirrored = s.mirrored ? 1 : 0;
+    r.count = s.count;
+    r.n_programs = static_cast<uint32_t>(s.programs.size());
+    put(buf, r);
+    buf.append(reinterpret_cast<const char*>(s.state_vec.data()), StateVec::DIM * sizeof(float));
+    for (size_t k = 0; k < s.programs.size(); k++) {
+        put(buf, k < s.scores.size() ? s.scores[k] : 0.0f);
+        put(buf, static_cast<uint32_t>(s.programs[k].size()));
+        for (int t : s.programs[k]) put(buf, static_cast<int32_t>(t));
+    }
+}
+
+// 0 = 하드웨어 스레드 - 인코더 - 기록 / 증강 2개
+int search_workers(const PipelineConfig& config) {
+    if (config.search_workers > 0) return config.search_workers;
+    const int hw = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(1, hw - std::max(config.encode_workers, 1) - 2);
+}
+
+} // namespace
+
+// ============================================================
+// 관측 인코더
+// ============================================================
+void encode_state_vector(const GameState& state, float* out) {
+    const double scale = StateVec::DYNAMIC_SCALE;
+    std::fill(out, out + StateVec::DIM, 0.0f);
+
+    const GridMap* grids[StateVec::NUM_GRIDS] = {&state.wall, &state.sc, &state.junc, &state.deadend};
+    for (int g = 0; g < StateVec::NUM_GRIDS; g++) {
+        float* dst = out + StateVec::GRID_OFFSET + g * TOTAL_CELLS;
+        for (int i = 0; i < MAP_SIZE; i++) {
+            for (int j = 0; j < MAP_SIZE; j++) {
+                const int v = (*grids[g])[i][j];
+                dst[i * MAP_SIZE + j] = g == 1 ? static_cast<float>(v * scale) : static_cast<float>(v);
+            }
+        }
+    }
+
+    out[StateVec::MOUSE_OFFSET] = state.mouse.x;
+    out[StateVec::MOUSE_OFFSET + 1] = state.mouse.y;
+    for (int i = 0; i < Config::MAX_CATS; i++) {
+        const bool has = i < state.cats.count;
+        out[StateVec::CAT_OFFSET + 2 * i] = has ? state.cats.x[i] : -1.0f;
+        out[StateVec::CAT_OFFSET + 2 * i + 1] = has ? state.cats.y[i] : -1.0f;
+    }
+    for (int i = 0; i < Config::MAX_CRZBC; i++) {
+        const bool has = i < state.crzbc.count && state.crzbc.active[i];
+        out[StateVec::CRZBC_OFFSET + 2 * i] = has ? state.crzbc.x[i] : -1.0f;
+        out[StateVec::CRZBC_OFFSET + 2 * i + 1] = has ? state.crzbc.y[i] : -1.0f;
+    }
+
+    float* scalars = out + StateVec::SCALAR_OFFSET;
+    scalars[0] = static_cast<float>(state.score / 1000.0 * scale);
+    scalars[1] = static_cast<float>(state.life * scale / 3.0);
+    scalars[2] = static_cast<float>(state.run * scale / 20.0);
+    scalars[3] = state.win_sign ? static_cast<float>(scale) : 0.0f;
+    scalars[4] = state.lose_sign ? static_cast<float>(scale) : 0.0f;
+    scalars[5] = state.step_limit > 0 ?
+        static_cast<float>(static_cast<double>(state.step) / state.step_limit * scale) : 0.0f;
+}
+
+// ============================================================
+// 샘플 샤드 읽기
+// ============================================================
+bool read_sample_shard(const std::string& path, std::vector<PipelineSample>& out) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    Header h;
+    if (std::fread(&h, sizeof(h), 1, f) != 1 || std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        h.version != VERSION || h.dim != static_cast<uint32_t>(StateVec::DIM)) {
+        std::fclose(f);
+        return false;
+    }
+
+    for (;;) {
+        Record r;
+        if (std::fread(&r, sizeof(r), 1, f) != 1) break;
+        PipelineSample s;
+        s.game = r.game;
+        s.run = r.run;
+        s.mirrored = r.mirrored != 0;
+        s.count = r.count;
+        s.state_vec.resize(StateVec::DIM);
+        bool ok = std::fread(s.state_vec.data(), sizeof(float), StateVec::DIM, f) ==
+                  static_cast<size_t>(StateVec::DIM);
+        for (uint32_t k = 0; ok && k < r.n_programs; k++) {
+            float score;
+            uint32_t len;
+            ok = std::fread(&score, sizeof(score), 1, f) == 1 && std::fread(&len, sizeof(len), 1, f) == 1 &&
+                 len <= static_cast<uint32_t>(Token::EMPTY);
+            if (!ok) break;
+            std::vector<int32_t> tokens(len);
+            ok = std::fread(tokens.data(), sizeof(int32_t), len, f) == len;
+            s.programs.emplace_back(tokens.begin(), tokens.end());
+            s.scores.push_back(score);
+        }
+        if (!ok) break;   // 끊긴 마지막 샘플
+        out.push_back(std::move(s));
+    }
+    std::fclose(f);
+    return true;
+}
+
+// ============================================================
+// 파이프라인
+// ============================================================
+GenerationPipeline::GenerationPipeline(const PipelineConfig& config)
+    : config_(config),
+      deduper_(config.dedupe_config),
+      n_search_(search_workers(config)),
+      runs_(config.run_queue, n_search_),
+      samples_(config.sample_queue, std::max(config.encode_workers, 1)),
+      writes_(config.write_queue, 1) {
+    config_.encode_workers = std::max(config_.encode_workers, 1);
+    config_.top_k = std::max(config_.top_k, 1);
+    if (config_.starts.empty()) {
+        config_.starts.emplace_back();
+        config_.starts.back().init_level3();
+    }
+    search_config_.max_runs = config_.max_runs;
+    search_config_.seed = config_.seed;
+    search_config_.num_threads = 1;
+    search_config_.cat_policy = config_.cat_policy;
+    search_config_.crzbc_policy = config_.crzbc_policy;
+    search_config_.functions = config_.functions;
+    search_config_.rules = config_.rules;
+    probs_ = search_probs(config_.policy);
+
+    if (config_.mirror) {
+        FunctionLibrary lib;
+        if (!config_.functions.empty()) lib.load_flat(config_.functions);
+        mirror_.reset(new MapSymmetry(config_.starts.front(), lib));
+        if (!mirror_->has(Symmetry::MIRROR_LR)) mirror_.reset();
+    }
+}
+
+GenerationPipeline::~GenerationPipeline() {
+    cancel();
+    wait();
+}
+
+bool GenerationPipeline::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) return false;
+    file_ = std::fopen(config_.output_path.c_str(), "wb");
+    if (!file_) return false;
+    Header h{};
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.dim = StateVec::DIM;
+    if (std::fwrite(&h, sizeof(h), 1, file_) != 1) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    bytes_written_.store(sizeof(h), std::memory_order_relaxed);
+
+    started_ = true;
+    start_time_ = std::chrono::steady_clock::now();
+    for (int i = 0; i < n_search_; i++) threads_.emplace_back(&GenerationPipeline::search_worker, this);
+    for (int i = 0; i < config_.encode_workers; i++) threads_.emplace_back(&GenerationPipeline::encode_worker, this);
+    threads_.emplace_back(&GenerationPipeline::augment_worker, this);
+    threads_.emplace_back(&GenerationPipeline::write_worker, this);
+    return true;
+}
+
+bool GenerationPipeline::wait(double timeout_sec) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!started_) return true;
+        auto done = [this] { return finished_; };
+        if (timeout_sec < 0) {
+            done_cv_.wait(lock, done);
+        } else if (!done_cv_.wait_for(lock, std::chrono::duration<double>(timeout_sec), done)) {
+            return false;
+        }
+    }
+    join();
+    return true;
+}
+
+void GenerationPipeline::cancel() {
+    cancel_.store(true, std::memory_order_relaxed);
+}
+
+void GenerationPipeline::join() {
+    std::lock_guard<std::mutex> lock(join_mutex_);
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+PipelineReport GenerationPipeline::report() const {
+    static const char* STAGE_NAMES[NUM_STAGES] = {"search", "encode", "augment", "write"};
+    const int threads[NUM_STAGES] = {n_search_, config_.encode_workers, 1, 1};
+
+    PipelineReport r;
+    for (int s = 0; s < NUM_STAGES; s++) {
+        StageReport st;
+        st.name = STAGE_NAMES[s];
+        st.threads = threads[s];
+        st.items = counters_[s].items.load(std::memory_order_relaxed);
+        st.busy_us = counters_[s].busy_us.load(std::memory_order_relaxed);
+        st.wait_in_us = counters_[s].wait_in_us.load(std::memory_order_relaxed);
+        st.wait_out_us = counters_[s].wait_out_us.load(std::memory_order_relaxed);
+        r.stages.push_back(st);
+    }
+    auto queue = [](const char* name, const auto& q) {
+        QueueReport qr;
+        qr.name = name;
+        qr.capacity = q.capacity();
+        qr.depth = q.depth();
+        qr.high_water = q.high_water();
+        qr.pushed = q.pushed();
+        qr.full_waits = q.full_waits();
+        return qr;
+    };
+    r.queues.push_back(queue("runs", runs_));
+    r.queues.push_back(queue("samples", samples_));
+    r.queues.push_back(queue("write", writes_));
+
+    r.games_done = games_done_.load(std::memory_order_relaxed);
+    r.samples_written = samples_written_.load(std::memory_order_relaxed);
+    r.mirrored = mirrored_.load(std::memory_order_relaxed);
+    r.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    r.finished = finished_;
+    r.error = error_;
+    if (started_) {
+        const auto end = finished_ ? end_time_ : std::chrono::steady_clock::now();
+        r.elapsed_sec = std::chrono::duration<double>(end - start_time_).count();
+    }
+    return r;
+}
+
+// ============================================================
+// 단계 1: 탐색 (게임 단위로 가져감)
+// ============================================================
+void GenerationPipeline::search_worker() {
+    StageCounters& c = counters_[SEARCH];
+    Simulator real(0);
+    Simulator search(0);
+    for (Simulator* s : {&real, &search}) {
+        if (!config_.functions.empty()) s->load_functions(config_.functions);
+        s->set_rules(config_.rules);
+    }
+
+    for (;;) {
+        if (cancel_.load(std::memory_order_relaxed)) break;
+        const int64_t g = next_game_.fetch_add(1, std::memory_order_relaxed);
+        if (g >= config_.games) break;
+        const int64_t game = config_.first_game + g;
+
+        real.restore_state(config_.starts[static_cast<size_t>(game) % config_.starts.size()]);
+        real.seed(static_cast<uint32_t>(game_seed(config_.seed, game)));
+        std::mt19937_64 rng(search_seed(config_.seed, game));
+
+        int runs = 0;
+        for (int run = 0; run < config_.max_runs; run++) {
+            if (cancel_.load(std::memory_order_relaxed)) break;
+            RunItem item;
+            item.state = real.get_state();
+            if (item.state.win_sign || item.state.lose_sign) break;
+
+            const auto t0 = std::chrono::steady_clock::now();
+            SearchResult found = search_run(search, item.state, config_.policy, search_config_, probs_, rng);
+            const uint64_t search_us = since_us(t0);
+
+            std::vector<int> program = found.programs.front();
+            program.erase(std::remove(program.begin(), program.end(), Token::END), program.end());
+            real.execute_program(program, config_.cat_policy, config_.crzbc_policy);
+
+            const GameState& before = item.state;
+            const GameState after = real.get_state();
+            int sc_before, bc_before, sc_after, bc_after;
+            count_cheese(before, sc_before, bc_before);
+            count_cheese(after, sc_after, bc_after);
+            stats_.record_run(run, after.score - before.score, sc_before - sc_after, bc_before - bc_after,
+                              std::max(0, before.life - after.life), search_us, after.win_sign);
+
+            const size_t k = std::min(found.programs.size(), static_cast<size_t>(config_.top_k));
+            item.game = game;
+            item.run = run;
+            item.programs.assign(std::make_move_iterator(found.programs.begin()),
+                                 std::make_move_iterator(found.programs.begin() + k));
+            item.scores.assign(found.scores.begin(), found.scores.begin() + k);
+            runs++;
+
+            c.busy_us.fetch_add(since_us(t0), std::memory_order_relaxed);
+            c.items.fetch_add(1, std::memory_order_relaxed);
+            uint64_t wait_out = 0;
+            runs_.push(std::move(item), wait_out);
+            c.wait_out_us.fetch_add(wait_out, std::memory_order_relaxed);
+        }
+
+        const GameState final_state = real.get_state();
+        stats_.record_game(final_state.score, final_state.win_sign, runs);
+        games_done_.fetch_add(1, std::memory_order_relaxed);
+    }
+    runs_.producer_done();
+}
+
+// ============================================================
+// 단계 2: 관측 인코딩
+// ============================================================
+void GenerationPipeline::encode_worker() {
+    StageCounters& c = counters_[ENCODE];
+    RunItem item;
+    uint64_t wait_in = 0;
+    while (runs_.pop(item, wait_in)) {
+        c.wait_in_us.fetch_add(wait_in, std::memory_order_relaxed);
+        wait_in = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+
+        PipelineSample s;
+        s.game = item.game;
+        s.run = item.run;
+        s.state_vec.resize(StateVec::DIM);
+        encode_state_vector(item.state, s.state_vec.data());
+        s.programs = std::move(item.programs);
+        s.scores = std::move(item.scores);
+
+        c.busy_us.fetch_add(since_us(t0), std::memory_order_relaxed);
+        c.items.fetch_add(1, std::memory_order_relaxed);
+        uint64_t wait_out = 0;
+        samples_.push(std::move(s), wait_out);
+        c.wait_out_us.fetch_add(wait_out, std::memory_order_relaxed);
+    }
+    c.wait_in_us.fetch_add(wait_in, std::memory_order_relaxed);
+    samples_.producer_done();
+}
+
+// ============================================================
+// 단계 3: 좌우 대칭 증강 / 중복 제거
+// 중복 제거는 입력이 끝나야 그룹이 확정되므로 대표 샘플만 보관했다가 마지막에 내보냄
+// (중복 샘플은 deduper에 합친 뒤 바로 버림 → 메모리는 그룹 수에 비례)
+// ============================================================
+void GenerationPipeline::augment_worker() {
+    StageCounters& c = counters_[AUGMENT];
+    std::vector<PipelineSample> kept;      // 중복 제거: 그룹 대표 (생성 순 = groups() 순서)
+    std::vector<uint8_t> created;
+    uint64_t wait_out = 0;
+
+    auto emit = [&](PipelineSample&& s) {
+        if (config_.dedupe) {
+            deduper_.add(s.state_vec.data(), 1, {s.programs}, {s.scores}, 1, &created);
+            if (!created[0]) return;
+            s.programs.clear();
+            s.scores.clear();
+            kept.push_back(std::move(s));
+        } else {
+            writes_.push(std::move(s), wait_out);
+        }
+    };
+
+    PipelineSample s;
+    uint64_t wait_in = 0;
+    while (samples_.pop(s, wait_in)) {
+        c.wait_in_us.fetch_add(wait_in, std::memory_order_relaxed);
+        wait_in = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+
+        if (mirror_) {
+            // 변환 불가 프로그램은 제외, 남는 프로그램이 없으면 증강 샘플 없음
+            PipelineSample m;
+            m.game = s.game;
+            m.run = s.run;
+            m.mirrored = true;
+            for (size_t k = 0; k < s.programs.size(); k++) {
+                std::vector<int> out;
+                if (!mirror_->transform_program(s.programs[k], Symmetry::MIRROR_LR, out)) continue;
+                m.programs.push_back(std::move(out));
+                m.scores.push_back(s.scores[k]);
+            }
+            if (!m.programs.empty()) {
+                m.state_vec.resize(StateVec::DIM);
+                MapSymmetry::transform_state_vectors(s.state_vec.data(), m.state_vec.data(), 1,
+                                                     Symmetry::MIRROR_LR);
+                emit(std::move(s));
+                emit(std::move(m));
+                mirrored_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                emit(std::move(s));
+            }
+        } else {
+            emit(std::move(s));
+        }
+
+        c.busy_us.fetch_add(since_us(t0), std::memory_order_relaxed);
+        c.items.fetch_add(1, std::memory_order_relaxed);
+        c.wait_out_us.fetch_add(wait_out, std::memory_order_relaxed);
+        wait_out = 0;
+    }
+    c.wait_in_us.fetch_add(wait_in, std::memory_order_relaxed);
+
+    if (config_.dedupe) {
+        // 대표 순번 오름차순 = 대표를 보관한 순서
+        std::vector<SampleDeduper::Group> groups = deduper_.groups();
+        for (size_t k = 0; k < groups.size(); k++) {
+            SampleDeduper::Group& g = groups[k];
+            PipelineSample& rep = kept[k];
+            rep.count = g.count;
+            rep.programs = std::move(g.programs);
+            rep.scores = std::move(g.scores);
+            writes_.push(std::move(rep), wait_out);
+        }
+        kept.clear();
+        c.wait_out_us.fetch_add(wait_out, std::memory_order_relaxed);
+    }
+    writes_.producer_done();
+}
+
+// ============================================================
+// 단계 4: 샤드 기록 (버퍼가 write_buffer만큼 차면 쓰기, 끝에 fsync)
+// ============================================================
+void GenerationPipeline::write_worker() {
+    StageCounters& c = counters_[WRITE];
+    std::string buf;
+    buf.reserve(config_.write_buffer + 64 * 1024);
+    bool ok = true;
+
+    auto flush = [&]() {
+        if (ok && !buf.empty()) {
+            ok = std::fwrite(buf.data(), 1, buf.size(), file_) == buf.size();
+            if (ok) bytes_written_.fetch_add(buf.size(), std::memory_order_relaxed);
+        }
+        buf.clear();
+    };
+
+    PipelineSample s;
+    uint64_t wait_in = 0;
+    while (writes_.pop(s, wait_in)) {
+        c.wait_in_us.fetch_add(wait_in, std::memory_order_relaxed);
+        wait_in = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+
+        append_sample(buf, s);
+        if (buf.size() >= config_.write_buffer) flush();
+        samples_written_.fetch_add(1, std::memory_order_relaxed);
+
+        c.busy_us.fetch_add(since_us(t0), std::memory_order_relaxed);
+        c.items.fetch_add(1, std::memory_order_relaxed);
+    }
+    c.wait_in_us.fetch_add(wait_in, std::memory_order_relaxed);
+
+    flush();
+    ok = ok && std::fflush(file_) == 0 && ::fsync(fileno(file_)) == 0;
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok) error_ = "failed to write " + config_.output_path;
+    end_time_ = std::chrono::steady_clock::now();
+    finished_ = true;
+    done_cv_.notify_all();
+}
+
+} // namespace simulator
@@ -0,0 +1,190 @@
+#include "program_generator.hpp"
+#include "function_library.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+namespace {
+
+inline uint64_t mix_seed(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 프로그램 하나용 SplitMix64
+struct ProgramRng {
+    uint64_t s;
+
+    uint64_t next() {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+    float unit() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+};
+
+// 가중치 배열에서 하나 (합이 0이면 균등)
+int pick(const std::vector<float>& weights, ProgramRng& rng) {
+    float total = 0.0f;
+    for (float w : weights) total += w;
+    const int n = static_cast<int>(weights.size());
+    if (total <= 0.0f) return static_cast<int>(rng.below(static_cast<uint32_t>(n)));
+    float r = rng.unit() * total;
+    for (int k = 0; k < n; k++) {
+        if (r < weights[k]) return k;
+        r -= weights[k];
+    }
+    // 반올림 오차: 마지막 양수 가중치
+    for (int k = n - 1; k > 0; k--) {
+        if (weights[k] > 0.0f) return k;
+    }
+    return 0;
+}
+
+} // namespace
+
+ProgramGenerator::ProgramGenerator(const ProgramGenConfig& config) : config_(config) {
+    ProgramGenConfig& c = config_;
+    c.max_tokens = std::max(c.max_tokens, 1);
+    c.min_tokens = std::min(std::max(c.min_tokens, 0), c.max_tokens);
+    c.direction_weights.resize(Direction::COUNT, 0.0f);
+    c.loop_count_weights.resize(10, 0.0f);
+    c.if_count_weights.resize(Token::NUM_7 - Token::NUM_BASE, 0.0f);
+
+    FunctionLibrary lib;
+    if (!c.functions.empty()) lib.load_flat(c.functions);
+    library_ok_ = ProgramGrammar::library_mask(lib);
+    for (int id = Token::FUNC_LIB_START; id <= Token::FUNC_LIB_END; id++) {
+        if (library_ok_[id]) library_ids_.push_back(id);
+    }
+}
+
+// ============================================================
+// 프로그램 하나 생성 (슬롯마다 허용된 토큰 중 가중치로 선택)
+// ============================================================
+int ProgramGenerator::generate_one(uint64_t index, int* out) const {
+    const ProgramGenConfig& c = config_;
+    ProgramRng rng{mix_seed(c.seed, index)};
+    ProgramGrammar grammar(c.max_tokens, library_ok_.data(), c.max_func_calls);
+    int func1 = -1, func2 = -1;
+    int n = 0;
+
+    while (!grammar.done()) {
+        int token = Token::END;
+        switch (grammar.slot()) {
+            case ProgramGrammar::UNIT: {
+                // 라이브러리 후보: 서로 다른 ID 두 개를 다 썼으면 그 둘 중에서
+                int func = -1;
+                if (!library_ids_.empty()) {
+                    if (func1 >= 0 && func2 >= 0) func = rng.below(2) ? func2 : func1;
+                    else func = library_ids_[rng.below(static_cast<uint32_t>(library_ids_.size()))];
+                }
+                const float w[5] = {
+                    grammar.allows(Token::DIR_UP) ? c.direction_weight : 0.0f,
+                    grammar.allows(Token::LOOP) ? c.loop_weight : 0.0f,
+                    grammar.allows(Token::IF) ? c.if_weight : 0.0f,
+                    func >= 0 && grammar.allows(func) ? c.function_weight : 0.0f,
+                    grammar.length() >= c.min_tokens ? c.end_weight : 0.0f,
+                };
+                const float total = w[0] + w[1] + w[2] + w[3] + w[4];
+                int kind = 4;   // 고를 수 있는 게 없으면 END
+                if (total > 0.0f) {
+                    float r = rng.unit() * total;
+                    for (kind = 0; kind < 4; kind++) {
+                        if (r < w[kind]) break;
+                        r -= w[kind];
+                    }
+                    while (w[kind] <= 0.0f && kind > 0) kind--;   // 반올림 오차
+                }
+                if (kind == 0) token = pick(c.direction_weights, rng);
+                else if (kind == 1) token = Token::LOOP;
+                else if (kind == 2) token = Token::IF;
+                else if (kind == 3) {
+                    token = func;
+                    if (func1 < 0) func1 = func;
+                    else if (func != func1 && func2 < 0) func2 = func;
+                }
+                break;
+            }
+            case ProgramGrammar::LOOP_NUM:
+                token = Token::NUM_BASE + pick(c.loop_count_weights, rng);
+                break;
+            case ProgramGrammar::IF_NUM:
+                token = Token::NUM_1 + pick(c.if_count_weights, rng);
+                break;
+            default:
+                token = pick(c.direction_weights, rng);
+                break;
+        }
+        grammar.push(token);
+        out[n++] = token;
+    }
+    return n;
+}
+
+std::vector<int> ProgramGenerator::generate_one(uint64_t index) const {
+    std::vector<int> program(static_cast<size_t>(row_width()));
+    program.resize(static_cast<size_t>(generate_one(index, program.data())));
+    return program;
+}
+
+// ============================================================
+// 배치 생성 (OpenMP 병렬)
+// ============================================================
+void ProgramGenerator::generate_padded(uint64_t first, size_t n, int* out) const {
+    const int64_t count = static_cast<int64_t>(n);
+    const int width = row_width();
+
+#ifdef USE_OPENMP
+    int num_threads = config_.num_threads;
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int64_t i = 0; i < count; i++) {
+        int* row = out + i * width;
+        const int len = generate_one(first + static_cast<uint64_t>(i), row);
+        std::fill(row + len, row + width, Token::EMPTY);
+    }
+#else
+    // 시리얼 버전
+    for (int64_t i = 0; i < count; i++) {
+        int* row = out + i * width;
+        const int len = generate_one(first + static_cast<uint64_t>(i), row);
+        std::fill(row + len, row + width, Token::EMPTY);
+    }
+#endif
+}
+
+void ProgramGenerator::generate_flat(uint64_t first, size_t n, std::vector<int>& tokens,
+                                     std::vector<int64_t>& offsets) const {
+    const size_t width = static_cast<size_t>(row_width());
+    std::vector<int> padded(n * width);
+    generate_padded(first, n, padded.data());
+
+    // 행 길이 → offsets, 그다음 END까지 복사
+    offsets.assign(n + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        const int* row = padded.data() + i * width;
+        size_t len = 0;
+        while (len < width && row[len] != Token::EMPTY) len++;
+        offsets[i + 1] = offsets[i] + static_cast<int64_t>(len);
+    }
+    tokens.resize(static_cast<size_t>(offsets[n]));
+    for (size_t i = 0; i < n; i++) {
+        std::memcpy(tokens.data() + offsets[i], padded.data() + i * width,
+                    static_cast<size_t>(offsets[i + 1] - offsets[i]) * sizeof(int));
+    }
+}
+
+} // namespace simulator
@@ -0,0 +1,84 @@
+#include "program_registry.hpp"
+#include <mutex>
+
+namespace simulator {
+
+size_t ProgramRegistry::TokenHash::operator()(const std::vector<int>& v) const {
+    // FNV-1a (토큰 단위)
+    uint64_t h = 1469598103934665603ULL;
+    for (int t : v) {
+        h ^= static_cast<uint32_t>(t);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(h);
+}
+
+ProgramRegistry::ProgramRegistry(const std::vector<int>& functions) : compiler_(0) {
+    if (!functions.empty()) compiler_.load_functions(functions);
+}
+
+// ============================================================
+// 인턴: 공유 잠금으로 조회, 없으면 잠금 밖에서 컴파일 후 배타 잠금으로 등록
+// (동시에 같은 프로그램이 들어오면 먼저 등록한 핸들 사용)
+// ============================================================
+int32_t ProgramRegistry::intern(const int* tokens, size_t n) {
+    size_t len = 0;
+    while (len < n && tokens[len] != Token::END) len++;
+    if (len < n) len++;   // END 포함
+    std::vector<int> key(tokens, tokens + len);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->compiled = compiler_.compile_program(key);
+    entry->tokens = key;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto inserted = index_.emplace(std::move(key), static_cast<int32_t>(entries_.size()));
+    if (!inserted.second) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return inserted.first->second;
+    }
+    entries_.push_back(std::move(entry));
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return inserted.first->second;
+}
+
+bool ProgramRegistry::valid(int32_t handle) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return handle >= 0 && static_cast<size_t>(handle) < entries_.size();
+}
+
+const std::vector<int>& ProgramRegistry::tokens(int32_t handle) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_[handle]->tokens;
+}
+
+const CompiledProgram& ProgramRegistry::compiled(int32_t handle) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_[handle]->compiled;
+}
+
+std::vector<const CompiledProgram*> ProgramRegistry::resolve(const int32_t* handles, size_t n) const {
+    std::vector<const CompiledProgram*> out(n);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (size_t i = 0; i < n; i++) {
+        if (handles[i] < 0 || static_cast<size_t>(handles[i]) >= entries_.size()) return {};
+        out[i] = &entries_[handles[i]]->compiled;
+    }
+    return out;
+}
+
+size_t ProgramRegistry::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_.size();
+}
+
+} // namespace simulator
@@ -0,0 +1,257 @@
+#include "run_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace simulator {
+
+namespace {
+
+// 전역 카운터
+enum Global : size_t {
+    GAMES = 0,
+    WINS,
+    SCORE_SUM,
+    SCORE_SQ_SUM,
+    RUNS_SUM,
+    WIN_RUNS_SUM,
+    SEARCH_COUNT,
+    SEARCH_US_SUM,
+    NUM_GLOBAL,
+};
+
+// 런 순번별 카운터
+enum PerRun : size_t {
+    RUNS = 0,
+    DELTA_SUM,
+    SMALL_CHEESE,
+    BIG_CHEESE,
+    CATCHES,
+    WINS_AT,
+    NUM_PER_RUN,
+};
+
+constexpr char MAGIC[4] = {'M', 'A', 'R', 'S'};
+constexpr uint32_t VERSION = 1;
+
+// 직렬화 헤더 (설정 + 카운터 수)
+struct BlobHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t config[7];
+    uint32_t reserved;
+    uint64_t n_counters;
+};
+static_assert(sizeof(BlobHeader) == 48, "stats blob header must be packed");
+
+void pack_config(const StatsConfig& c, int32_t* out) {
+    const int32_t v[7] = {c.score_min, c.score_max, c.score_bin, c.delta_min, c.delta_max, c.delta_bin, c.max_runs};
+    std::memcpy(out, v, sizeof(v));
+}
+
+int bins(int lo, int hi, int width) {
+    return std::max(1, (hi - lo + width - 1) / width) + 2;
+}
+
+// 마이크로초 → 로그-선형 구간
+int search_bucket(uint64_t us) {
+    using namespace SearchTimeBuckets;
+    if (us < SUB) return static_cast<int>(us);
+    const int octave = 63 - __builtin_clzll(us);          // us >= 8 → octave >= 3
+    const int sub = static_cast<int>((us >> (octave - 3)) & (SUB - 1));
+    return std::min((octave - 2) * SUB + sub, COUNT - 1);
+}
+
+// 구간 하한 (마이크로초)
+double search_bucket_low(int b) {
+    using namespace SearchTimeBuckets;
+    if (b < SUB) return b;
+    const int octave = b / SUB + 2;
+    const int sub = b % SUB;
+    return std::ldexp(static_cast<double>(SUB + sub), octave - 3);
+}
+
+} // namespace
+
+// ============================================================
+// 스냅샷
+// ============================================================
+double StatsSnapshot::search_percentile(double q) const {
+    if (search_count == 0) return 0.0;
+    const double target = std::min(std::max(q, 0.0), 1.0) * search_count;
+    double acc = 0.0;
+    for (size_t b = 0; b < search_hist.size(); b++) {
+        if (search_hist[b] == 0) continue;
+        if (acc + search_hist[b] >= target) {
+            const double lo = search_bucket_low(static_cast<int>(b));
+            const double hi = search_bucket_low(static_cast<int>(b) + 1);
+            return lo + (hi - lo) * (target - acc) / search_hist[b];
+        }
+        acc += search_hist[b];
+    }
+    return search_bucket_low(static_cast<int>(search_hist.size()));
+}
+
+double StatsSnapshot::score_std() const {
+    if (games < 2) return 0.0;
+    const double mean = score_mean();
+    const double var = (score_sq_sum - games * mean * mean) / (games - 1);
+    return std::sqrt(std::max(0.0, var));
+}
+
+std::vector<int> StatsSnapshot::score_edges() const {
+    std::vector<int> e;
+    for (size_t i = 0; i + 1 < score_hist.size(); i++) e.push_back(config.score_min + static_cast<int>(i) * config.score_bin);
+    return e;
+}
+
+std::vector<int> StatsSnapshot::delta_edges() const {
+    std::vector<int> e;
+    const size_t n = delta_hist.empty() ? 0 : delta_hist[0].size();
+    for (size_t i = 0; i + 1 < n; i++) e.push_back(config.delta_min + static_cast<int>(i) * config.delta_bin);
+    return e;
+}
+
+// ============================================================
+// 누적기
+// ============================================================
+RunStats::RunStats(const StatsConfig& config) : config_(config) {
+    config_.score_bin = std::max(config_.score_bin, 1);
+    config_.delta_bin = std::max(config_.delta_bin, 1);
+    config_.score_max = std::max(config_.score_max, config_.score_min + 1);
+    config_.delta_max = std::max(config_.delta_max, config_.delta_min + 1);
+    config_.max_runs = std::max(config_.max_runs, 1);
+
+    n_score_ = bins(config_.score_min, config_.score_max, config_.score_bin);
+    n_delta_ = bins(config_.delta_min, config_.delta_max, config_.delta_bin);
+    n_runs_ = config_.max_runs;
+
+    off_score_hist_ = NUM_GLOBAL;
+    off_per_run_ = off_score_hist_ + n_score_;
+    off_delta_hist_ = off_per_run_ + static_cast<size_t>(n_runs_) * NUM_PER_RUN;
+    off_search_hist_ = off_delta_hist_ + static_cast<size_t>(n_runs_) * n_delta_;
+    n_counters_ = off_search_hist_ + SearchTimeBuckets::COUNT;
+
+    counters_.reset(new std::atomic<int64_t>[n_counters_]);
+    reset();
+}
+
+void RunStats::reset() {
+    for (size_t i = 0; i < n_counters_; i++) counters_[i].store(0, std::memory_order_relaxed);
+}
+
+int RunStats::bucket(int value, int lo, int hi, int width, int n) {
+    if (value < lo) return 0;
+    if (value >= hi) return n - 1;
+    return std::min(1 + (value - lo) / width, n - 2);
+}
+
+void RunStats::record_run(int run, int score_delta, int small_cheese, int big_cheese, int catches,
+                          uint64_t search_us, bool won) {
+    const size_t r = static_cast<size_t>(std::min(std::max(run, 0), n_runs_ - 1));
+    const size_t base = off_per_run_ + r * NUM_PER_RUN;
+    add(base + RUNS, 1);
+    add(base + DELTA_SUM, score_delta);
+    add(base + SMALL_CHEESE, small_cheese);
+    add(base + BIG_CHEESE, big_cheese);
+    add(base + CATCHES, catches);
+    if (won) add(base + WINS_AT, 1);
+    add(off_delta_hist_ + r * n_delta_ +
+        bucket(score_delta, config_.delta_min, config_.delta_max, config_.delta_bin, n_delta_), 1);
+
+    add(SEARCH_COUNT, 1);
+    add(SEARCH_US_SUM, static_cast<int64_t>(search_us));
+    add(off_search_hist_ + search_bucket(search_us), 1);
+}
+
+void RunStats::record_game(int final_score, bool won, int runs) {
+    add(GAMES, 1);
+    add(SCORE_SUM, final_score);
+    add(SCORE_SQ_SUM, static_cast<int64_t>(final_score) * final_score);
+    add(RUNS_SUM, runs);
+    if (won) {
+        add(WINS, 1);
+        add(WIN_RUNS_SUM, runs);
+    }
+    add(off_score_hist_ + bucket(final_score, config_.score_min, config_.score_max, config_.score_bin, n_score_), 1);
+}
+
+StatsSnapshot RunStats::snapshot() const {
+    std::vector<int64_t> v(n_counters_);
+    for (size_t i = 0; i < n_counters_; i++) v[i] = at(i).load(std::memory_order_relaxed);
+
+    StatsSnapshot s;
+    s.config = config_;
+    s.games = v[GAMES];
+    s.wins = v[WINS];
+    s.score_sum = v[SCORE_SUM];
+    s.score_sq_sum = static_cast<double>(v[SCORE_SQ_SUM]);
+    s.runs_sum = v[RUNS_SUM];
+    s.win_runs_sum = v[WIN_RUNS_SUM];
+    s.search_count = v[SEARCH_COUNT];
+    s.search_us_sum = v[SEARCH_US_SUM];
+    s.score_hist.assign(v.begin() + off_score_hist_, v.begin() + off_score_hist_ + n_score_);
+
+    for (int r = 0; r < n_runs_; r++) {
+        const size_t base = off_per_run_ + static_cast<size_t>(r) * NUM_PER_RUN;
+        s.runs.push_back(v[base + RUNS]);
+        s.delta_sum.push_back(v[base + DELTA_SUM]);
+        s.small_cheese.push_back(v[base + SMALL_CHEESE]);
+        s.big_cheese.push_back(v[base + BIG_CHEESE]);
+        s.catches.push_back(v[base + CATCHES]);
+        s.wins_at.push_back(v[base + WINS_AT]);
+        const size_t h = off_delta_hist_ + static_cast<size_t>(r) * n_delta_;
+        s.delta_hist.emplace_back(v.begin() + h, v.begin() + h + n_delta_);
+    }
+    s.search_hist.assign(v.begin() + off_search_hist_, v.begin() + off_search_hist_ + SearchTimeBuckets::COUNT);
+    return s;
+}
+
+// ============================================================
+// 합치기 / 직렬화
+// ============================================================
+bool RunStats::merge(const RunStats& other) {
+    int32_t a[7], b[7];
+    pack_config(config_, a);
+    pack_config(other.config_, b);
+    if (other.n_counters_ != n_counters_ || std::memcmp(a, b, sizeof(a)) != 0) return false;
+    for (size_t i = 0; i < n_counters_; i++) add(i, other.at(i).load(std::memory_order_relaxed));
+    return true;
+}
+
+std::string RunStats::serialize() const {
+    BlobHeader h{};
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    pack_config(config_, h.config);
+    h.n_counters = n_counters_;
+
+    std::string blob(sizeof(h) + n_counters_ * sizeof(int64_t), '\0');
+    std::memcpy(&blob[0], &h, sizeof(h));
+    for (size_t i = 0; i < n_counters_; i++) {
+        const int64_t v = at(i).load(std::memory_order_relaxed);
+        std::memcpy(&blob[sizeof(h) + i * sizeof(int64_t)], &v, sizeof(v));
+    }
+    return blob;
+}
+
+bool RunStats::merge_serialized(const std::string& blob) {
+    if (blob.size() < sizeof(BlobHeader)) return false;
+    BlobHeader h;
+    std::memcpy(&h, blob.data(), sizeof(h));
+    int32_t mine[7];
+    pack_config(config_, mine);
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION ||
+        std::memcmp(h.config, mine, sizeof(mine)) != 0 || h.n_counters != n_counters_ ||
+        blob.size() != sizeof(h) + n_counters_ * sizeof(int64_t)) {
+        return false;
+    }
+    for (size_t i = 0; i < n_counters_; i++) {
+        int64_t v;
+        std::memcpy(&v, blob.data() + sizeof(h) + i * sizeof(int64_t), sizeof(v));
+        add(i, v);
+    }
+    return true;
+}
+
+} // namespace simulator
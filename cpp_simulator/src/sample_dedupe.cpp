@@ -0,0 +1,193 @@
+#include "sample_dedupe.hpp"
+#include <algorithm>
+#include <cmath>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+namespace {
+
+struct KeyHash {
+    uint64_t h = 0xCBF29CE484222325ULL;
+
+    void value(int32_t v) {
+        uint32_t u = static_cast<uint32_t>(v);
+        for (int k = 0; k < 4; k++) {
+            h ^= (u >> (8 * k)) & 0xFF;
+            h *= 0x100000001B3ULL;
+        }
+    }
+    // 마지막 섞기 (스트라이프 선택에 하위 비트 사용)
+    uint64_t finish() const {
+        uint64_t z = h;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+inline int32_t quantize(float v, double scale) {
+    return static_cast<int32_t>(std::lround(v * scale));
+}
+
+// bucket: 0 = 무시, 1 = 정확히, k = 내림 구간
+inline int32_t bucket(int32_t v, int b) {
+    if (b <= 0) return 0;
+    if (b == 1) return v;
+    return v >= 0 ? v / b : -((-v + b - 1) / b);
+}
+
+} // namespace
+
+// ============================================================
+// 샘플 키
+// ============================================================
+uint64_t sample_key(const float* v, const DedupeConfig& config) {
+    KeyHash k;
+
+    // 그리드 (sc는 DYNAMIC_SCALE 배)
+    for (int i = 0; i < StateVec::MOUSE_OFFSET; i++) k.value(quantize(v[i], 1.0));
+    k.value(quantize(v[StateVec::MOUSE_OFFSET], 1.0));
+    k.value(quantize(v[StateVec::MOUSE_OFFSET + 1], 1.0));
+    if (config.entities) {
+        for (int i = StateVec::CAT_OFFSET; i < StateVec::MOUSE_OFFSET + 2 * StateVec::NUM_POSITIONS; i++) {
+            k.value(quantize(v[i], 1.0));
+        }
+    }
+
+    // 스칼라 (game_worker.get_state_vector_list 스케일의 역변환)
+    const float* s = v + StateVec::SCALAR_OFFSET;
+    const double inv = 1.0 / StateVec::DYNAMIC_SCALE;
+    k.value(bucket(quantize(s[0], 1000.0 * inv), config.score_bucket));
+    k.value(quantize(s[1], Config::DEFAULT_LIFE * inv));
+    k.value(quantize(s[2], 20.0 * inv));
+    k.value(s[3] > 0.0f ? 1 : 0);
+    k.value(s[4] > 0.0f ? 1 : 0);
+    k.value(bucket(quantize(s[5], Config::DEFAULT_STEP_LIMIT * inv), config.step_bucket));
+    return k.finish();
+}
+
+// ============================================================
+// 중복 제거 집합
+// ============================================================
+SampleDeduper::SampleDeduper(const DedupeConfig& config, int num_stripes) : config_(config) {
+    stripes_.resize(std::max(1, num_stripes));
+    for (auto& s : stripes_) s.reset(new Stripe());
+}
+
+void SampleDeduper::merge(Entry& e, int64_t index, const std::vector<std::vector<int>>& programs,
+                          const std::vector<float>& scores) {
+    e.count++;
+    e.index = std::min(e.index, index);
+    for (size_t k = 0; k < programs.size() && k < scores.size(); k++) {
+        auto it = std::find_if(e.candidates.begin(), e.candidates.end(),
+                               [&](const Candidate& c) { return c.program == programs[k]; });
+        if (it == e.candidates.end()) {
+            e.candidates.push_back(Candidate{programs[k], scores[k], 1, index});
+        } else {
+            it->sum += scores[k];
+            it->count++;
+            it->first = std::min(it->first, index);
+        }
+    }
+}
+
+std::vector<uint64_t> SampleDeduper::add(const float* vecs, size_t n,
+                                         const std::vector<std::vector<std::vector<int>>>& programs,
+                                         const std::vector<std::vector<float>>& scores,
+                                         int num_threads, std::vector<uint8_t>* created) {
+    std::vector<uint64_t> keys(n);
+    if (created) created->assign(n, 0);
+    const int64_t base = next_index_;
+    const int64_t count = static_cast<int64_t>(n);
+    const size_t n_stripes = stripes_.size();
+
+    auto insert = [&](int64_t i) {
+        const uint64_t key = sample_key(vecs + i * StateVec::DIM, config_);
+        keys[i] = key;
+        Stripe& stripe = *stripes_[key % n_stripes];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        // 그룹보다 먼저 세므로 stats에서 unique > samples가 되지 않음
+        samples_.fetch_add(1, std::memory_order_relaxed);
+        auto ins = stripe.entries.emplace(key, Entry{base + i, 0, {}});
+        if (created && ins.second) (*created)[i] = 1;
+        merge(ins.first->second, base + i, programs[i], scores[i]);
+    };
+
+#ifdef USE_OPENMP
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+    for (int64_t i = 0; i < count; i++) {
+        insert(i);
+    }
+#else
+    // 시리얼 버전
+    (void)num_threads;
+    for (int64_t i = 0; i < count; i++) {
+        insert(i);
+    }
+#endif
+
+    next_index_ += count;
+    return keys;
+}
+
+std::vector<SampleDeduper::Group> SampleDeduper::groups() const {
+    std::vector<Group> out;
+    for (const auto& stripe : stripes_) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        for (const auto& kv : stripe->entries) {
+            const Entry& e = kv.second;
+            std::vector<const Candidate*> ranked;
+            for (const Candidate& c : e.candidates) ranked.push_back(&c);
+            std::sort(ranked.begin(), ranked.end(), [](const Candidate* a, const Candidate* b) {
+                double ma = a->sum / a->count;
+                double mb = b->sum / b->count;
+                if (ma != mb) return ma > mb;
+                if (a->count != b->count) return a->count > b->count;
+                return a->first < b->first;
+            });
+
+            Group g{kv.first, e.index, e.count, {}, {}, {}};
+            const size_t k = std::min(ranked.size(), static_cast<size_t>(std::max(config_.top_k, 0)));
+            for (size_t i = 0; i < k; i++) {
+                g.programs.push_back(ranked[i]->program);
+                g.scores.push_back(static_cast<float>(ranked[i]->sum / ranked[i]->count));
+                g.counts.push_back(ranked[i]->count);
+            }
+            out.push_back(std::move(g));
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Group& a, const Group& b) { return a.index < b.index; });
+    return out;
+}
+
+SampleDeduper::Stats SampleDeduper::stats() const {
+    Stats s;
+    for (const auto& stripe : stripes_) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        s.unique += stripe->entries.size();
+    }
+    // 그룹을 센 뒤에 읽음: 본 그룹의 샘플은 이미 samples_에 들어 있음
+    s.samples = samples_.load(std::memory_order_relaxed);
+    s.duplicates = s.samples > s.unique ? s.samples - s.unique : 0;
+    s.ratio = s.samples > 0 ? static_cast<double>(s.duplicates) / s.samples : 0.0;
+    return s;
+}
+
+void SampleDeduper::clear() {
+    for (auto& stripe : stripes_) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        stripe->entries.clear();
+    }
+    next_index_ = 0;
+    samples_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace simulator
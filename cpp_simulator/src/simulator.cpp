@@ -1,6 +1,13 @@
 #include "simulator.hpp"
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
 #include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef DEBUG_IF
 #include <iostream>
@@ -14,6 +21,11 @@ namespace simulator {
 
 // 정적 멤버 정의
 bool Simulator::global_cache_enabled_ = false;
+std::atomic<bool> Simulator::collision_cert_enabled_{true};
+std::atomic<uint64_t> Simulator::cert_steps_{0};
+std::atomic<uint64_t> Simulator::cert_windows_{0};
+std::atomic<uint64_t> Simulator::cert_cat_skipped_{0};
+std::atomic<uint64_t> Simulator::cert_crzbc_skipped_{0};
 
 // ============================================================
 // 생성자
@@ -28,10 +40,27 @@ void Simulator::reset() {
     } else {
         state_.reset();
     }
+    journal_epoch_++;
+    refresh_topology();
 }
 
 void Simulator::restore_state(const GameState& state) {
     state_ = state;
+    journal_epoch_++;
+    refresh_topology();
+}
+
+void Simulator::refresh_topology() {
+    if (topology_ &&
+        std::memcmp(&topology_->wall, &state_.wall, sizeof(GridMap)) == 0 &&
+        std::memcmp(&topology_->junc, &state_.junc, sizeof(GridMap)) == 0) {
+        return;
+    }
+    // 공유 중인 테이블은 건드리지 않고 새로 만들어 교체
+    auto topology = std::make_shared<MapTopology>();
+    topology->build(state_.wall, state_.junc);
+    topology_ = std::move(topology);
+    mouse_fields_.ready.clear();
 }
 
 // ============================================================
@@ -82,6 +111,7 @@ void GlobalDistanceCache::initialize(
 ) {
     // 121개 위치에 대한 거리 맵을 사전 계산
     cache_.resize(MAP_SIZE * MAP_SIZE);
+    next_hop_.resize(MAP_SIZE * MAP_SIZE);
 
     #ifdef USE_OPENMP
     #pragma omp parallel for schedule(static)
@@ -90,16 +120,127 @@ void GlobalDistanceCache::initialize(
         int row = pos / MAP_SIZE;
         int col = pos % MAP_SIZE;
         cache_[pos] = compute_distance_map(wall, row, col);
+        compute_next_hop(cache_[pos], next_hop_[pos]);
     }
 
+    if (mapped_) ::munmap(mapped_, mapped_bytes_);
+    mapped_ = nullptr;
+    mapped_bytes_ = 0;
+    wall_ = wall;
+    maps_ = cache_.data();
+    hops_ = next_hop_.data();
     initialized_ = true;
 }
 
+void GlobalDistanceCache::clear() {
+    initialized_ = false;
+    maps_ = nullptr;
+    hops_ = nullptr;
+    if (mapped_) ::munmap(mapped_, mapped_bytes_);
+    mapped_ = nullptr;
+    mapped_bytes_ = 0;
+    cache_.clear();
+    next_hop_.clear();
+}
+
+// ============================================================
+// 캐시 파일 (프로세스 간 공유)
+// ============================================================
+namespace {
+
+constexpr size_t DISTANCE_CACHE_BYTES = sizeof(DistanceCacheFormat::Header) +
+                                        TOTAL_CELLS * (sizeof(DistanceMap) + sizeof(NextHopMap));
+
+uint64_t fnv1a(const void* data, size_t n, uint64_t h = 0xCBF29CE484222325ULL) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+uint64_t cache_checksum(const void* wall, const DistanceMap* maps, const NextHopMap* hops) {
+    uint64_t h = fnv1a(wall, TOTAL_CELLS);
+    h = fnv1a(maps, TOTAL_CELLS * sizeof(DistanceMap), h);
+    return fnv1a(hops, TOTAL_CELLS * sizeof(NextHopMap), h);
+}
+
+} // namespace
+
+bool GlobalDistanceCache::save(const std::string& path) const {
+    using namespace DistanceCacheFormat;
+    if (!initialized_) return false;
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.cells = TOTAL_CELLS;
+    std::memcpy(header.wall, &wall_, sizeof(header.wall));
+    header.checksum = cache_checksum(header.wall, maps_, hops_);
+
+    const std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && std::fwrite(maps_, sizeof(DistanceMap), TOTAL_CELLS, f) == static_cast<size_t>(TOTAL_CELLS);
+    ok = ok && std::fwrite(hops_, sizeof(NextHopMap), TOTAL_CELLS, f) == static_cast<size_t>(TOTAL_CELLS);
+    ok = ok && std::fflush(f) == 0;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool GlobalDistanceCache::attach(const std::string& path,
+                                 const std::array<std::array<int8_t, MAP_SIZE>, MAP_SIZE>& wall) {
+    using namespace DistanceCacheFormat;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != DISTANCE_CACHE_BYTES) {
+        ::close(fd);
+        return false;
+    }
+    void* base = ::mmap(nullptr, DISTANCE_CACHE_BYTES, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) return false;
+
+    const Header* h = static_cast<const Header*>(base);
+    const char* body = static_cast<const char*>(base) + sizeof(Header);
+    const DistanceMap* maps = reinterpret_cast<const DistanceMap*>(body);
+    const NextHopMap* hops = reinterpret_cast<const NextHopMap*>(body + TOTAL_CELLS * sizeof(DistanceMap));
+    if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION ||
+        h->cells != static_cast<uint32_t>(TOTAL_CELLS) ||
+        std::memcmp(h->wall, &wall, sizeof(h->wall)) != 0 ||
+        h->checksum != cache_checksum(h->wall, maps, hops)) {
+        ::munmap(base, DISTANCE_CACHE_BYTES);
+        return false;
+    }
+
+    clear();
+    mapped_ = base;
+    mapped_bytes_ = DISTANCE_CACHE_BYTES;
+    wall_ = wall;
+    maps_ = maps;
+    hops_ = hops;
+    initialized_ = true;
+    return true;
+}
+
 void Simulator::initialize_cache() {
     GlobalDistanceCache::instance().initialize(state_.wall);
     global_cache_enabled_ = true;
 }
 
+bool Simulator::attach_cache(const std::string& path) {
+    if (!GlobalDistanceCache::instance().attach(path, state_.wall)) return false;
+    global_cache_enabled_ = true;
+    return true;
+}
+
 // ============================================================
 // 이동 함수
 // ============================================================
@@ -165,7 +306,7 @@ DistanceMap Simulator::create_distance_map(const Position& target) const {
 // ============================================================
 // 프로그램 파싱 (Python _parse_program과 동일)
 // ============================================================
-ParsedProgram Simulator::parse_program(const std::vector<int>& program) {
+ParsedProgram Simulator::parse_program(const std::vector<int>& program) const {
     ParsedProgram result;
     int first_func_id = -1;
     int second_func_id = -1;
@@ -209,36 +350,78 @@ ParsedProgram Simulator::parse_program(const std::vector<int>& program) {
 // ============================================================
 // 액션 변환 (Python _get_mouse_actions과 동일)
 // ============================================================
-ActionResult Simulator::get_mouse_actions(
+void Simulator::get_mouse_actions(
     const std::vector<int>& command,
     const std::vector<int>& func1,
     const std::vector<int>& func2,
-    const GameState& sim_state
+    const GameState& sim_state,
+    ActionResult& out
 ) {
-    ActionResult result;
-    int action_idx = 0;
+    out.actions.clear();
+    out.wall_hit.clear();
+    out.moves = 0;
+    // step_limit 도달 후 액션은 메인 루프에서 실행되지 않으므로 전개하지 않음
+    // (이미 한도면 첫 액션 하나는 실행됨)
+    out.move_budget = std::max(sim_state.step_limit - sim_state.step, 1);
     GameState temp_state = sim_state;
 
-    process_commands(command, func1, func2, temp_state,
-                     result.actions, result.wall_collisions, action_idx);
+    process_commands(command, func1, func2, temp_state, out);
+}
 
+ActionResult Simulator::expand_mouse_actions(const std::vector<int>& program) {
+    ParsedProgram parsed = parse_program(program);
+    ActionResult result;
+    get_mouse_actions(parsed.main_cmd, parsed.func1, parsed.func2, state_, result);
     return result;
 }
 
+void Simulator::RunScratch::reset() {
+    mouse.actions.clear();
+    mouse.wall_hit.clear();
+    mouse_path.clear();
+    mouse.actions.reserve(ACTION_CAPACITY);
+    mouse.wall_hit.reserve(ACTION_CAPACITY);
+    mouse_path.reserve(ACTION_CAPACITY);
+    for (auto& a : cat_actions) {
+        a.clear();
+        a.reserve(ACTION_CAPACITY);
+    }
+    for (auto& a : crzbc_actions) {
+        a.clear();
+        a.reserve(ACTION_CAPACITY);
+    }
+}
+
+void Simulator::append_run(ActionResult& out, GameState& sim_state, int dir, int n, int moves) {
+    int room = out.move_budget - out.moves;
+    if (moves >= room) {
+        // 예산을 채우는 이동까지만 (이후 벽 충돌 액션은 실행되지 않음)
+        moves = room;
+        n = room;
+    }
+    for (int k = 0; k < n; k++) {
+        out.actions.push_back(dir);
+        out.wall_hit.push_back(k >= moves);
+    }
+    sim_state.mouse.x = static_cast<int8_t>(sim_state.mouse.x + Direction::DX[dir] * moves);
+    sim_state.mouse.y = static_cast<int8_t>(sim_state.mouse.y + Direction::DY[dir] * moves);
+    out.moves += moves;
+}
+
 void Simulator::process_commands(
     const std::vector<int>& commands,
     const std::vector<int>& func1,
     const std::vector<int>& func2,
     GameState& sim_state,
-    std::vector<int>& actions,
-    std::set<int>& wall_collisions,
-    int& action_idx
+    ActionResult& out
 ) {
     int need_next = 0;  // 0: 일반, 110: LOOP 수 대기, 5: IF 수 대기
     int pc = 0;         // 0: 일반, 110: LOOP, 5: IF
     int n_iter = 0;
 
     for (size_t i = 0; i < commands.size(); i++) {
+        if (out.full()) return;
+
         int cmd = commands[i];
 
         if (cmd == Token::END) break;
@@ -246,28 +429,19 @@ void Simulator::process_commands(
 
         // 함수 호출 처리
         if (cmd == Token::FUNC_F1 && !func1.empty()) {
-            process_commands(func1, func1, func2, sim_state,
-                           actions, wall_collisions, action_idx);
+            process_commands(func1, func1, func2, sim_state, out);
             continue;
         }
         if (cmd == Token::FUNC_F2 && !func2.empty()) {
-            process_commands(func2, func1, func2, sim_state,
-                           actions, wall_collisions, action_idx);
+            process_commands(func2, func1, func2, sim_state, out);
             continue;
         }
 
         // 상태 머신
         if (need_next == 0) {
             if (Token::is_direction(cmd)) {
-                // 단일 방향 이동
-                if (movable(sim_state.mouse, cmd)) {
-                    sim_state.mouse = move_pos(sim_state.mouse, cmd);
-                    actions.push_back(cmd);
-                } else {
-                    wall_collisions.insert(action_idx);
-                    actions.push_back(cmd);
-                }
-                action_idx++;
+                // 단일 방향 이동 (막히면 벽 충돌 액션)
+                append_run(out, sim_state, cmd, 1, movable(sim_state.mouse, cmd) ? 1 : 0);
             } else if (cmd == Token::LOOP) {
                 need_next = Token::LOOP;
             } else if (cmd == Token::IF) {
@@ -292,49 +466,30 @@ void Simulator::process_commands(
                 need_next = cmd;  // 유효하지 않은 값으로 유지 → IF 실행 조건 불충족
             }
         } else if (pc == Token::LOOP && Token::is_direction(cmd)) {
-            // LOOP 실행
-            for (int j = 0; j < n_iter; j++) {
-                if (movable(sim_state.mouse, cmd)) {
-                    sim_state.mouse = move_pos(sim_state.mouse, cmd);
-                    actions.push_back(cmd);
-                } else {
-                    wall_collisions.insert(action_idx);
-                    actions.push_back(cmd);
-                }
-                action_idx++;
-            }
+            // LOOP 실행: 벽까지 직진 후 나머지는 벽 충돌
+            int cell = sim_state.mouse.x * MAP_SIZE + sim_state.mouse.y;
+            int moves = std::min<int>(n_iter, topology_->corridors.wall_run[cell][cmd]);
+            append_run(out, sim_state, cmd, n_iter, moves);
             need_next = 0;
             pc = 0;
         } else if (pc == Token::IF && Token::is_if_num(need_next) && Token::is_direction(cmd)) {
-            // IF 실행 (교차로까지 이동) - need_next가 유효한 IF 숫자(101-107)여야 함
+            // IF 실행: 교차로 n_iter개를 지날 때까지 직진 (교차로 단위로 점프)
             int remaining = n_iter;
-            #ifdef DEBUG_IF
-            std::cerr << "[IF] Starting: n_iter=" << n_iter << ", dir=" << cmd
-                      << ", mouse=(" << (int)sim_state.mouse.x << "," << (int)sim_state.mouse.y << ")\n";
-            #endif
-            while (remaining > 0) {
-                bool can_move = movable(sim_state.mouse, cmd);
+            while (remaining > 0 && !out.full()) {
+                int cell = sim_state.mouse.x * MAP_SIZE + sim_state.mouse.y;
+                int to_junc = topology_->corridors.junc_run[cell][cmd];
+                int to_wall = topology_->corridors.wall_run[cell][cmd];
                 #ifdef DEBUG_IF
-                std::cerr << "[IF] remaining=" << remaining << ", movable=" << can_move << "\n";
+                std::cerr << "[IF] remaining=" << remaining << ", mouse=(" << (int)sim_state.mouse.x
+                          << "," << (int)sim_state.mouse.y << "), to_junc=" << to_junc
+                          << ", to_wall=" << to_wall << "\n";
                 #endif
-                if (can_move) {
-                    sim_state.mouse = move_pos(sim_state.mouse, cmd);
-                    actions.push_back(cmd);
-                    action_idx++;
-
-                    // 교차로 도달 시 remaining 감소
-                    if (sim_state.junc[sim_state.mouse.x][sim_state.mouse.y]) {
-                        remaining--;
-                    }
-                    #ifdef DEBUG_IF
-                    std::cerr << "[IF] Moved to (" << (int)sim_state.mouse.x << "," << (int)sim_state.mouse.y
-                              << "), junc=" << (int)sim_state.junc[sim_state.mouse.x][sim_state.mouse.y] << "\n";
-                    #endif
+                if (to_junc <= to_wall) {
+                    append_run(out, sim_state, cmd, to_junc, to_junc);
+                    remaining--;
                 } else {
-                    // 벽에 막히면 종료 (Python과 동일하게 액션 추가 없음)
-                    #ifdef DEBUG_IF
-                    std::cerr << "[IF] Wall hit, stopping (no action added)\n";
-                    #endif
+                    // 벽에 막히면 종료 (Python과 동일하게 막힌 스텝은 액션 없음)
+                    append_run(out, sim_state, cmd, to_wall, to_wall);
                     break;
                 }
             }
@@ -348,358 +503,417 @@ void Simulator::process_commands(
 // 고양이 AI (Python 고양이 이동 로직과 동일)
 // ============================================================
 void Simulator::move_cats(GameState& sim_state, const DistanceMap& dist_map) {
-    for (auto& cat : sim_state.cats) {
-        if (!cat.active) continue;
-        move_single_cat(cat, sim_state, dist_map);
+    for (int i = 0; i < sim_state.cats.count; i++) {
+        if (!sim_state.cats.active[i]) continue;
+        move_single_cat(i, sim_state, dist_map);
     }
 }
 
-void Simulator::move_single_cat(Entity& cat, const GameState& sim_state, const DistanceMap& dist_map) {
-    cat.last_pos = cat.pos;
+void Simulator::move_single_cat(int idx, GameState& sim_state, const DistanceMap& dist_map) {
+    CatArray& cats = sim_state.cats;
+    Position pos = cats.pos(idx);
+    int dir = cats.direction[idx];
+    cats.set_last_pos(idx, pos);
 
-    // 막다른 길이면 정지
-    if (sim_state.deadend[cat.pos.x][cat.pos.y]) {
-        return;
-    }
-
-    int16_t my_dist = dist_map[cat.pos.x][cat.pos.y];
-
-    // Red Zone: 마우스로부터 도망
-    if (my_dist > 0 && my_dist <= sim_state.red_zone) {
-        int best_dir = -1;
-        int16_t max_dist = my_dist;
+    MoveContext ctx{&sim_state, sim_state.mouse, &dist_map, nullptr, &topology_->transitions, &topology_->corridors};
+    FleePolicy::step(ctx, pos, dir, rng_);
 
-        for (int dir = 0; dir < Direction::COUNT; dir++) {
-            Position next = cat.pos.move(dir);
-            if (!next.is_valid()) continue;
-            if (sim_state.wall[next.x][next.y]) continue;
-
-            int16_t next_dist = dist_map[next.x][next.y];
-            if (next_dist > max_dist) {
-                max_dist = next_dist;
-                best_dir = dir;
-            }
-        }
+    cats.set_pos(idx, pos);
+    cats.direction[idx] = dir;
+}
 
-        if (best_dir >= 0) {
-            cat.pos = cat.pos.move(best_dir);
-            cat.direction = best_dir;
-            return;
-        }
+// ============================================================
+// 빅치즈 이동
+// ============================================================
+void Simulator::move_movbc(GameState& sim_state) {
+    MovbcArray& bcs = sim_state.movbc;
+    for (int i = 0; i < bcs.count; i++) {
+        if (!bcs.active[i]) continue;
+        Position pos = bcs.pos(i);
+        bcs.set_last_pos(i, pos);
+
+        // 유효한 방향 중 랜덤 이동 (방향은 기억하지 않음)
+        int dir = bcs.direction[i];
+        policy_detail::random_transition(topology_->transitions, TRANSITION_ANY, pos, dir, rng_);
+        bcs.set_pos(i, pos);
     }
+}
 
-    // 교차로: 랜덤 방향 (뒤로 가지 않음)
-    if (sim_state.junc[cat.pos.x][cat.pos.y]) {
-        std::vector<int> valid_dirs;
-        int back_dir = Direction::OPPOSITE[cat.direction];
+void Simulator::move_crzbc(GameState& sim_state, const DistanceMap& dist_map) {
+    CrzbcArray& bcs = sim_state.crzbc;
+    for (int i = 0; i < bcs.count; i++) {
+        if (!bcs.active[i]) continue;
+        Position pos = bcs.pos(i);
+        int dir = bcs.direction[i];
+        bcs.set_last_pos(i, pos);
 
-        for (int dir = 0; dir < Direction::COUNT; dir++) {
-            if (dir == back_dir) continue;
-            Position next = cat.pos.move(dir);
-            if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                valid_dirs.push_back(dir);
-            }
+        // 고양이와 유사한 로직
+        if (sim_state.deadend[pos.x][pos.y]) {
+            continue;
         }
 
-        if (!valid_dirs.empty()) {
-            std::uniform_int_distribution<> dist(0, valid_dirs.size() - 1);
-            int chosen = valid_dirs[dist(rng_)];
-            cat.pos = cat.pos.move(chosen);
-            cat.direction = chosen;
-            return;
+        int cell = pos.x * MAP_SIZE + pos.y;
+        int slot = TransitionTable::slot(dir);
+        if (sim_state.junc[pos.x][pos.y] && topology_->transitions.count[cell][slot] > 0) {
+            // 교차로: 랜덤 방향 (뒤로 가지 않음)
+            policy_detail::random_transition(topology_->transitions, slot, pos, dir, rng_);
+        } else if (movable(pos, dir)) {
+            // 현재 방향 유지
+            pos = pos.move(dir);
+        } else {
+            // 랜덤 방향
+            policy_detail::random_transition(topology_->transitions, TRANSITION_ANY, pos, dir, rng_);
         }
-    }
 
-    // 현재 방향 유지
-    Position next = cat.pos.move(cat.direction);
-    if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-        cat.pos = next;
-        return;
+        bcs.set_pos(i, pos);
+        bcs.direction[i] = dir;
     }
+}
 
-    // 랜덤 방향
-    for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
-        std::uniform_int_distribution<> dist(0, Direction::COUNT - 1);
-        int dir = dist(rng_);
-        next = cat.pos.move(dir);
-        if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-            cat.pos = next;
-            cat.direction = dir;
-            return;
-        }
-    }
+// ============================================================
+// Crossing 감지
+// ============================================================
+bool Simulator::check_crossing(const Position& p1, const Position& p1_last,
+                                const Position& p2, const Position& p2_last) const {
+    return (p1 == p2_last && p2 == p1_last);
 }
 
 // ============================================================
-// 빅치즈 이동
+// 충돌 불가 인증
 // ============================================================
-void Simulator::move_movbc(GameState& sim_state) {
-    for (auto& bc : sim_state.movbc) {
-        if (!bc.active) continue;
-        bc.last_pos = bc.pos;
-
-        // 랜덤 방향으로 이동 시도
-        for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
-            std::uniform_int_distribution<> dist(0, Direction::COUNT - 1);
-            int dir = dist(rng_);
-            Position next = bc.pos.move(dir);
-            if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                bc.pos = next;
-                break;
-            }
-        }
+namespace {
+
+// 두 칸 사이 이동 거리의 하한 (전역 BFS 캐시가 있으면 최단 거리, 없으면 맨해튼)
+struct CertDistance {
+    const GlobalDistanceCache* cache;
+
+    int operator()(const Position& a, const Position& b) const {
+        int manhattan = std::abs(a.x - b.x) + std::abs(a.y - b.y);
+        if (!cache) return manhattan;
+        int d = cache->get(a.x, a.y)[b.x][b.y];  // 시작점 = 1, 벽 = -1, 도달 불가 = 0
+        if (d > 0) return d - 1;
+        return a == b ? 0 : std::max(manhattan, 2 * TOTAL_CELLS);
     }
+};
+
+// 거리 d인 두 엔티티가 매 스텝 최대 1칸씩 움직일 때 만날 수 없는 스텝 수
+// (같은 칸: 2k >= d 필요, 교차: 2k - 1 >= d 필요)
+inline int certified_steps(int d) { return (d - 1) / 2; }
+
+template <int MAX_N>
+inline bool cert_target(const EntityArray<MAX_N>& e, int i) {
+    return e.active[i] && e.pos(i).is_valid();
 }
 
-void Simulator::move_crzbc(GameState& sim_state, const DistanceMap& dist_map) {
-    for (auto& bc : sim_state.crzbc) {
-        if (!bc.active) continue;
-        bc.last_pos = bc.pos;
+} // namespace
 
-        // 고양이와 유사한 로직
-        if (sim_state.deadend[bc.pos.x][bc.pos.y]) {
-            continue;
-        }
+CollisionCertStats Simulator::collision_cert_stats() {
+    CollisionCertStats s;
+    s.steps = cert_steps_.load(std::memory_order_relaxed);
+    s.windows = cert_windows_.load(std::memory_order_relaxed);
+    s.cat_skipped = cert_cat_skipped_.load(std::memory_order_relaxed);
+    s.crzbc_skipped = cert_crzbc_skipped_.load(std::memory_order_relaxed);
+    return s;
+}
 
-        // 교차로: 랜덤 방향
-        if (sim_state.junc[bc.pos.x][bc.pos.y]) {
-            std::vector<int> valid_dirs;
-            int back_dir = Direction::OPPOSITE[bc.direction];
+void Simulator::reset_collision_cert_stats() {
+    cert_steps_.store(0, std::memory_order_relaxed);
+    cert_windows_.store(0, std::memory_order_relaxed);
+    cert_cat_skipped_.store(0, std::memory_order_relaxed);
+    cert_crzbc_skipped_.store(0, std::memory_order_relaxed);
+}
 
-            for (int dir = 0; dir < Direction::COUNT; dir++) {
-                if (dir == back_dir) continue;
-                Position next = bc.pos.move(dir);
-                if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                    valid_dirs.push_back(dir);
-                }
-            }
+int Simulator::certify_cat_window(const GameState& sim_state, const GlobalDistanceCache* cache) const {
+    CertDistance dist{cache};
 
-            if (!valid_dirs.empty()) {
-                std::uniform_int_distribution<> dist_rand(0, valid_dirs.size() - 1);
-                int chosen = valid_dirs[dist_rand(rng_)];
-                bc.pos = bc.pos.move(chosen);
-                bc.direction = chosen;
-                continue;
-            }
-        }
+    const CatArray& cats = sim_state.cats;
+    int d_min = 2 * TOTAL_CELLS;
+    for (int i = 0; i < cats.count; i++) {
+        if (!cert_target(cats, i)) continue;
+        d_min = std::min(d_min, dist(sim_state.mouse, cats.pos(i)));
+    }
+    return certified_steps(d_min);
+}
 
-        // 현재 방향 유지
-        Position next = bc.pos.move(bc.direction);
-        if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-            bc.pos = next;
-            continue;
+int Simulator::certify_crzbc_window(const GameState& sim_state, const GlobalDistanceCache* cache) const {
+    CertDistance dist{cache};
+
+    const CatArray& cats = sim_state.cats;
+    const CrzbcArray& crzbc = sim_state.crzbc;
+    int d_min = 2 * TOTAL_CELLS;
+    for (int j = 0; j < crzbc.count; j++) {
+        if (!cert_target(crzbc, j)) continue;
+        Position p = crzbc.pos(j);
+        d_min = std::min(d_min, dist(sim_state.mouse, p));
+        for (int i = 0; i < cats.count; i++) {
+            if (cert_target(cats, i)) d_min = std::min(d_min, dist(p, cats.pos(i)));
         }
-
-        // 랜덤 방향
-        for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
-            std::uniform_int_distribution<> dist_rand(0, Direction::COUNT - 1);
-            int dir = dist_rand(rng_);
-            next = bc.pos.move(dir);
-            if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                bc.pos = next;
-                bc.direction = dir;
-                break;
-            }
+        for (int k = j + 1; k < crzbc.count; k++) {
+            if (cert_target(crzbc, k)) d_min = std::min(d_min, dist(p, crzbc.pos(k)));
         }
     }
+    return certified_steps(d_min);
 }
 
 // ============================================================
-// Crossing 감지
+// 정책 컨텍스트 (마우스 기준 거리 / 다음 방향)
 // ============================================================
-bool Simulator::check_crossing(const Position& p1, const Position& p1_last,
-                                const Position& p2, const Position& p2_last) const {
-    return (p1 == p2_last && p2 == p1_last);
+MoveContext Simulator::mouse_context(const GameState& sim_state, const Position& mouse,
+                                     MouseFieldCache& local) const {
+    const GlobalDistanceCache& cache = GlobalDistanceCache::instance();
+    if (global_cache_enabled_ && cache.is_initialized()) {
+        return MoveContext{&sim_state, mouse, &cache.get(mouse.x, mouse.y),
+                           &cache.next_hop_to(mouse.x, mouse.y), &topology_->transitions, &topology_->corridors};
+    }
+
+    // 전역 캐시가 없으면 마우스 위치별로 한 번만 계산
+    if (local.ready.empty()) {
+        local.dist.resize(TOTAL_CELLS);
+        local.next_hop.resize(TOTAL_CELLS);
+        local.ready.assign(TOTAL_CELLS, 0);
+    }
+    int cell = mouse.x * MAP_SIZE + mouse.y;
+    if (!local.ready[cell]) {
+        local.dist[cell] = create_distance_map(mouse);
+        compute_next_hop(local.dist[cell], local.next_hop[cell]);
+        local.ready[cell] = 1;
+    }
+    return MoveContext{&sim_state, mouse, &local.dist[cell], &local.next_hop[cell], &topology_->transitions, &topology_->corridors};
 }
 
 // ============================================================
-// Pre-calculate cat actions (exe3.py _get_cats_direct_actions0 - FLEE mode)
+// 복도 구간 이동: RNG 없이 확정되는 직진 구간을 한 번에 기록
+// (교차로 / 막힌 칸에서만 Policy::step 호출 → RNG 소비 순서는 스텝 단위와 동일)
+// ============================================================
+namespace {
+
+template <class Policy>
+bool extend_corridor_run(const MoveContext& ctx, Position& pos, int dir, int max_steps,
+                         std::vector<int>& actions) {
+    int run = std::min(Policy::corridor_run(ctx, pos, dir), max_steps);
+    if (run <= 0) return false;
+    actions.insert(actions.end(), run, dir);
+    pos.x = static_cast<int8_t>(pos.x + Direction::DX[dir] * run);
+    pos.y = static_cast<int8_t>(pos.y + Direction::DY[dir] * run);
+    return true;
+}
+
+} // namespace
+
+// ============================================================
+// Pre-calculate cat actions (exe3.py _get_cats_direct_actions)
+// Policy = RandomWalkPolicy 이면 exe3.py RANDOM 모드와 동일
 // ============================================================
-std::array<std::vector<int>, Config::NUM_CATS> Simulator::pre_calculate_cat_actions(
-    const std::vector<int>& mouse_actions, const GameState& sim_state)
+template <class Policy>
+void Simulator::pre_calculate_cat_actions(
+    const std::vector<int>& mouse_actions, const std::vector<Position>& mouse_path,
+    const GameState& sim_state, std::array<std::vector<int>, Config::MAX_CATS>& cat_actions)
 {
-    std::array<std::vector<int>, Config::NUM_CATS> cat_actions;
+    const int n_cats = sim_state.cats.count;
 
     // Virtual state for pre-calculation
-    std::array<Position, Config::NUM_CATS> virtual_cats;
-    std::array<int, Config::NUM_CATS> virtual_dirs;
+    std::array<Position, Config::MAX_CATS> virtual_cats;
+    std::array<int, Config::MAX_CATS> virtual_dirs;
 
-    for (int i = 0; i < Config::NUM_CATS; i++) {
-        virtual_cats[i] = sim_state.cats[i].pos;
-        virtual_dirs[i] = sim_state.cats[i].direction;
+    int n_steps = static_cast<int>(mouse_actions.size());
+    for (int i = 0; i < n_cats; i++) {
+        virtual_cats[i] = sim_state.cats.pos(i);
+        virtual_dirs[i] = sim_state.cats.direction[i];
+        cat_actions[i].clear();
+        cat_actions[i].reserve(n_steps);
     }
 
-    int n_steps = static_cast<int>(mouse_actions.size());
+    MoveContext ctx{&sim_state, sim_state.mouse, nullptr, nullptr, &topology_->transitions, &topology_->corridors};
 
-    // RANDOM mode (exe3.py _get_cats_direct_actions): no flee, no mouse tracking
     for (int step = 0; step < n_steps; step++) {
-        for (int i = 0; i < Config::NUM_CATS; i++) {
-            Position& cat_pos = virtual_cats[i];
-            int& cat_dir = virtual_dirs[i];
-
-            // Junction: random direction (no turning back)
-            if (sim_state.junc[cat_pos.x][cat_pos.y]) {
-                bool found = false;
-                for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
-                    std::uniform_int_distribution<> dist(0, Direction::COUNT - 1);
-                    int new_dir = dist(rng_);
-                    if (new_dir == Direction::OPPOSITE[cat_dir]) continue;
-                    Position next = cat_pos.move(new_dir);
-                    if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                        cat_pos = next;
-                        cat_dir = new_dir;
-                        cat_actions[i].push_back(new_dir);
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    cat_actions[i].push_back(cat_dir >= 0 && cat_dir < Direction::COUNT ? cat_dir : 0);
-                }
-            }
-            // Continue in current direction
-            else if (movable(cat_pos, cat_dir)) {
-                cat_pos = move_pos(cat_pos, cat_dir);
-                cat_actions[i].push_back(cat_dir);
-            }
-            // Blocked: random direction
-            else {
-                bool found = false;
-                for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
-                    std::uniform_int_distribution<> dist(0, Direction::COUNT - 1);
-                    int new_dir = dist(rng_);
-                    Position next = cat_pos.move(new_dir);
-                    if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                        cat_pos = next;
-                        cat_dir = new_dir;
-                        cat_actions[i].push_back(new_dir);
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    cat_actions[i].push_back(cat_dir >= 0 && cat_dir < Direction::COUNT ? cat_dir : 0);
+        if constexpr (Policy::NEEDS_MOUSE) {
+            ctx = mouse_context(sim_state, mouse_path[step], mouse_fields_);
+        }
+        for (int i = 0; i < n_cats; i++) {
+            if ((int)cat_actions[i].size() > step) continue;  // 복도 구간으로 이미 채움
+            if constexpr (Policy::CORRIDOR_RUNS) {
+                if (extend_corridor_run<Policy>(ctx, virtual_cats[i], virtual_dirs[i],
+                                                n_steps - step, cat_actions[i])) {
+                    continue;
                 }
             }
+            cat_actions[i].push_back(Policy::step(ctx, virtual_cats[i], virtual_dirs[i], rng_));
         }
     }
-
-    return cat_actions;
 }
 
 // ============================================================
 // Pre-calculate crzbc actions (exe3.py _get_crzbc_actions matching)
 // ============================================================
-std::array<std::vector<int>, Config::NUM_CRZBC> Simulator::pre_calculate_crzbc_actions(
-    int n_moves, const GameState& sim_state)
+template <class Policy>
+void Simulator::pre_calculate_crzbc_actions(
+    int n_moves, const std::vector<Position>& mouse_path, const GameState& sim_state,
+    std::array<std::vector<int>, Config::MAX_CRZBC>& crzbc_actions)
 {
-    std::array<std::vector<int>, Config::NUM_CRZBC> crzbc_actions;
+    const int n_crzbc = sim_state.crzbc.count;
 
-    std::array<Position, Config::NUM_CRZBC> virtual_crzbc;
-    std::array<int, Config::NUM_CRZBC> virtual_dirs;
+    std::array<Position, Config::MAX_CRZBC> virtual_crzbc;
+    std::array<int, Config::MAX_CRZBC> virtual_dirs;
 
-    for (int i = 0; i < Config::NUM_CRZBC; i++) {
-        virtual_crzbc[i] = sim_state.crzbc[i].pos;
-        virtual_dirs[i] = sim_state.crzbc[i].direction;
+    for (int i = 0; i < n_crzbc; i++) {
+        virtual_crzbc[i] = sim_state.crzbc.pos(i);
+        virtual_dirs[i] = sim_state.crzbc.direction[i];
+        crzbc_actions[i].clear();
+        crzbc_actions[i].reserve(n_moves);
     }
 
+    MoveContext ctx{&sim_state, sim_state.mouse, nullptr, nullptr, &topology_->transitions, &topology_->corridors};
+
     for (int step = 0; step < n_moves; step++) {
-        for (int i = 0; i < Config::NUM_CRZBC; i++) {
-            if (!sim_state.crzbc[i].active) continue;
-
-            Position& pos = virtual_crzbc[i];
-            int& dir = virtual_dirs[i];
-
-            if (!pos.is_valid()) continue;
-
-            // Junction: random (no turning back)
-            if (sim_state.junc[pos.x][pos.y]) {
-                bool found = false;
-                for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
-                    std::uniform_int_distribution<> dist(0, Direction::COUNT - 1);
-                    int new_dir = dist(rng_);
-                    if (new_dir == Direction::OPPOSITE[dir]) continue;
-                    Position next = pos.move(new_dir);
-                    if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                        pos = next;
-                        dir = new_dir;
-                        crzbc_actions[i].push_back(new_dir);
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    crzbc_actions[i].push_back(dir >= 0 && dir < Direction::COUNT ? dir : 0);
-                }
-            }
-            // Continue in current direction
-            else if (movable(pos, dir)) {
-                pos = move_pos(pos, dir);
-                crzbc_actions[i].push_back(dir);
-            }
-            // Random direction
-            else {
-                bool found = false;
-                for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
-                    std::uniform_int_distribution<> dist(0, Direction::COUNT - 1);
-                    int new_dir = dist(rng_);
-                    Position next = pos.move(new_dir);
-                    if (next.is_valid() && !sim_state.wall[next.x][next.y]) {
-                        pos = next;
-                        dir = new_dir;
-                        crzbc_actions[i].push_back(new_dir);
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    crzbc_actions[i].push_back(dir >= 0 && dir < Direction::COUNT ? dir : 0);
+        if constexpr (Policy::NEEDS_MOUSE) {
+            // 마우스 액션보다 긴 구간은 마지막 위치 기준
+            const Position& mouse = mouse_path.empty() ? sim_state.mouse
+                : mouse_path[std::min<size_t>(step, mouse_path.size() - 1)];
+            ctx = mouse_context(sim_state, mouse, mouse_fields_);
+        }
+        for (int i = 0; i < n_crzbc; i++) {
+            if (!sim_state.crzbc.active[i]) continue;
+            if (!virtual_crzbc[i].is_valid()) continue;
+            if ((int)crzbc_actions[i].size() > step) continue;  // 복도 구간으로 이미 채움
+            if constexpr (Policy::CORRIDOR_RUNS) {
+                if (extend_corridor_run<Policy>(ctx, virtual_crzbc[i], virtual_dirs[i],
+                                                n_moves - step, crzbc_actions[i])) {
+                    continue;
                 }
             }
+            crzbc_actions[i].push_back(Policy::step(ctx, virtual_crzbc[i], virtual_dirs[i], rng_));
         }
     }
-
-    return crzbc_actions;
 }
 
 // ============================================================
 // 시뮬레이션 (exe3.py running_op 매칭)
+// 정책 조합별 인스턴스로 디스패치 (핫 루프에 가상 호출 없음)
 // ============================================================
-float Simulator::simulate_program(const std::vector<int>& program) {
-    // 가상 상태 복사
-    GameState sim_state = state_;
-    int virtual_score = state_.score;
-    int virtual_life = state_.life;
+namespace {
+
+template <class CatPolicyT, class Fn>
+float dispatch_crzbc_policy(MovePolicy crzbc_policy, Fn&& fn) {
+    switch (crzbc_policy) {
+        case MovePolicy::FLEE:  return fn(CatPolicyT{}, FleePolicy{});
+        case MovePolicy::CHASE: return fn(CatPolicyT{}, ChasePolicy{});
+        default:                return fn(CatPolicyT{}, RandomWalkPolicy{});
+    }
+}
 
-    // 1. 프로그램 파싱
-    ParsedProgram parsed = parse_program(program);
+template <class Fn>
+float dispatch_policies(MovePolicy cat_policy, MovePolicy crzbc_policy, Fn&& fn) {
+    switch (cat_policy) {
+        case MovePolicy::FLEE:  return dispatch_crzbc_policy<FleePolicy>(crzbc_policy, fn);
+        case MovePolicy::CHASE: return dispatch_crzbc_policy<ChasePolicy>(crzbc_policy, fn);
+        default:                return dispatch_crzbc_policy<RandomWalkPolicy>(crzbc_policy, fn);
+    }
+}
 
-    // 2. 액션 변환
-    ActionResult action_result = get_mouse_actions(
-        parsed.main_cmd, parsed.func1, parsed.func2, sim_state
-    );
+} // namespace
 
-    // 상태 재설정 (액션 변환에서 수정됨)
-    sim_state = state_;
+CompiledProgram Simulator::compile_program(const std::vector<int>& program) const {
+    CompiledProgram compiled;
+    compiled.parsed = parse_program(program);
 
     // command_length: 프로그램 토큰 수 (END 포함, Python len(command) 매칭)
-    int command_length = 0;
     for (int token : program) {
-        command_length++;
+        compiled.command_length++;
         if (token == Token::END) break;
     }
+    return compiled;
+}
+
+float Simulator::simulate_program(const std::vector<int>& program,
+                                  MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    return simulate_compiled(compile_program(program), cat_policy, crzbc_policy);
+}
+
+float Simulator::simulate_compiled(const CompiledProgram& compiled,
+                                   MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    return dispatch_policies(cat_policy, crzbc_policy, [&](auto cat_p, auto crzbc_p) {
+        using CatT = decltype(cat_p);
+        using CrzbcT = decltype(crzbc_p);
+        // 기본 규칙: 점수 상수가 접힌 인스턴스 / 사용자 규칙: 범용 인스턴스 (가상 상태 사본 위에서)
+        GameState sim_state = state_;
+        if (default_rules_) return simulate_program_impl<CatT, CrzbcT>(compiled, DefaultRules{}, sim_state);
+        return simulate_program_impl<CatT, CrzbcT>(compiled, RuntimeRules{&rules_}, sim_state);
+    });
+}
+
+template <class CatPolicyT, class CrzbcPolicyT, class RulesT>
+float Simulator::simulate_program_impl(const CompiledProgram& compiled, const RulesT& rules,
+                                       GameState& sim_state, CellMask* eaten) {
+    // 사용자 규칙이면 step_limit / red_zone 덮어씀
+    rules.apply(sim_state);
+    int virtual_score = sim_state.score;
+    int virtual_life = sim_state.life;
+
+    // 1. 액션 변환 (파싱은 compile_program에서 완료, sim_state는 바꾸지 않음)
+    // 버퍼는 scratch_ 재사용 (용량 안에서는 힙 할당 없음)
+    const ParsedProgram& parsed = compiled.parsed;
+    scratch_.reset();
+    ActionResult& action_result = scratch_.mouse;
+    get_mouse_actions(parsed.main_cmd, parsed.func1, parsed.func2, sim_state, action_result);
+
+    const int command_length = compiled.command_length;
+
+    // 마우스 경로 (마우스를 보는 정책에서만 필요)
+    std::vector<Position>& mouse_path = scratch_.mouse_path;
+    if constexpr (CatPolicyT::NEEDS_MOUSE || CrzbcPolicyT::NEEDS_MOUSE) {
+        Position m = sim_state.mouse;
+        mouse_path.reserve(action_result.actions.size());
+        for (size_t t = 0; t < action_result.actions.size(); t++) {
+            if (!action_result.wall_hit[t]) m = move_pos(m, action_result.actions[t]);
+            mouse_path.push_back(m);
+        }
+    }
 
     // 3. Pre-calculate entity actions (exe3.py style)
-    auto cat_actions = pre_calculate_cat_actions(action_result.actions, sim_state);
-    auto crzbc_actions = pre_calculate_crzbc_actions(command_length, sim_state);
+    auto& cat_actions = scratch_.cat_actions;
+    auto& crzbc_actions = scratch_.crzbc_actions;
+    pre_calculate_cat_actions<CatPolicyT>(action_result.actions, mouse_path, sim_state, cat_actions);
+    pre_calculate_crzbc_actions<CrzbcPolicyT>(command_length, mouse_path, sim_state, crzbc_actions);
+
+    // 남은 치즈 수 (스텝마다 전체 맵을 세지 않고 수집 시 감소)
+    int remaining_sc = sim_state.count_remaining_cheese();
+
+    // 충돌 불가 인증 구간: itr < *_safe_until 인 스텝은 해당 충돌 검사 생략
+    // 구간이 끝나면 그 시점의 실제 위치로 다시 인증 (가까우면 길이 0 → 매 스텝 검사)
+    const bool certify = collision_cert_enabled_.load(std::memory_order_relaxed);
+    // 전역 캐시는 이 상태의 벽으로 만든 것일 때만 (아니면 맨해튼 하한)
+    const GlobalDistanceCache& global_cache = GlobalDistanceCache::instance();
+    const GlobalDistanceCache* cert_cache =
+        certify && global_cache_enabled_ && global_cache.matches(sim_state.wall) ? &global_cache : nullptr;
+    size_t cat_safe_until = 0;
+    size_t crzbc_safe_until = 0;
+    uint64_t n_steps = 0, n_windows = 0, n_cat_skipped = 0, n_crzbc_skipped = 0;
 
     // 4. 시뮬레이션 루프
     for (size_t itr = 0; itr < action_result.actions.size(); itr++) {
         int action = action_result.actions[itr];
+        n_steps++;
+
+        bool cat_safe = false;
+        bool crzbc_safe = false;
+        if (certify) {
+            if (itr >= cat_safe_until) {
+                cat_safe_until = itr + certify_cat_window(sim_state, cert_cache);
+                n_windows += cat_safe_until > itr;
+            }
+            if (itr >= crzbc_safe_until) {
+                crzbc_safe_until = itr + certify_crzbc_window(sim_state, cert_cache);
+                n_windows += crzbc_safe_until > itr;
+            }
+            cat_safe = itr < cat_safe_until;
+            crzbc_safe = itr < crzbc_safe_until;
+            n_cat_skipped += cat_safe;
+            n_crzbc_skipped += crzbc_safe;
+        }
 
         // 1. Wall collision
-        if (action_result.wall_collisions.count(itr)) {
-            virtual_score += Score::WALL_COLLISION;
+        if (action_result.wall_hit[itr]) {
+            virtual_score += rules.wall_collision();
         }
 
         // 2. Mouse moves
@@ -709,106 +923,106 @@ float Simulator::simulate_program(const std::vector<int>& program) {
             sim_state.step++;
         }
 
-        // 3. Cat1 (naughty) moves every step
-        if (itr < cat_actions[1].size()) {
-            if (movable(sim_state.cats[1].pos, cat_actions[1][itr])) {
-                Position new_pos = move_pos(sim_state.cats[1].pos, cat_actions[1][itr]);
+        // 3. Naughty cats (1..n-1) move every step
+        CatArray& cats = sim_state.cats;
+        for (int ci = 1; ci < cats.count; ci++) {
+            if (itr >= cat_actions[ci].size()) continue;
+            Position cur = cats.pos(ci);
+            if (cat_actions[ci][itr] != ACTION_STAY && movable(cur, cat_actions[ci][itr])) {
+                Position new_pos = move_pos(cur, cat_actions[ci][itr]);
                 // Cat-cat collision prevention
-                if (new_pos != sim_state.cats[0].pos) {
-                    sim_state.cats[1].last_pos = sim_state.cats[1].pos;
-                    sim_state.cats[1].pos = new_pos;
+                if ((cats.mask_at(new_pos) & ~(1u << ci)) == 0) {
+                    cats.set_last_pos(ci, cur);
+                    cats.set_pos(ci, new_pos);
+                    cats.direction[ci] = static_cast<int8_t>(cat_actions[ci][itr]);
                 }
             }
         }
 
         // 4. Cat0 (dummy) moves only for command_length steps
-        if ((int)itr < command_length && itr < cat_actions[0].size()) {
-            if (movable(sim_state.cats[0].pos, cat_actions[0][itr])) {
-                Position new_pos = move_pos(sim_state.cats[0].pos, cat_actions[0][itr]);
+        if (cats.count > 0 && (int)itr < command_length && itr < cat_actions[0].size()) {
+            Position cur = cats.pos(0);
+            if (cat_actions[0][itr] != ACTION_STAY && movable(cur, cat_actions[0][itr])) {
+                Position new_pos = move_pos(cur, cat_actions[0][itr]);
                 // Cat-cat collision prevention
-                if (new_pos != sim_state.cats[1].pos) {
-                    sim_state.cats[0].last_pos = sim_state.cats[0].pos;
-                    sim_state.cats[0].pos = new_pos;
+                if ((cats.mask_at(new_pos) & ~1u) == 0) {
+                    cats.set_last_pos(0, cur);
+                    cats.set_pos(0, new_pos);
+                    cats.direction[0] = static_cast<int8_t>(cat_actions[0][itr]);
                 }
             }
         }
 
         // 5. Crzbc moves (pre-calculated, for command_length steps)
-        for (int j = 0; j < Config::NUM_CRZBC; j++) {
-            if (!sim_state.crzbc[j].active) continue;
+        CrzbcArray& crzbc = sim_state.crzbc;
+        for (int j = 0; j < crzbc.count; j++) {
+            if (!crzbc.active[j]) continue;
             if (itr < crzbc_actions[j].size()) {
-                if (movable(sim_state.crzbc[j].pos, crzbc_actions[j][itr])) {
-                    Position new_pos = move_pos(sim_state.crzbc[j].pos, crzbc_actions[j][itr]);
-                    // Collision check with cats and other crzbc
-                    bool collision = false;
-                    for (int c = 0; c < Config::NUM_CATS; c++) {
-                        if (new_pos == sim_state.cats[c].pos) {
-                            collision = true;
-                            break;
-                        }
-                    }
-                    for (int k = 0; k < Config::NUM_CRZBC; k++) {
-                        if (k != j && sim_state.crzbc[k].active && new_pos == sim_state.crzbc[k].pos) {
-                            collision = true;
-                            break;
-                        }
-                    }
-                    if (!collision) {
-                        sim_state.crzbc[j].pos = new_pos;
+                Position cur = crzbc.pos(j);
+                if (crzbc_actions[j][itr] != ACTION_STAY && movable(cur, crzbc_actions[j][itr])) {
+                    Position new_pos = move_pos(cur, crzbc_actions[j][itr]);
+                    // Collision check with cats and other crzbc (인증 구간이면 생략)
+                    uint32_t blocked = crzbc_safe ? 0u :
+                        (cats.mask_at(new_pos) | (crzbc.mask_at(new_pos) & ~(1u << j)));
+                    if (!blocked) {
+                        crzbc.set_last_pos(j, cur);
+                        crzbc.set_pos(j, new_pos);
+                        crzbc.direction[j] = static_cast<int8_t>(crzbc_actions[j][itr]);
                     }
                 }
             }
         }
 
-        // 6. Cat collision check AFTER movement (no break - both cats can catch)
-        bool catched = false;
-        for (int ci = 0; ci < Config::NUM_CATS; ci++) {
-            if (!sim_state.cats[ci].active) continue;
-            if (sim_state.mouse == sim_state.cats[ci].pos ||
-                check_crossing(sim_state.mouse, sim_state.mouse_last,
-                               sim_state.cats[ci].pos, sim_state.cats[ci].last_pos)) {
-                virtual_score += Score::CAT_COLLISION;
-                virtual_life--;
-                catched = true;
-                // No break: both cats can catch in same step
-            }
+        // 6. Cat collision check AFTER movement (both cats can catch)
+        uint32_t catch_mask = cat_safe ? 0u :
+            (cats.mask_at(sim_state.mouse) | cats.mask_crossing(sim_state.mouse, sim_state.mouse_last));
+        bool catched = catch_mask != 0;
+        sim_state.catched = catched;
+        if (catched) {
+            int n_catch = __builtin_popcount(catch_mask);
+            virtual_score += rules.cat_collision() * n_catch;
+            virtual_life -= n_catch;
         }
 
         // 7. movbc collection (NO movement - stationary)
-        for (auto& bc : sim_state.movbc) {
-            if (!bc.active) continue;
-            if (sim_state.mouse == bc.pos) {
-                bc.active = false;
-                virtual_score += Score::BIG_CHEESE;
+        uint32_t movbc_mask = sim_state.movbc.mask_at(sim_state.mouse);
+        if (movbc_mask) {
+            for (int i = 0; i < sim_state.movbc.count; i++) {
+                if (movbc_mask & (1u << i)) sim_state.movbc.active[i] = 0;
             }
+            virtual_score += rules.big_cheese() * __builtin_popcount(movbc_mask);
         }
 
         // 8. crzbc collection
-        for (auto& bc : sim_state.crzbc) {
-            if (!bc.active) continue;
-            if (sim_state.mouse == bc.pos) {
-                bc.active = false;
-                virtual_score += Score::BIG_CHEESE;
+        uint32_t crzbc_mask = crzbc_safe ? 0u : crzbc.mask_at(sim_state.mouse);
+        if (crzbc_mask) {
+            for (int i = 0; i < crzbc.count; i++) {
+                if (crzbc_mask & (1u << i)) crzbc.active[i] = 0;
             }
+            virtual_score += rules.big_cheese() * __builtin_popcount(crzbc_mask);
         }
 
         // 9. SC collection
         if (sim_state.sc[sim_state.mouse.x][sim_state.mouse.y]) {
+            remaining_sc -= sim_state.sc[sim_state.mouse.x][sim_state.mouse.y];
             sim_state.sc[sim_state.mouse.x][sim_state.mouse.y] = 0;
-            virtual_score += Score::SMALL_CHEESE;
+            virtual_score += rules.small_cheese();
+            if (eaten) eaten->set(sim_state.mouse.x * MAP_SIZE + sim_state.mouse.y);
         }
 
         // 10. Win/lose check (exe3.py order: life→sc→step)
         if (virtual_life <= 0) {
+            sim_state.lose_sign = true;
             break;
         }
-        if (sim_state.count_remaining_cheese() == 0) {
+        if (remaining_sc == 0) {
             sim_state.win_sign = true;
-            int victory_bonus = sim_state.run * 10 + sim_state.step;
+            int victory_bonus = rules.victory_bonus(sim_state.run, sim_state.step);
             virtual_score += victory_bonus;
             break;
         }
         if (sim_state.step >= sim_state.step_limit) {
+            sim_state.lose_sign = true;
             break;
         }
 
@@ -818,30 +1032,128 @@ float Simulator::simulate_program(const std::vector<int>& program) {
         }
     }
 
+    if (certify) {
+        cert_steps_.fetch_add(n_steps, std::memory_order_relaxed);
+        cert_windows_.fetch_add(n_windows, std::memory_order_relaxed);
+        cert_cat_skipped_.fetch_add(n_cat_skipped, std::memory_order_relaxed);
+        cert_crzbc_skipped_.fetch_add(n_crzbc_skipped, std::memory_order_relaxed);
+    }
+
     // 루프 후 승리 체크 (루프가 정상 종료된 경우)
-    if (!sim_state.win_sign && sim_state.count_remaining_cheese() == 0) {
+    if (!sim_state.win_sign && remaining_sc == 0) {
         sim_state.win_sign = true;
-        int victory_bonus = sim_state.run * 10 + sim_state.step;
+        int victory_bonus = rules.victory_bonus(sim_state.run, sim_state.step);
         virtual_score += victory_bonus;
     }
 
+    sim_state.score = virtual_score;
+    sim_state.life = static_cast<int16_t>(virtual_life);
     return static_cast<float>(virtual_score);
 }
 
 float Simulator::simulate_program_and_apply(const std::vector<int>& program) {
     float score = simulate_program(program);
     // 상태는 simulate_program에서 변경되지 않음 (가상 상태 사용)
-    // 실제 적용이 필요하면 별도 구현
+    // 실제 적용이 필요하면 execute_program 사용
     return score;
 }
 
+// ============================================================
+// 런 진행 (실제 상태 적용)
+// ============================================================
+void Simulator::retry_after_catched(GameState& state) {
+    const Position spawn(10, 10);
+    state.mouse = spawn;
+    state.mouse_last = state.mouse;
+    // 고양이 0, 1: Python과 같은 고정 칸
+    // 그 이후 (생성기 / 임의 시작 상태의 추가 고양이): 행 우선으로 훑어 벽이 아니고 리스폰 칸에서
+    // 맨해튼 RESPAWN_CLEARANCE 이상, 앞서 놓은 고양이와 겹치지 않는 첫 칸 (없으면 제자리)
+    static const Position CAT_SPAWN[Config::NUM_CATS] = {Position(2, 2), Position(5, 5)};
+    constexpr int RESPAWN_CLEARANCE = 3;
+    CatArray& cats = state.cats;
+    int next_cell = 0;
+    for (int i = 0; i < cats.count; i++) {
+        Position p = cats.pos(i);
+        if (i < Config::NUM_CATS) {
+            p = CAT_SPAWN[i];
+        } else {
+            for (; next_cell < TOTAL_CELLS; next_cell++) {
+                const Position c(static_cast<int8_t>(next_cell / MAP_SIZE), static_cast<int8_t>(next_cell % MAP_SIZE));
+                if (state.wall[c.x][c.y] || std::abs(c.x - spawn.x) + std::abs(c.y - spawn.y) < RESPAWN_CLEARANCE) continue;
+                if (cats.mask_at(c) & ((1u << i) - 1)) continue;
+                p = c;
+                next_cell++;
+                break;
+            }
+        }
+        cats.set_pos(i, p);
+        cats.set_last_pos(i, p);
+        cats.direction[i] = static_cast<int8_t>(rng_() % Direction::COUNT);
+    }
+    state.catched = false;
+}
+
+float Simulator::execute_program(const std::vector<int>& program,
+                                 MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    return execute_compiled(compile_program(program), cat_policy, crzbc_policy);
+}
+
+float Simulator::execute_compiled(const CompiledProgram& compiled,
+                                  MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    return run_compiled(compiled, cat_policy, crzbc_policy, state_);
+}
+
+float Simulator::run_compiled(const CompiledProgram& compiled, MovePolicy cat_policy,
+                              MovePolicy crzbc_policy, GameState& next, CellMask* eaten) {
+    float score = dispatch_policies(cat_policy, crzbc_policy, [&](auto cat_p, auto crzbc_p) {
+        using CatT = decltype(cat_p);
+        using CrzbcT = decltype(crzbc_p);
+        if (default_rules_) return simulate_program_impl<CatT, CrzbcT>(compiled, DefaultRules{}, next, eaten);
+        return simulate_program_impl<CatT, CrzbcT>(compiled, RuntimeRules{&rules_}, next, eaten);
+    });
+
+    // 먹은 빅치즈는 Python / dict 형식과 같이 (-1, -1)
+    const Position gone(-1, -1);
+    for (int i = 0; i < next.movbc.count; i++) {
+        if (!next.movbc.active[i]) next.movbc.set_pos(i, gone);
+    }
+    for (int i = 0; i < next.crzbc.count; i++) {
+        if (!next.crzbc.active[i]) next.crzbc.set_pos(i, gone);
+    }
+
+    if (next.catched && !next.lose_sign && !next.win_sign) retry_after_catched(next);
+    next.run++;
+    if (next.run >= Config::MAX_RUNS && !next.win_sign) next.lose_sign = true;
+    return score;
+}
+
+// ============================================================
+// 되돌리기 저널: 런이 바꿀 수 있는 부분만 기록 / 복원 (state_ 위에서 바로 진행)
+// ============================================================
+float Simulator::apply(const CompiledProgram& compiled, StepJournal& journal,
+                       MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    JournalEntry& entry = journal.begin(journal_epoch_, rng_);
+    entry.capture(state_, rng_.draws());
+    return run_compiled(compiled, cat_policy, crzbc_policy, state_, &entry.eaten);
+}
+
+bool Simulator::undo(StepJournal& journal) {
+    if (journal.empty() || journal.epoch() != journal_epoch_) return false;
+    journal.pop(rng_).revert(state_);
+    return true;
+}
+
 // ============================================================
 // 배치 시뮬레이션 (OpenMP 병렬)
 // ============================================================
 std::vector<float> batch_simulate(
     const std::vector<std::vector<int>>& programs,
     const GameState& initial_state,
-    int num_threads
+    int num_threads,
+    MovePolicy cat_policy,
+    MovePolicy crzbc_policy,
+    const std::vector<int>& functions,
+    const RuleSet& rules
 ) {
     std::vector<float> results(programs.size());
 
@@ -853,15 +1165,109 @@ std::vector<float> batch_simulate(
     #pragma omp parallel for num_threads(num_threads)
     for (size_t i = 0; i < programs.size(); i++) {
         Simulator sim(3);
+        if (!functions.empty()) sim.load_functions(functions);
+        sim.set_rules(rules);
         sim.restore_state(initial_state);
-        results[i] = sim.simulate_program(programs[i]);
+        results[i] = sim.simulate_program(programs[i], cat_policy, crzbc_policy);
     }
 #else
     // 시리얼 버전
     for (size_t i = 0; i < programs.size(); i++) {
         Simulator sim(3);
+        if (!functions.empty()) sim.load_functions(functions);
+        sim.set_rules(rules);
         sim.restore_state(initial_state);
-        results[i] = sim.simulate_program(programs[i]);
+        results[i] = sim.simulate_program(programs[i], cat_policy, crzbc_policy);
+    }
+#endif
+
+    return results;
+}
+
+// ============================================================
+// 상태 x 프로그램 점수 행렬 (프로그램을 한 번 컴파일해 모든 상태에서 공유)
+// ============================================================
+std::vector<float> evaluate_matrix(
+    const std::vector<GameState>& states,
+    const std::vector<std::vector<int>>& programs,
+    int num_threads,
+    MovePolicy cat_policy,
+    MovePolicy crzbc_policy,
+    const std::vector<int>& functions,
+    const RuleSet& rules
+) {
+    std::vector<CompiledProgram> compiled(programs.size());
+    {
+        Simulator compiler(0);
+        if (!functions.empty()) compiler.load_functions(functions);
+        for (size_t p = 0; p < programs.size(); p++) {
+            compiled[p] = compiler.compile_program(programs[p]);
+        }
+    }
+    std::vector<const CompiledProgram*> ptrs(compiled.size());
+    for (size_t p = 0; p < compiled.size(); p++) ptrs[p] = &compiled[p];
+    return evaluate_compiled(states, ptrs, num_threads, cat_policy, crzbc_policy, rules);
+}
+
+// ============================================================
+// 컴파일된 프로그램 행렬 평가 (OpenMP 병렬, 두 축 타일링)
+// ============================================================
+std::vector<float> evaluate_compiled(
+    const std::vector<GameState>& states,
+    const std::vector<const CompiledProgram*>& compiled,
+    int num_threads,
+    MovePolicy cat_policy,
+    MovePolicy crzbc_policy,
+    const RuleSet& rules
+) {
+    const size_t n_states = states.size();
+    const size_t n_programs = compiled.size();
+    std::vector<float> results(n_states * n_programs);
+    if (n_states == 0 || n_programs == 0) return results;
+
+    // 타일 = (상태, 프로그램 블록), 상태 우선 순서
+    constexpr size_t BLOCK = 32;
+    const size_t n_blocks = (n_programs + BLOCK - 1) / BLOCK;
+    const int64_t n_tiles = static_cast<int64_t>(n_states * n_blocks);
+
+    auto run_tile = [&](Simulator& sim, int64_t& current, int64_t tile) {
+        const int64_t s = tile / static_cast<int64_t>(n_blocks);
+        if (s != current) {
+            sim.restore_state(states[s]);  // 맵이 같으면 토폴로지 / 거리 맵 재사용
+            current = s;
+        }
+        const size_t p0 = static_cast<size_t>(tile % static_cast<int64_t>(n_blocks)) * BLOCK;
+        const size_t p1 = std::min(p0 + BLOCK, n_programs);
+        float* row = results.data() + s * n_programs;
+        for (size_t p = p0; p < p1; p++) {
+            row[p] = sim.simulate_compiled(*compiled[p], cat_policy, crzbc_policy);
+        }
+    };
+
+#ifdef USE_OPENMP
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        Simulator sim(0);
+        sim.set_rules(rules);
+        int64_t current = -1;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int64_t t = 0; t < n_tiles; t++) {
+            run_tile(sim, current, t);
+        }
+    }
+#else
+    // 시리얼 버전
+    (void)num_threads;
+    Simulator sim(0);
+    sim.set_rules(rules);
+    int64_t current = -1;
+    for (int64_t t = 0; t < n_tiles; t++) {
+        run_tile(sim, current, t);
     }
 #endif
 
@@ -0,0 +1,108 @@
+#include "simulator_batch.hpp"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+namespace {
+
+// 작업 i = 0..n-1 을 포크 단위로 병렬 실행
+template <class Fn>
+void for_each_fork(int64_t n, int num_threads, Fn&& fn) {
+#ifdef USE_OPENMP
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+    for (int64_t i = 0; i < n; i++) {
+        fn(i);
+    }
+#else
+    // 시리얼 버전
+    (void)num_threads;
+    for (int64_t i = 0; i < n; i++) {
+        fn(i);
+    }
+#endif
+}
+
+} // namespace
+
+void SimulatorBatch::restore_all(const GameState& state) {
+    for (Simulator& sim : sims_) sim.restore_state(state);
+}
+
+void SimulatorBatch::seed_all(uint32_t base) {
+    for (size_t i = 0; i < sims_.size(); i++) sims_[i].seed(base + static_cast<uint32_t>(i));
+}
+
+// ============================================================
+// 포크별 한 런 진행 (끝난 게임은 건너뜀)
+// ============================================================
+std::vector<float> SimulatorBatch::step(const std::vector<std::vector<int>>& programs, int num_threads,
+                                        MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    const size_t n = std::min(programs.size(), sims_.size());
+    std::vector<float> scores(n, 0.0f);
+    for_each_fork(static_cast<int64_t>(n), num_threads, [&](int64_t i) {
+        Simulator& sim = sims_[i];
+        if (sim.is_win() || sim.is_lose()) return;
+        scores[i] = sim.execute_program(programs[i], cat_policy, crzbc_policy);
+    });
+    return scores;
+}
+
+std::vector<float> SimulatorBatch::step(const std::vector<const CompiledProgram*>& programs, int num_threads,
+                                        MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    const size_t n = std::min(programs.size(), sims_.size());
+    std::vector<float> scores(n, 0.0f);
+    for_each_fork(static_cast<int64_t>(n), num_threads, [&](int64_t i) {
+        Simulator& sim = sims_[i];
+        if (sim.is_win() || sim.is_lose()) return;
+        scores[i] = sim.execute_compiled(*programs[i], cat_policy, crzbc_policy);
+    });
+    return scores;
+}
+
+// ============================================================
+// 포크별 평가 (상태 변경 없음)
+// ============================================================
+std::vector<float> SimulatorBatch::simulate(const std::vector<std::vector<int>>& programs, int num_threads,
+                                            MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    const size_t n = std::min(programs.size(), sims_.size());
+    std::vector<float> scores(n);
+    for_each_fork(static_cast<int64_t>(n), num_threads, [&](int64_t i) {
+        scores[i] = sims_[i].simulate_program(programs[i], cat_policy, crzbc_policy);
+    });
+    return scores;
+}
+
+std::vector<float> SimulatorBatch::simulate(const std::vector<const CompiledProgram*>& programs, int num_threads,
+                                            MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    const size_t n = std::min(programs.size(), sims_.size());
+    std::vector<float> scores(n);
+    for_each_fork(static_cast<int64_t>(n), num_threads, [&](int64_t i) {
+        scores[i] = sims_[i].simulate_compiled(*programs[i], cat_policy, crzbc_policy);
+    });
+    return scores;
+}
+
+// ============================================================
+// 포크 x 프로그램 행렬 (포크 하나가 자기 상태에서 모든 프로그램 평가)
+// ============================================================
+std::vector<float> SimulatorBatch::evaluate(const std::vector<const CompiledProgram*>& programs, int num_threads,
+                                            MovePolicy cat_policy, MovePolicy crzbc_policy) {
+    const size_t n_programs = programs.size();
+    std::vector<float> out(sims_.size() * n_programs);
+    for_each_fork(static_cast<int64_t>(sims_.size()), num_threads, [&](int64_t f) {
+        float* row = out.data() + f * n_programs;
+        for (size_t p = 0; p < n_programs; p++) {
+            row[p] = sims_[f].simulate_compiled(*programs[p], cat_policy, crzbc_policy);
+        }
+    });
+    return out;
+}
+
+} // namespace simulator
@@ -0,0 +1,176 @@
+#include "state_codec.hpp"
+#include <cstring>
+
+namespace simulator {
+namespace StateCodec {
+
+namespace {
+
+// 맵 안이거나 빈 슬롯 (-1, -1)
+inline bool valid_slot(int8_t x, int8_t y) {
+    return (x == -1 && y == -1) || Position(x, y).is_valid();
+}
+
+struct Writer {
+    uint8_t* p;
+
+    void u8(uint8_t v) { *p++ = v; }
+    void i16(int16_t v) {
+        uint16_t u = static_cast<uint16_t>(v);
+        u8(static_cast<uint8_t>(u));
+        u8(static_cast<uint8_t>(u >> 8));
+    }
+    void i32(int32_t v) {
+        uint32_t u = static_cast<uint32_t>(v);
+        for (int k = 0; k < 4; k++) u8(static_cast<uint8_t>(u >> (8 * k)));
+    }
+    void mask(const GridMap& g) {
+        std::memset(p, 0, MASK_BYTES);
+        int c = 0;
+        for (int i = 0; i < MAP_SIZE; i++) {
+            for (int j = 0; j < MAP_SIZE; j++, c++) {
+                p[c >> 3] |= static_cast<uint8_t>((g[i][j] != 0) << (c & 7));
+            }
+        }
+        p += MASK_BYTES;
+    }
+    void grid(const GridMap& g) {
+        // 행 우선 연속 배치 = 칸 번호 순서
+        static_assert(sizeof(GridMap) == TOTAL_CELLS, "GridMap must be contiguous");
+        std::memcpy(p, g.data(), TOTAL_CELLS);
+        p += TOTAL_CELLS;
+    }
+    template <int MAX_N>
+    void entities(const EntityArray<MAX_N>& e) {
+        u8(static_cast<uint8_t>(e.count));
+        for (int i = 0; i < MAX_N; i++) {
+            u8(static_cast<uint8_t>(e.x[i]));
+            u8(static_cast<uint8_t>(e.y[i]));
+            u8(static_cast<uint8_t>(e.last_x[i]));
+            u8(static_cast<uint8_t>(e.last_y[i]));
+            u8(static_cast<uint8_t>(e.direction[i]));
+            u8(e.active[i]);
+        }
+    }
+};
+
+struct Reader {
+    const uint8_t* p;
+
+    uint8_t u8() { return *p++; }
+    int8_t i8() { return static_cast<int8_t>(u8()); }
+    int16_t i16() {
+        uint16_t u = u8();
+        u |= static_cast<uint16_t>(u8()) << 8;
+        return static_cast<int16_t>(u);
+    }
+    int32_t i32() {
+        uint32_t u = 0;
+        for (int k = 0; k < 4; k++) u |= static_cast<uint32_t>(u8()) << (8 * k);
+        return static_cast<int32_t>(u);
+    }
+    void mask(GridMap& g) {
+        for (int c = 0; c < TOTAL_CELLS; c++) {
+            g[c / MAP_SIZE][c % MAP_SIZE] = static_cast<int8_t>((p[c >> 3] >> (c & 7)) & 1u);
+        }
+        p += MASK_BYTES;
+    }
+    // 개수가 [0, MAX_N] 밖이거나 위치가 맵 밖이면 false
+    template <int MAX_N>
+    bool entities(EntityArray<MAX_N>& e) {
+        e.count = i8();
+        bool ok = e.count >= 0 && e.count <= MAX_N;
+        for (int i = 0; i < MAX_N; i++) {
+            e.x[i] = i8();
+            e.y[i] = i8();
+            e.last_x[i] = i8();
+            e.last_y[i] = i8();
+            e.direction[i] = i8();
+            e.active[i] = u8();
+            ok = ok && valid_slot(e.x[i], e.y[i]) && valid_slot(e.last_x[i], e.last_y[i]);
+        }
+        return ok;
+    }
+};
+
+} // namespace
+
+void encode(const GameState& state, uint8_t* out) {
+    Writer w{out};
+    w.mask(state.wall);
+    w.mask(state.junc);
+    w.mask(state.deadend);
+    encode_dynamic(state, out);
+}
+
+void encode_dynamic(const GameState& state, uint8_t* out) {
+    Writer w{out + 3 * MASK_BYTES};
+    w.grid(state.sc);
+
+    w.u8(static_cast<uint8_t>(state.mouse.x));
+    w.u8(static_cast<uint8_t>(state.mouse.y));
+    w.u8(static_cast<uint8_t>(state.mouse_last.x));
+    w.u8(static_cast<uint8_t>(state.mouse_last.y));
+    w.entities(state.cats);
+    w.entities(state.movbc);
+    w.entities(state.crzbc);
+
+    w.i32(state.score);
+    w.i16(state.life);
+    w.i16(state.step);
+    w.i16(state.step_limit);
+    w.i16(state.run);
+    w.u8(static_cast<uint8_t>(state.func_chance));
+    w.u8(static_cast<uint8_t>(state.red_zone));
+    w.u8(static_cast<uint8_t>((state.win_sign ? 1 : 0) | (state.lose_sign ? 2 : 0) | (state.catched ? 4 : 0)));
+}
+
+bool decode(const uint8_t* in, GameState& state) {
+    Reader r{in};
+    r.mask(state.wall);
+    r.mask(state.junc);
+    r.mask(state.deadend);
+    for (int c = 0; c < TOTAL_CELLS; c++) state.sc[c / MAP_SIZE][c % MAP_SIZE] = r.i8();
+
+    state.mouse.x = r.i8();
+    state.mouse.y = r.i8();
+    state.mouse_last.x = r.i8();
+    state.mouse_last.y = r.i8();
+    bool ok = state.mouse.is_valid() && valid_slot(state.mouse_last.x, state.mouse_last.y);
+    ok = r.entities(state.cats) && ok;
+    ok = r.entities(state.movbc) && ok;
+    ok = r.entities(state.crzbc) && ok;
+
+    state.score = r.i32();
+    state.life = r.i16();
+    state.step = r.i16();
+    state.step_limit = r.i16();
+    state.run = r.i16();
+    state.func_chance = r.i8();
+    state.red_zone = r.i8();
+    uint8_t flags = r.u8();
+    state.win_sign = flags & 1;
+    state.lose_sign = (flags & 2) != 0;
+    state.catched = (flags & 4) != 0;
+    return ok;
+}
+
+std::vector<uint8_t> encode_all(const std::vector<GameState>& states) {
+    std::vector<uint8_t> blob(states.size() * RECORD_SIZE);
+    for (size_t i = 0; i < states.size(); i++) encode(states[i], blob.data() + i * RECORD_SIZE);
+    return blob;
+}
+
+bool decode_all(const uint8_t* blob, size_t n, std::vector<GameState>& states) {
+    states.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        if (!decode(blob + i * RECORD_SIZE, states[i])) {
+            states.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace StateCodec
+} // namespace simulator
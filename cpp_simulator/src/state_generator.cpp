@@ -0,0 +1,293 @@
+#include "state_generator.hpp"
+#include "state_codec.hpp"
+#include "bitboard.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+namespace {
+
+constexpr uint8_t UNREACHABLE = 255;
+constexpr int START_CELL = 10 * MAP_SIZE + 10;
+
+inline uint64_t mix_seed(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 상태 하나용 SplitMix64 (시드 비용 없음, 상태당 수백 번 뽑음)
+struct StateRng {
+    uint64_t s;
+
+    uint64_t next() {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    // [0, n)
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+    // [lo, hi]
+    int range(int lo, int hi) { return lo + static_cast<int>(below(static_cast<uint32_t>(hi - lo + 1))); }
+    // [0, 1)
+    float unit() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+};
+
+inline Position cell_pos(int cell) {
+    return Position(static_cast<int8_t>(cell / MAP_SIZE), static_cast<int8_t>(cell % MAP_SIZE));
+}
+
+} // namespace
+
+// ============================================================
+// 생성기 준비: 설정 정리, 빈 칸 / 치즈 후보 / 칸 간 거리표
+// ============================================================
+StateGenerator::StateGenerator(const StateGenConfig& config) : config_(config) {
+    base_.init_level3();
+    init();
+}
+
+StateGenerator::StateGenerator(const StateGenConfig& config, const GameState& base)
+    : config_(config), base_(base) {
+    init();
+}
+
+void StateGenerator::init() {
+    StateGenConfig& c = config_;
+    c.cheese_min = std::min(std::max(c.cheese_min, 0.0f), 1.0f);
+    c.cheese_max = std::min(std::max(c.cheese_max, c.cheese_min), 1.0f);
+    c.num_cats = std::min(std::max(c.num_cats, 0), Config::MAX_CATS);
+    c.life_min = std::max(c.life_min, 1);
+    c.life_max = std::max(c.life_max, c.life_min);
+    c.run_min = std::max(c.run_min, 0);
+    c.run_max = std::min(std::max(c.run_max, c.run_min), Config::MAX_RUNS - 1);
+    c.step_min = std::max(c.step_min, 0);
+    c.step_max = std::max(c.step_max, c.step_min);
+
+    open_.clear();
+    cheese_.clear();
+    open_dirs_.assign(TOTAL_CELLS, 0);
+    for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+        const int x = cell / MAP_SIZE, y = cell % MAP_SIZE;
+        if (base_.wall[x][y]) continue;
+        open_.push_back(static_cast<int16_t>(cell));
+        if (base_.sc[x][y]) cheese_.push_back(static_cast<int16_t>(cell));
+        for (int d = 0; d < Direction::COUNT; d++) {
+            const int nx = x + Direction::DX[d], ny = y + Direction::DY[d];
+            if (nx >= 0 && nx < MAP_SIZE && ny >= 0 && ny < MAP_SIZE && !base_.wall[nx][ny]) {
+                open_dirs_[cell] |= static_cast<uint8_t>(1u << d);
+            }
+        }
+    }
+    // 치즈가 없는 맵이면 모든 빈 칸이 후보 (시작 칸 제외)
+    if (cheese_.empty()) {
+        for (int16_t cell : open_) {
+            if (cell != START_CELL) cheese_.push_back(cell);
+        }
+    }
+
+    // 칸마다 BFS (빈 칸만)
+    dist_.assign(TOTAL_CELLS * TOTAL_CELLS, UNREACHABLE);
+    std::vector<int16_t> queue(TOTAL_CELLS);
+    for (int16_t src : open_) {
+        uint8_t* d = dist_.data() + src * TOTAL_CELLS;
+        size_t head = 0, tail = 0;
+        d[src] = 0;
+        queue[tail++] = src;
+        while (head < tail) {
+            const int cell = queue[head++];
+            for (int dir = 0; dir < Direction::COUNT; dir++) {
+                if (!(open_dirs_[cell] & (1u << dir))) continue;
+                const int next = cell + Direction::DX[dir] * MAP_SIZE + Direction::DY[dir];
+                if (d[next] != UNREACHABLE) continue;
+                d[next] = static_cast<uint8_t>(d[cell] + 1);
+                queue[tail++] = static_cast<int16_t>(next);
+            }
+        }
+    }
+
+    // 기준 상태는 맵 + 스칼라 기본값만 남김
+    for (auto& row : base_.sc) row.fill(0);
+    base_.cats.clear();
+    base_.movbc.clear();
+    base_.crzbc.clear();
+    base_.score = 0;
+    base_.life = Config::DEFAULT_LIFE;
+    base_.step = 0;
+    base_.run = 0;
+    base_.win_sign = false;
+    base_.lose_sign = false;
+    base_.catched = false;
+
+    // 맵 마스크는 모든 레코드에 공통
+    std::vector<uint8_t> record(StateCodec::RECORD_SIZE);
+    StateCodec::encode(base_, record.data());
+    std::memcpy(map_masks_, record.data(), sizeof(map_masks_));
+}
+
+// ============================================================
+// 상태 하나 생성
+// ============================================================
+void StateGenerator::generate_one(uint64_t index, GameState& out) const {
+    const StateGenConfig& c = config_;
+    StateRng rng{mix_seed(c.seed, index)};
+    out = base_;
+    if (!valid()) return;
+
+    const uint32_t n_open = static_cast<uint32_t>(open_.size());
+    CellMask occupied;
+
+    // 마우스
+    int mouse = open_[rng.below(n_open)];
+    if (c.mouse_at_start > 0.0f && rng.unit() < c.mouse_at_start && !base_.wall[10][10]) {
+        mouse = START_CELL;
+    }
+    out.mouse = cell_pos(mouse);
+    out.mouse_last = out.mouse;
+    occupied.set(mouse);
+
+    // 작은 치즈 (마우스 칸은 이미 먹은 것으로)
+    // 난수 하나를 16비트 4개로 나눠 칸마다 비교
+    const float keep = c.cheese_min + (c.cheese_max - c.cheese_min) * rng.unit();
+    const uint32_t threshold = static_cast<uint32_t>(keep * 65536.0f);
+    int8_t* sc = &out.sc[0][0];
+    int kept = 0;
+    uint64_t bits = 0;
+    for (size_t k = 0; k < cheese_.size(); k++) {
+        if ((k & 3) == 0) bits = rng.next();
+        const int cell = cheese_[k];
+        const int8_t on = static_cast<int8_t>((static_cast<uint32_t>(bits & 0xFFFF) < threshold) & (cell != mouse));
+        bits >>= 16;
+        sc[cell] = on;
+        kept += on;
+    }
+    int eaten = static_cast<int>(cheese_.size()) - kept;
+    if (kept == 0) {
+        // 남은 치즈 0개면 이미 승리한 상태 → 임의 위치부터 훑어 마우스 칸이 아닌 첫 후보를 되살림
+        // (후보가 2개 이상이므로 항상 있음)
+        const size_t n = cheese_.size();
+        size_t k = rng.below(static_cast<uint32_t>(n));
+        if (cheese_[k] == mouse) k = k + 1 == n ? 0 : k + 1;
+        sc[cheese_[k]] = 1;
+        eaten--;
+    }
+
+    // 빈 칸 하나 (occupied 제외, min_dist: 마우스까지 거리 하한, 실패하면 가장 먼 칸)
+    const uint8_t* from_mouse = dist_.data() + mouse * TOTAL_CELLS;
+    auto place = [&](int min_dist) {
+        for (int tries = 0; tries < Config::MAX_RANDOM_TRIES; tries++) {
+            const int cell = open_[rng.below(n_open)];
+            if (!occupied.test(cell) && from_mouse[cell] >= min_dist) return cell;
+        }
+        int best = -1;
+        for (int16_t cell : open_) {
+            if (occupied.test(cell)) continue;
+            if (best < 0 || from_mouse[cell] > from_mouse[best]) best = cell;
+        }
+        return best;
+    };
+    // 막히지 않은 방향 중 하나
+    auto open_direction = [&](int cell) {
+        const uint8_t dirs = open_dirs_[cell];
+        if (!dirs) return static_cast<int8_t>(rng.below(Direction::COUNT));
+        uint32_t k = rng.below(static_cast<uint32_t>(__builtin_popcount(dirs)));
+        for (int d = 0; d < Direction::COUNT; d++) {
+            if ((dirs & (1u << d)) && k-- == 0) return static_cast<int8_t>(d);
+        }
+        return static_cast<int8_t>(0);
+    };
+
+    for (int i = 0; i < c.num_cats; i++) {
+        const int cell = place(c.min_cat_distance);
+        if (cell < 0) break;
+        occupied.set(cell);
+        out.cats.add(cell_pos(cell), open_direction(cell));
+    }
+
+    // 빅치즈 (먹힌 것은 (-1, -1))
+    const Position gone(-1, -1);
+    int big_eaten = 0;
+    for (int i = 0; i < Config::NUM_MOVBC; i++) {
+        const int cell = rng.unit() < c.movbc_alive ? place(1) : -1;
+        if (cell < 0) {
+            const int slot = out.movbc.add(gone);
+            out.movbc.active[slot] = 0;
+            big_eaten++;
+            continue;
+        }
+        occupied.set(cell);
+        out.movbc.add(cell_pos(cell));
+    }
+    for (int i = 0; i < Config::NUM_CRZBC; i++) {
+        const int cell = rng.unit() < c.crzbc_alive ? place(1) : -1;
+        if (cell < 0) {
+            const int slot = out.crzbc.add(gone);
+            out.crzbc.active[slot] = 0;
+            big_eaten++;
+            continue;
+        }
+        occupied.set(cell);
+        out.crzbc.add(cell_pos(cell), open_direction(cell));
+    }
+
+    // 스칼라 (run마다 목숨은 최대 하나, 치즈 하나에 최소 한 스텝)
+    out.run = static_cast<int16_t>(rng.range(c.run_min, c.run_max));
+    const int life_lo = std::min(std::max(c.life_min, Config::DEFAULT_LIFE - out.run), c.life_max);
+    out.life = static_cast<int16_t>(rng.range(life_lo, c.life_max));
+    int step = std::max(rng.range(c.step_min, c.step_max), eaten);
+    out.step = static_cast<int16_t>(std::min(step, std::max(out.step_limit - 1, 0)));
+    if (c.consistent_score) {
+        out.score = eaten * Score::SMALL_CHEESE + big_eaten * Score::BIG_CHEESE +
+                    std::max(Config::DEFAULT_LIFE - out.life, 0) * Score::CAT_COLLISION;
+    }
+}
+
+// ============================================================
+// 레코드 배치 생성 (OpenMP 병렬)
+// ============================================================
+void StateGenerator::generate(uint64_t first, size_t n, uint8_t* out) const {
+    const int64_t count = static_cast<int64_t>(n);
+
+#ifdef USE_OPENMP
+    int num_threads = config_.num_threads;
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        GameState state;
+        #pragma omp for schedule(static)
+        for (int64_t i = 0; i < count; i++) {
+            uint8_t* record = out + i * StateCodec::RECORD_SIZE;
+            generate_one(first + static_cast<uint64_t>(i), state);
+            std::memcpy(record, map_masks_, sizeof(map_masks_));
+            StateCodec::encode_dynamic(state, record);
+        }
+    }
+#else
+    // 시리얼 버전
+    GameState state;
+    for (int64_t i = 0; i < count; i++) {
+        uint8_t* record = out + i * StateCodec::RECORD_SIZE;
+        generate_one(first + static_cast<uint64_t>(i), state);
+        std::memcpy(record, map_masks_, sizeof(map_masks_));
+        StateCodec::encode_dynamic(state, record);
+    }
+#endif
+}
+
+std::vector<uint8_t> StateGenerator::generate(uint64_t first, size_t n) const {
+    std::vector<uint8_t> blob(n * StateCodec::RECORD_SIZE);
+    generate(first, n, blob.data());
+    return blob;
+}
+
+} // namespace simulator
@@ -0,0 +1,91 @@
+#include "step_journal.hpp"
+#include <algorithm>
+
+namespace simulator {
+
+// ============================================================
+// 기록 / 되돌리기
+// ============================================================
+void JournalEntry::capture(const GameState& before, uint64_t draws) {
+    eaten = CellMask();
+    mouse = before.mouse;
+    mouse_last = before.mouse_last;
+    cats = before.cats;
+    movbc = before.movbc;
+    crzbc = before.crzbc;
+
+    score = before.score;
+    life = before.life;
+    step = before.step;
+    run = before.run;
+    step_limit = before.step_limit;
+    func_chance = before.func_chance;
+    red_zone = before.red_zone;
+    win_sign = before.win_sign;
+    lose_sign = before.lose_sign;
+    catched = before.catched;
+    rng_draws = draws;
+}
+
+void JournalEntry::revert(GameState& state) const {
+    // 먹은 칸 비트만 순회 (sc는 행 우선 연속 배치)
+    int8_t* sc = &state.sc[0][0];
+    for (uint64_t w = eaten.lo; w; w &= w - 1) sc[__builtin_ctzll(w)] = 1;
+    for (uint64_t w = eaten.hi; w; w &= w - 1) sc[64 + __builtin_ctzll(w)] = 1;
+    state.mouse = mouse;
+    state.mouse_last = mouse_last;
+    state.cats = cats;
+    state.movbc = movbc;
+    state.crzbc = crzbc;
+
+    state.score = score;
+    state.life = life;
+    state.step = step;
+    state.run = run;
+    state.step_limit = step_limit;
+    state.func_chance = func_chance;
+    state.red_zone = red_zone;
+    state.win_sign = win_sign;
+    state.lose_sign = lose_sign;
+    state.catched = catched;
+}
+
+// ============================================================
+// 저널
+// ============================================================
+StepJournal::StepJournal(size_t capacity) : entries_(std::max<size_t>(capacity, 1)) {
+    checkpoints_.reserve(entries_.size() + 1);
+}
+
+void StepJournal::clear() {
+    depth_ = 0;
+    checkpoints_.clear();
+}
+
+JournalEntry& StepJournal::begin(uint32_t epoch, const CountedRng& rng) {
+    if (epoch != epoch_) {
+        clear();
+        epoch_ = epoch;
+    }
+    if (checkpoints_.empty() || rng.draws() - checkpoints_.back().draws >= CHECKPOINT_INTERVAL) {
+        checkpoints_.push_back(RngCheckpoint{rng.draws(), rng.engine()});
+    }
+    if (depth_ == entries_.size()) {
+        entries_.resize(entries_.size() * 2);
+        checkpoints_.reserve(entries_.size() + 1);
+    }
+    return entries_[depth_++];
+}
+
+const JournalEntry& StepJournal::pop(CountedRng& rng) {
+    const JournalEntry& entry = entries_[--depth_];
+    // 이 런 시작 이후에 저장한 사본은 버림 (런 시작 시점 사본은 유지)
+    while (checkpoints_.back().draws > entry.rng_draws) checkpoints_.pop_back();
+    if (rng.draws() != entry.rng_draws) {
+        const RngCheckpoint& cp = checkpoints_.back();
+        rng.rewind(cp.engine, cp.draws, entry.rng_draws);
+    }
+    return entry;
+}
+
+} // namespace simulator
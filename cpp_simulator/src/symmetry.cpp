@@ -0,0 +1,294 @@
+#include "symmetry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+// ============================================================
+// 그리드 / 상태 변환
+// ============================================================
+void transform_grid(const GridMap& in, GridMap& out, Symmetry sym) {
+    for (int i = 0; i < MAP_SIZE; i++) {
+        for (int j = 0; j < MAP_SIZE; j++) {
+            Position p = transform_pos(Position(i, j), sym);
+            out[p.x][p.y] = in[i][j];
+        }
+    }
+}
+
+template <int MAX_N>
+static void transform_entities(const EntityArray<MAX_N>& in, EntityArray<MAX_N>& out, Symmetry sym) {
+    out = in;
+    for (int i = 0; i < MAX_N; i++) {
+        out.set_pos(i, transform_pos(in.pos(i), sym));
+        out.set_last_pos(i, transform_pos(in.last_pos(i), sym));
+        out.direction[i] = static_cast<int8_t>(transform_dir(in.direction[i], sym));
+    }
+}
+
+GameState transform_state(const GameState& state, Symmetry sym) {
+    GameState out = state;
+    if (sym == Symmetry::IDENTITY) return out;
+
+    transform_grid(state.wall, out.wall, sym);
+    transform_grid(state.sc, out.sc, sym);
+    transform_grid(state.junc, out.junc, sym);
+    transform_grid(state.deadend, out.deadend, sym);
+
+    out.mouse = transform_pos(state.mouse, sym);
+    out.mouse_last = transform_pos(state.mouse_last, sym);
+    transform_entities(state.cats, out.cats, sym);
+    transform_entities(state.movbc, out.movbc, sym);
+    transform_entities(state.crzbc, out.crzbc, sym);
+    return out;
+}
+
+// ============================================================
+// 대칭 검출
+// ============================================================
+static bool grid_invariant(const GridMap& g, Symmetry sym) {
+    for (int i = 0; i < MAP_SIZE; i++) {
+        for (int j = 0; j < MAP_SIZE; j++) {
+            Position p = transform_pos(Position(i, j), sym);
+            if (g[p.x][p.y] != g[i][j]) return false;
+        }
+    }
+    return true;
+}
+
+uint8_t detect_map_symmetries(const GameState& state) {
+    uint8_t mask = 1u;  // IDENTITY
+    for (int s = 1; s < NUM_SYMMETRIES; s++) {
+        Symmetry sym = static_cast<Symmetry>(s);
+        if (grid_invariant(state.wall, sym) &&
+            grid_invariant(state.junc, sym) &&
+            grid_invariant(state.deadend, sym)) {
+            mask |= static_cast<uint8_t>(1u << s);
+        }
+    }
+    return mask;
+}
+
+// ============================================================
+// 상태 해시 (FNV-1a 64)
+// ============================================================
+namespace {
+
+struct Fnv64 {
+    uint64_t h = 1469598103934665603ULL;
+
+    void bytes(const void* data, size_t n) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < n; i++) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    }
+
+    template <class T>
+    void value(const T& v) { bytes(&v, sizeof(T)); }
+
+    template <int MAX_N>
+    void entities(const EntityArray<MAX_N>& e) {
+        value(e.count);
+        bytes(e.x.data(), MAX_N);
+        bytes(e.y.data(), MAX_N);
+        bytes(e.last_x.data(), MAX_N);
+        bytes(e.last_y.data(), MAX_N);
+        bytes(e.direction.data(), MAX_N);
+        bytes(e.active.data(), MAX_N);
+    }
+};
+
+} // namespace
+
+uint64_t state_hash(const GameState& state) {
+    Fnv64 f;
+    f.bytes(&state.wall, sizeof(GridMap));
+    f.bytes(&state.sc, sizeof(GridMap));
+    f.bytes(&state.junc, sizeof(GridMap));
+    f.bytes(&state.deadend, sizeof(GridMap));
+    f.value(state.mouse.x);
+    f.value(state.mouse.y);
+    f.value(state.mouse_last.x);
+    f.value(state.mouse_last.y);
+    f.entities(state.cats);
+    f.entities(state.movbc);
+    f.entities(state.crzbc);
+    f.value(state.score);
+    f.value(state.life);
+    f.value(state.step);
+    f.value(state.step_limit);
+    f.value(state.run);
+    f.value(state.func_chance);
+    f.value(state.red_zone);
+    uint8_t flags = (state.win_sign ? 1 : 0) | (state.lose_sign ? 2 : 0) | (state.catched ? 4 : 0);
+    f.value(flags);
+    return f.h;
+}
+
+// ============================================================
+// MapSymmetry
+// ============================================================
+MapSymmetry::MapSymmetry(const GameState& map_state, const FunctionLibrary& lib)
+    : mask_(detect_map_symmetries(map_state))
+{
+    // 본문 → 가장 작은 함수 ID (중복 본문이 많음: 예) {2} x 199)
+    std::map<std::vector<int>, int> body_to_id;
+    lib.for_each_function([&](int id, const std::vector<int>& body) {
+        auto it = body_to_id.find(body);
+        if (it == body_to_id.end() || id < it->second) {
+            body_to_id[body] = id;
+        }
+    });
+
+    const int n_ids = Token::FUNC_LIB_END - Token::FUNC_LIB_START + 1;
+    for (int s = 0; s < NUM_SYMMETRIES; s++) {
+        Symmetry sym = static_cast<Symmetry>(s);
+        auto& table = func_map_[s];
+        table.assign(n_ids, -1);
+        if (!has(sym)) continue;
+
+        lib.for_each_function([&](int id, const std::vector<int>& body) {
+            if (!Token::is_func_lib(id)) return;
+            std::vector<int> image = transform_body(body, sym);
+            int mapped = -1;
+            if (image == body) {
+                mapped = id;  // 대칭 불변 함수는 자기 자신
+            } else {
+                auto it = body_to_id.find(image);
+                if (it != body_to_id.end()) mapped = it->second;
+            }
+            table[id - Token::FUNC_LIB_START] = static_cast<int16_t>(mapped);
+        });
+    }
+}
+
+std::vector<Symmetry> MapSymmetry::symmetries() const {
+    std::vector<Symmetry> result;
+    for (int s = 0; s < NUM_SYMMETRIES; s++) {
+        if (has(static_cast<Symmetry>(s))) result.push_back(static_cast<Symmetry>(s));
+    }
+    return result;
+}
+
+int MapSymmetry::transform_function(int func_id, Symmetry sym) const {
+    if (!Token::is_func_lib(func_id)) return -1;
+    return func_map_[static_cast<int>(sym)][func_id - Token::FUNC_LIB_START];
+}
+
+int MapSymmetry::mappable_functions(Symmetry sym) const {
+    int n = 0;
+    for (int16_t id : func_map_[static_cast<int>(sym)]) {
+        n += id >= 0;
+    }
+    return n;
+}
+
+bool MapSymmetry::transform_program(const std::vector<int>& program, Symmetry sym,
+                                    std::vector<int>& out) const {
+    out.clear();
+    if (!has(sym)) return false;
+    out.reserve(program.size());
+
+    // F1/F2 배정(및 세 번째 이후 무시)은 "서로 다른 함수 ID" 등장 순서로 결정
+    // → 프로그램에 나온 ID들에 대해 변환이 단사여야 의미가 보존됨
+    std::vector<std::pair<int, int>> seen;  // (원본 ID, 변환 ID)
+
+    for (int token : program) {
+        if (Token::is_direction(token)) {
+            out.push_back(transform_dir(token, sym));
+        } else if (Token::is_func_lib(token)) {
+            int mapped = transform_function(token, sym);
+            if (mapped < 0) return false;
+
+            bool known = false;
+            for (const auto& kv : seen) {
+                if (kv.first == token) { known = true; break; }
+                if (kv.second == mapped) return false;
+            }
+            if (!known) seen.emplace_back(token, mapped);
+            out.push_back(mapped);
+        } else {
+            out.push_back(token);
+        }
+    }
+    return true;
+}
+
+MapSymmetry::Canonical MapSymmetry::canonicalize(const GameState& state,
+                                                 const std::vector<int>& program) const {
+    Canonical best{state, program, Symmetry::IDENTITY, state_hash(state)};
+    std::vector<int> mapped;
+
+    for (int s = 1; s < NUM_SYMMETRIES; s++) {
+        Symmetry sym = static_cast<Symmetry>(s);
+        if (!has(sym)) continue;
+        if (!transform_program(program, sym, mapped)) continue;
+
+        GameState st = transform_state(state, sym);
+        uint64_t h = state_hash(st);
+        if (h < best.hash) {
+            best.state = st;
+            best.program = mapped;
+            best.sym = sym;
+            best.hash = h;
+        }
+    }
+    return best;
+}
+
+// ============================================================
+// 상태 벡터 증강 (그리드 칸 치환 + 좌표 변환, 스칼라 / 패딩은 복사)
+// ============================================================
+bool MapSymmetry::transform_state_vectors(const float* in, float* out, size_t n, Symmetry sym,
+                                          VectorLayout layout) {
+    if (layout != VectorLayout::STATE_VEC) return false;
+
+    std::array<int, TOTAL_CELLS> cell_map;
+    for (int i = 0; i < MAP_SIZE; i++) {
+        for (int j = 0; j < MAP_SIZE; j++) {
+            Position p = transform_pos(Position(i, j), sym);
+            cell_map[i * MAP_SIZE + j] = p.x * MAP_SIZE + p.y;
+        }
+    }
+
+    const int64_t rows = static_cast<int64_t>(n);
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int64_t r = 0; r < rows; r++) {
+        const float* src = in + r * StateVec::DIM;
+        float* dst = out + r * StateVec::DIM;
+
+        std::copy(src + StateVec::MOUSE_OFFSET, src + StateVec::DIM, dst + StateVec::MOUSE_OFFSET);
+
+        for (int g = 0; g < StateVec::NUM_GRIDS; g++) {
+            const float* gs = src + StateVec::GRID_OFFSET + g * TOTAL_CELLS;
+            float* gd = dst + StateVec::GRID_OFFSET + g * TOTAL_CELLS;
+            for (int c = 0; c < TOTAL_CELLS; c++) {
+                gd[cell_map[c]] = gs[c];
+            }
+        }
+
+        for (int k = 0; k < StateVec::NUM_POSITIONS; k++) {
+            int off = StateVec::MOUSE_OFFSET + 2 * k;
+            Position p(static_cast<int8_t>(std::lround(src[off])),
+                       static_cast<int8_t>(std::lround(src[off + 1])));
+            if (!p.is_valid()) continue;  // 빈 슬롯 (-1, -1)
+            Position q = transform_pos(p, sym);
+            dst[off] = q.x;
+            dst[off + 1] = q.y;
+        }
+    }
+    return true;
+}
+
+} // namespace simulator
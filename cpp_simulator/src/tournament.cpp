@@ -0,0 +1,348 @@
+#include "tournament.hpp"
+#include "grpo_sampler.hpp"
+#include "simulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace simulator {
+
+namespace {
+
+constexpr double Z95 = 1.959963984540054;
+
+// (seed, salt, index) → 독립 시드
+inline uint64_t mix_seed(uint64_t seed, uint64_t salt, uint64_t index) {
+    uint64_t z = seed ^ (salt * 0xD1B54A32D192ED03ULL);
+    z += 0x9E3779B97F4A7C15ULL * (index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr uint64_t GAME_SALT = 1;
+constexpr uint64_t SEARCH_SALT = 2;
+
+int effective_length(const std::vector<int>& program) {
+    int n = 0;
+    for (int t : program) n += t != Token::END;
+    return n;
+}
+
+// ============================================================
+// Running Max (game_worker.generate_running_max_standalone 포팅)
+// 후보 점수는 항상 런 시작 상태에서 (현재 프로그램 + 후보)를 실행한 값
+// ============================================================
+std::vector<int> running_max_program(Simulator& sim, const SearchPolicy& policy, const TournamentConfig& config,
+                                     float base, std::mt19937_64& rng, uint64_t& sims) {
+    static const int LOOP_NUMS[] = {104, 105, 106, 107, 108, 109, 100};
+    constexpr int N_LOOP_CANDIDATES = 96;
+    const int structure_ban = policy.max_tokens - 2;
+
+    std::vector<int> program;
+    std::vector<int> trial;
+    std::vector<std::vector<int>> candidates;
+    std::vector<size_t> best;
+
+    while (static_cast<int>(program.size()) < policy.max_tokens) {
+        candidates.clear();
+        for (int d = 0; d < Direction::COUNT; d++) candidates.push_back({d});
+        const size_t n_dirs = candidates.size();
+        if (static_cast<int>(program.size()) < structure_ban) {
+            for (int k = 0; k < N_LOOP_CANDIDATES; k++) {
+                int num = LOOP_NUMS[rng() % (sizeof(LOOP_NUMS) / sizeof(LOOP_NUMS[0]))];
+                int dir = static_cast<int>(rng() % Direction::COUNT);
+                candidates.push_back({Token::LOOP, num, dir});
+            }
+        }
+
+        double best_score = -std::numeric_limits<double>::infinity();
+        best.clear();
+        for (size_t c = 0; c < candidates.size(); c++) {
+            trial = program;
+            trial.insert(trial.end(), candidates[c].begin(), candidates[c].end());
+            double score = sim.simulate_program(trial, config.cat_policy, config.crzbc_policy) - base;
+            sims++;
+            if (c < n_dirs) {
+                score += 15.0;
+            } else {
+                score *= 0.5;
+            }
+            if (score > best_score) {
+                best_score = score;
+                best.clear();
+            }
+            if (score == best_score) best.push_back(c);
+        }
+
+        const std::vector<int>& pick = candidates[best[rng() % best.size()]];
+        program.insert(program.end(), pick.begin(), pick.end());
+    }
+    program.push_back(Token::END);
+    return program;
+}
+
+} // namespace
+
+// ============================================================
+// 한 런의 탐색 (런 시작 상태 → 정렬된 후보 그룹)
+// ============================================================
+SearchResult search_run(Simulator& sim, const GameState& state, const SearchPolicy& policy,
+                        const TournamentConfig& config, const std::vector<float>& probs,
+                        std::mt19937_64& rng) {
+    sim.restore_state(state);
+    sim.seed(static_cast<uint32_t>(rng()));
+    const float base = static_cast<float>(state.score);
+    const int evals = std::max(policy.evals, 1);
+    const int budget = std::max(policy.budget, 1);
+
+    SearchResult result;
+    std::vector<std::vector<int>> programs;
+    std::vector<double> totals;
+    int done_evals = 0;
+
+    if (policy.kind == SearchKind::SAMPLED) {
+        GroupSamplerConfig gc;
+        gc.group_size = budget;
+        gc.max_tokens = policy.max_tokens;
+        gc.temperature = policy.temperature;
+        gc.seed = rng();
+        gc.num_threads = 1;
+        gc.cat_policy = config.cat_policy;
+        gc.crzbc_policy = config.crzbc_policy;
+        gc.functions = config.functions;
+        gc.rules = config.rules;
+        const int vocab = policy.probs.empty() ? Token::EMPTY : policy.vocab;
+        const int n_positions = policy.probs.empty() ? 1 : policy.n_positions;
+        const int n_slots = policy.probs.empty() ? 1 : policy.n_slots;
+        GroupSample sample = sample_group(state, probs.data(), n_positions, n_slots, vocab, gc);
+        result.sims += budget;
+        programs = std::move(sample.programs);
+        totals.assign(sample.scores.begin(), sample.scores.end());
+        done_evals = 1;
+    } else {
+        for (int g = 0; g < budget; g++) {
+            programs.push_back(running_max_program(sim, policy, config, base, rng, result.sims));
+        }
+        totals.assign(programs.size(), 0.0);
+    }
+
+    // evals회 평균 (동점이면 짧은 프로그램)
+    std::vector<int> lengths(programs.size());
+    for (size_t i = 0; i < programs.size(); i++) {
+        const CompiledProgram compiled = sim.compile_program(programs[i]);
+        for (int e = done_evals; e < evals; e++) {
+            totals[i] += sim.simulate_compiled(compiled, config.cat_policy, config.crzbc_policy);
+            result.sims++;
+        }
+        lengths[i] = effective_length(programs[i]);
+    }
+    std::vector<size_t> order(programs.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (totals[a] != totals[b]) return totals[a] > totals[b];
+        if (lengths[a] != lengths[b]) return lengths[a] < lengths[b];
+        return a < b;
+    });
+
+    if (programs.empty()) {
+        result.programs.push_back({Token::END});
+        result.scores.push_back(0.0);
+        return result;
+    }
+    for (size_t i : order) {
+        result.programs.push_back(std::move(programs[i]));
+        result.scores.push_back(totals[i] / evals - base);
+    }
+    return result;
+}
+
+std::vector<float> search_probs(const SearchPolicy& policy) {
+    std::vector<float> probs;
+    if (policy.kind != SearchKind::SAMPLED) return probs;
+    if (policy.probs.empty()) {
+        probs.assign(Token::EMPTY, 0.0f);
+        std::fill(probs.begin(), probs.begin() + Token::FUNC_LIB_START, 1.0f);
+    } else {
+        probs = policy.probs;
+    }
+    return probs;
+}
+
+uint64_t game_seed(uint64_t seed, int64_t game) {
+    return mix_seed(seed, GAME_SALT, static_cast<uint64_t>(game));
+}
+
+uint64_t search_seed(uint64_t seed, int64_t game) {
+    return mix_seed(seed, SEARCH_SALT, static_cast<uint64_t>(game));
+}
+
+namespace {
+
+struct GameResult {
+    float score = 0.0f;
+    int runs = 0;
+    bool won = false;
+    uint64_t decisions = 0;
+    uint64_t sims = 0;
+};
+
+GameResult play_game(const GameState& start, const SearchPolicy& policy, const TournamentConfig& config,
+                     const std::vector<float>& probs, int game) {
+    Simulator real(0);
+    Simulator search(0);
+    for (Simulator* s : {&real, &search}) {
+        if (!config.functions.empty()) s->load_functions(config.functions);
+        s->set_rules(config.rules);
+    }
+    real.restore_state(start);
+    real.seed(static_cast<uint32_t>(game_seed(config.seed, game)));
+    std::mt19937_64 rng(search_seed(config.seed, game));
+
+    GameResult r;
+    for (int run = 0; run < config.max_runs; run++) {
+        const GameState state = real.get_state();
+        if (state.win_sign || state.lose_sign) break;
+        SearchResult found = search_run(search, state, policy, config, probs, rng);
+        r.sims += found.sims;
+        std::vector<int> program = std::move(found.programs.front());
+        program.erase(std::remove(program.begin(), program.end(), Token::END), program.end());
+        real.execute_program(program, config.cat_policy, config.crzbc_policy);
+        r.decisions++;
+    }
+    const GameState final_state = real.get_state();
+    r.score = static_cast<float>(final_state.score);
+    r.runs = final_state.run;
+    r.won = final_state.win_sign;
+    return r;
+}
+
+// ============================================================
+// 통계
+// ============================================================
+Interval mean_interval(const std::vector<double>& v, double* stddev = nullptr) {
+    Interval out;
+    const size_t n = v.size();
+    if (n == 0) return out;
+    double sum = 0.0;
+    for (double x : v) sum += x;
+    out.mean = sum / n;
+    double sq = 0.0;
+    for (double x : v) sq += (x - out.mean) * (x - out.mean);
+    const double sd = n > 1 ? std::sqrt(sq / (n - 1)) : 0.0;
+    const double half = n > 1 ? Z95 * sd / std::sqrt(static_cast<double>(n)) : 0.0;
+    out.lo = out.mean - half;
+    out.hi = out.mean + half;
+    if (stddev) *stddev = sd;
+    return out;
+}
+
+Interval wilson_interval(int wins, int n) {
+    Interval out;
+    if (n == 0) return out;
+    const double p = static_cast<double>(wins) / n;
+    const double z2 = Z95 * Z95;
+    const double denom = 1.0 + z2 / n;
+    const double center = (p + z2 / (2.0 * n)) / denom;
+    const double half = Z95 * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denom;
+    out.mean = p;
+    out.lo = std::max(0.0, center - half);
+    out.hi = std::min(1.0, center + half);
+    return out;
+}
+
+// 선형 보간 분위수
+double quantile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    const double pos = q * (sorted.size() - 1);
+    const size_t i = static_cast<size_t>(pos);
+    if (i + 1 >= sorted.size()) return sorted.back();
+    return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+}
+
+} // namespace
+
+// ============================================================
+// 토너먼트 (정책 x 게임 병렬)
+// ============================================================
+std::vector<PolicyReport> run_tournament(const std::vector<GameState>& starts,
+                                         const std::vector<SearchPolicy>& policies,
+                                         const TournamentConfig& config) {
+    const int P = static_cast<int>(policies.size());
+    const int M = std::max(config.games, 0);
+    std::vector<GameState> start_states = starts;
+    if (start_states.empty()) {
+        start_states.emplace_back();
+        start_states.back().init_level3();
+    }
+
+    std::vector<std::vector<float>> probs(P);
+    for (int p = 0; p < P; p++) probs[p] = search_probs(policies[p]);
+
+    std::vector<GameResult> results(static_cast<size_t>(P) * M);
+    const int64_t total = static_cast<int64_t>(P) * M;
+
+    auto play = [&](int64_t task) {
+        const int p = static_cast<int>(task / M);
+        const int m = static_cast<int>(task % M);
+        results[task] = play_game(start_states[m % start_states.size()], policies[p], config, probs[p], m);
+    };
+
+#ifdef USE_OPENMP
+    int num_threads = config.num_threads;
+    if (num_threads <= 0) {
+        num_threads = omp_get_max_threads();
+    }
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+    for (int64_t task = 0; task < total; task++) {
+        play(task);
+    }
+#else
+    // 시리얼 버전
+    for (int64_t task = 0; task < total; task++) {
+        play(task);
+    }
+#endif
+
+    std::vector<PolicyReport> reports(P);
+    for (int p = 0; p < P; p++) {
+        PolicyReport& rep = reports[p];
+        rep.name = policies[p].name;
+        rep.games = M;
+
+        std::vector<double> scores, win_runs, diffs;
+        uint64_t sims = 0;
+        for (int m = 0; m < M; m++) {
+            const GameResult& r = results[static_cast<size_t>(p) * M + m];
+            rep.scores.push_back(r.score);
+            rep.runs.push_back(r.runs);
+            rep.won.push_back(r.won ? 1 : 0);
+            scores.push_back(r.score);
+            if (r.won) {
+                rep.wins++;
+                win_runs.push_back(r.runs);
+            }
+            rep.decisions += r.decisions;
+            sims += r.sims;
+            diffs.push_back(static_cast<double>(r.score) - results[m].score);
+        }
+
+        rep.win_rate = wilson_interval(rep.wins, M);
+        rep.score = mean_interval(scores, &rep.score_std);
+        rep.runs_to_win = mean_interval(win_runs);
+        rep.score_diff = mean_interval(diffs);
+        rep.sims_per_decision = rep.decisions > 0 ? static_cast<double>(sims) / rep.decisions : 0.0;
+
+        std::sort(scores.begin(), scores.end());
+        for (double q : {0.10, 0.25, 0.50, 0.75, 0.90}) rep.score_quantiles.push_back(quantile(scores, q));
+    }
+    return reports;
+}
+
+} // namespace simulator
@@ -4,6 +4,11 @@ C++ 시뮬레이터 어댑터 (드롭인 대체)
 C++ 확장 모듈이 있으면 사용하고, 없으면 Python 폴백
 """
 
+import os
+
+# 공유 거리 캐시 파일 경로 (publish_shared_cache가 설정, 자식 프로세스가 상속)
+SHARED_CACHE_ENV = 'CPP_SIM_DISTANCE_CACHE'
+
 try:
     import cpp_simulator as _cpp
     _USE_CPP = True
@@ -33,9 +38,14 @@ if _USE_CPP:
             if _CACHE_INITIALIZED_LEVEL is None or _CACHE_INITIALIZED_LEVEL != level:
                 if _CACHE_INITIALIZED_LEVEL is not None and _CACHE_INITIALIZED_LEVEL != level:
                     print(f"[CPP] Warning: BFS cache was for level {_CACHE_INITIALIZED_LEVEL}, reinitializing for level {level}")
-                self._sim.initialize_cache()
-                _CACHE_INITIALIZED_LEVEL = level
-                print(f"[CPP] BFS distance cache initialized for level {level} (121 positions)")
+                # 메인 프로세스가 저장한 캐시 파일이 있으면 mmap (워커마다 BFS 재계산 생략)
+                shared_path = os.environ.get(SHARED_CACHE_ENV)
+                if shared_path and self._sim.attach_cache(shared_path):
+                    _CACHE_INITIALIZED_LEVEL = level
+                else:
+                    self._sim.initialize_cache()
+                    _CACHE_INITIALIZED_LEVEL = level
+                    print(f"[CPP] BFS distance cache initialized for level {level} (121 positions)")
 
         def simulate_program(self, program):
             """프로그램 실행 후 점수 반환 (상태 변경 없음)"""
@@ -61,6 +71,10 @@ if _USE_CPP:
             state['run'] = self._run
             return state
 
+        def get_state_vector(self):
+            """828차원 특징 벡터 (C++ 커널, lightweight_simulator.get_state_vector와 같은 정의, float32)"""
+            return _cpp.encode_feature_vectors([self.get_state_dict()])[0]
+
         def reset(self):
             """초기 상태로 리셋"""
             self._sim.reset()
@@ -176,3 +190,20 @@ def create_simulator(level=3):
 def is_cpp_available():
     """C++ 확장 사용 가능 여부"""
     return _USE_CPP
+
+
+def publish_shared_cache(path, level=3):
+    """거리 캐시를 한 번 계산해 파일로 저장하고 자식 프로세스가 mmap하도록 환경 변수 설정
+
+    spawn 워커는 환경 변수를 상속하므로 LightweightGameSimulator 생성 시 BFS 대신 attach
+    실패하거나 C++ 확장이 없으면 False (워커는 기존처럼 직접 계산)
+    """
+    if not _USE_CPP:
+        return False
+    sim = _cpp.Simulator(level)
+    if not _cpp.Simulator.is_cache_initialized() or _CACHE_INITIALIZED_LEVEL != level:
+        sim.initialize_cache()
+    if not _cpp.Simulator.save_cache(path):
+        return False
+    os.environ[SHARED_CACHE_ENV] = path
+    return True
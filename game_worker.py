@@ -6,7 +6,9 @@ multiprocessing spawn 모드에서 사용
 
 import os
 import sys
+import time
 import random
+import pickle
 
 # 경로 설정
 sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
@@ -90,34 +92,43 @@ def generate_running_max_standalone(n_programs, game_state_dict, cpp_threads):
     import cpp_simulator as cpp_sim
 
     END_TOKEN = 112
-    LOOP_TOKEN = 110
     MAX_TOKENS = 10
     STRUCTURE_BAN_THRESHOLD = 8
 
     running_max_programs = []
 
+    # C++ simulate_program_and_apply는 상태를 바꾸지 않으므로 탐색 내내 시작 상태 그대로
+    # → dict 변환은 호출당 한 번 (분기가 필요한 탐색은 Simulator.fork / SimulatorBatch)
+    sim = LightweightGameSimulator(level=game_state_dict.get('level', 3))
+    sim.restore_state(game_state_dict)
+    cached_state = sim.get_state_dict()
+    initial_score = sim.score
+
+    # LOOP 후보 (LOOP + 반복 100/104-109 + 방향)는 네이티브 문법 생성기로 (시드는 random에서)
+    loop_cfg = cpp_sim.ProgramGenConfig()
+    loop_cfg.seed = random.getrandbits(64)
+    loop_cfg.min_tokens = loop_cfg.max_tokens = 3
+    loop_cfg.direction_weight = loop_cfg.if_weight = loop_cfg.function_weight = 0.0
+    loop_cfg.loop_count_weights = [1.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0]
+    loop_gen = cpp_sim.ProgramGenerator(loop_cfg)
+    loop_first = 0
+
     for prog_idx in range(n_programs):
         program = []
-        sim = LightweightGameSimulator(level=game_state_dict.get('level', 3))
-        sim.restore_state(game_state_dict)
 
         while len(program) < MAX_TOKENS:
             current_len = len(program)
             allow_structure = current_len < STRUCTURE_BAN_THRESHOLD
 
-            cached_state = sim.get_state_dict()
-            initial_score = sim.score
-
             candidates_to_eval = []
 
             for dir_token in [0, 1, 2, 3]:
                 candidates_to_eval.append(([dir_token], 1.0, True))
 
             if allow_structure:
-                for _ in range(96):
-                    num_token = random.choice([104, 105, 106, 107, 108, 109, 100])
-                    dir_token = random.choice([0, 1, 2, 3])
-                    candidates_to_eval.append(([LOOP_TOKEN, num_token, dir_token], 0.5, False))
+                for row in loop_gen.generate_padded(96, loop_first).tolist():
+                    candidates_to_eval.append((row[:3], 0.5, False))
+                loop_first += 96
 
             progs_to_sim = [program + cand[0] for cand in candidates_to_eval]
             scores = cpp_sim.batch_simulate(progs_to_sim, cached_state, cpp_threads)
@@ -138,10 +149,6 @@ def generate_running_max_standalone(n_programs, game_state_dict, cpp_threads):
 
             program.extend(best_tokens)
 
-            sim.restore_state(cached_state)
-            if best_tokens[0] != END_TOKEN:
-                sim.simulate_program_and_apply(best_tokens)
-
             if best_tokens[-1] == END_TOKEN:
                 break
 
@@ -223,35 +230,86 @@ def evaluate_programs_standalone(programs, game_state_dict, cpp_threads):
     return results
 
 
+def count_cheese(state_dict):
+    """(남은 작은 치즈 수, 남은 빅치즈 수)"""
+    sc = sum(sum(1 for v in row if v == 1) for row in state_dict['sc'])
+    bc = sum(1 for p in state_dict['movbc'] + state_dict['crzbc'] if p != [-1, -1])
+    return sc, bc
+
+
 def game_worker(worker_args):
     """멀티프로세싱 워커: 단일 게임 완전 실행 (CPU only, torch 없음)"""
-    if len(worker_args) == 6:
-        game_idx, level, max_runs, cpp_threads, top_k_sft, group_size = worker_args
-    else:
-        game_idx, level, max_runs, cpp_threads, top_k_sft = worker_args
-        group_size = 32
+    game_idx, level, max_runs, cpp_threads, top_k_sft = worker_args[:5]
+    group_size = worker_args[5] if len(worker_args) > 5 else 32
+    ckpt_path, ckpt_interval = worker_args[6:8] if len(worker_args) > 7 else (None, 0.0)
+    book_path, book_explore = worker_args[8:10] if len(worker_args) > 9 else (None, 0.0)
 
     from cpp_simulator_adapter import LightweightGameSimulator
+    import cpp_simulator as cpp_sim
 
     game = LightweightGameSimulator(level=level)
     game.reset()
 
     runs_data = []
-
-    for run in range(max_runs):
+    start_run = 0
+    # 런 / 게임 통계 (부모 프로세스에서 serialize 결과를 합침)
+    stats = cpp_sim.RunStats()
+
+    # 체크포인트: 같은 게임의 기록이 있으면 마지막으로 저장된 런부터 이어서 실행
+    store = None
+    if ckpt_path:
+        store = cpp_sim.CheckpointStore(ckpt_path, ckpt_interval)
+        saved = store.get_slot(0) if store.load() else None
+        if saved is not None and saved['game_id'] == game_idx:
+            if saved['finished']:
+                store.close()
+                return pickle.loads(saved['payload'])
+            game.restore_state(saved['state'])
+            random.setstate(pickle.loads(saved['rng']))
+            progress = pickle.loads(saved['payload'])
+            runs_data = progress['runs_data']
+            stats.merge(progress['stats'])
+            start_run = saved['run']
+
+    # 오프닝 북: 미리 계산된 초반 상태면 탐색 생략 (book_explore 확률로 그래도 탐색)
+    book = None
+    if book_path:
+        book = cpp_sim.OpeningBook()
+        if not book.open(book_path):
+            book = None
+
+    for run in range(start_run, max_runs):
         if game.win_sign or game.lose_sign:
             break
 
         state_vec = get_state_vector_list(game)
         game_state_dict = game.get_state_dict()
 
-        programs = generate_running_max_standalone(group_size, game_state_dict, cpp_threads)
-        eval_results = evaluate_programs_standalone(programs, game_state_dict, cpp_threads)
+        search_start = time.perf_counter()
+        book_hit = None
+        if book is not None and random.random() >= book_explore:
+            book_hit = book.lookup(game_state_dict)
+
+        if book_hit is not None:
+            best_program = book_hit['programs'][0]
+            top_programs = book_hit['programs'][:top_k_sft]
+            top_scores = book_hit['means'][:top_k_sft]
+        else:
+            programs = generate_running_max_standalone(group_size, game_state_dict, cpp_threads)
+            eval_results = evaluate_programs_standalone(programs, game_state_dict, cpp_threads)
+
+            best_idx = max(range(len(eval_results)),
+                          key=lambda i: (eval_results[i]['total_score'],
+                                        -get_effective_length(programs[i])))
+            best_program = programs[best_idx]
 
-        best_idx = max(range(len(eval_results)),
-                      key=lambda i: (eval_results[i]['total_score'],
-                                    -get_effective_length(programs[i])))
-        best_program = programs[best_idx]
+            sorted_idx = sorted(range(len(eval_results)),
+                               key=lambda i: eval_results[i]['total_score'],
+                               reverse=True)[:top_k_sft]
+            top_programs = [programs[i] for i in sorted_idx]
+            top_scores = [eval_results[i]['total_score'] for i in sorted_idx]
+
+        search_us = int((time.perf_counter() - search_start) * 1e6)
 
         prog_to_execute = [t for t in best_program if t != 112]
         try:
@@ -259,11 +317,12 @@ def game_worker(worker_args):
         except Exception:
             pass
 
-        sorted_idx = sorted(range(len(eval_results)),
-                           key=lambda i: eval_results[i]['total_score'],
-                           reverse=True)[:top_k_sft]
-        top_programs = [programs[i] for i in sorted_idx]
-        top_scores = [eval_results[i]['total_score'] for i in sorted_idx]
+        after = game.get_state_dict()
+        sc_before, bc_before = count_cheese(game_state_dict)
+        sc_after, bc_after = count_cheese(after)
+        stats.record_run(run, after['score'] - game_state_dict['score'], sc_before - sc_after,
+                         bc_before - bc_after, max(0, game_state_dict['life'] - after['life']),
+                         search_us, bool(after['win_sign']))
 
         runs_data.append({
             'state_vec': state_vec,
@@ -271,6 +330,10 @@ def game_worker(worker_args):
             'scores': top_scores,
         })
 
+        if store is not None:
+            store.set_slot(0, game_idx, run + 1, after, pickle.dumps(random.getstate()),
+                           pickle.dumps({'runs_data': runs_data, 'stats': stats.serialize()}))
+
     sc_left = sum(sum(1 for v in row if v == 1) for row in game.sc)
     bc_left = 0
     if hasattr(game, 'movbc'):
@@ -278,7 +341,7 @@ def game_worker(worker_args):
     if hasattr(game, 'crzbc'):
         bc_left += sum(1 for p in game.crzbc if p != [-1, -1])
 
-    return {
+    result = {
         'runs_data': runs_data,
         'final_score': game.score,
         'win': game.win_sign,
@@ -287,3 +350,13 @@ def game_worker(worker_args):
         'life': getattr(game, 'life', 3),
         'n_runs': len(runs_data),
     }
+    stats.record_game(game.score, bool(game.win_sign), len(runs_data))
+    result['stats'] = stats.serialize()
+
+    # 완료 결과는 즉시 기록 (배치가 저장되기 전에 죽어도 재계산 없음)
+    if store is not None:
+        store.set_slot(0, game_idx, max_runs, game.get_state_dict(),
+                       pickle.dumps(random.getstate()), pickle.dumps(result), True)
+        store.close()
+
+    return result
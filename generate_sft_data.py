@@ -9,12 +9,16 @@
 사용법:
     CUDA_VISIBLE_DEVICES="" python3 generate_sft_data.py \
         --n_games 10000 --n_parallel 20 --group_size 32 --top_k 1 --cpp_threads 3
+
+중단된 작업 재개 (같은 output_dir, 완료된 배치와 진행 중 게임의 저장된 런은 다시 실행하지 않음):
+    python3 generate_sft_data.py --n_games 10000 --output_dir sft_data --resume
 """
 
 import os
 import sys
 import time
 import random
+import pickle
 import argparse
 import torch
 import json
@@ -29,6 +33,92 @@ os.environ['SDL_AUDIODRIVER'] = 'dummy'
 from game_worker import game_worker, get_state_vector_list
 
 
+def mirror_samples(samples, mapper):
+    """맵 좌우 대칭 증강 (C++ MapSymmetry.augment, 변환 불가 프로그램은 제외)"""
+    import numpy as np
+
+    if not samples:
+        return []
+    vecs = np.asarray([s['state_vec'] for s in samples], dtype=np.float32)
+    out_vecs, out_programs = mapper.augment(vecs, [s['programs'] for s in samples])
+
+    mirrored = []
+    for i, s in enumerate(samples):
+        pairs = [(p, score) for p, score in zip(out_programs[i], s['scores']) if p is not None]
+        if not pairs:
+            continue
+        mirrored.append({
+            'state_vec': out_vecs[i].tolist(),
+            'programs': [p for p, _ in pairs],
+            'scores': [score for _, score in pairs],
+        })
+    return mirrored
+
+
+def add_to_deduper(deduper, samples, threads):
+    """샘플을 C++ 중복 제거 집합에 추가 (순번 = all_data 인덱스)"""
+    import numpy as np
+
+    if deduper is None or not samples:
+        return
+    vecs = np.asarray([s['state_vec'] for s in samples], dtype=np.float32)
+    deduper.add(vecs, [s['programs'] for s in samples], [s['scores'] for s in samples], threads)
+
+
+def shard_samples(all_data, deduper):
+    """저장할 샘플 목록 (중복 제거 시 그룹별 대표 상태 + 병합 top-K 프로그램 / 평균 점수)"""
+    if deduper is None:
+        return all_data
+    return [{
+        'state_vec': all_data[g['index']]['state_vec'],
+        'programs': g['programs'],
+        'scores': g['scores'],
+        'count': g['count'],
+    } for g in deduper.groups()]
+
+
+def save_stats(path, stats, game_idx):
+    """통계 누적기 기록 (임시 파일 → rename), 재개 시 체크포인트와 같은 배치인지 game_idx로 확인"""
+    with open(path + '.tmp', 'wb') as f:
+        pickle.dump((game_idx, stats.serialize()), f)
+        f.flush()
+        os.fsync(f.fileno())
+    os.replace(path + '.tmp', path)
+
+
+def print_run_stats(snap):
+    """런 순번별 요약 (치즈 / 잡힘 / 평균 점수 변화)"""
+    per_run = snap['per_run']
+    print("런 | 횟수 | 평균 Δ점수 | 작은 치즈 | 빅치즈 | 잡힘 | 승리")
+    for r, n in enumerate(per_run['runs']):
+        if n == 0:
+            continue
+        print(f"{r:2d} | {n:5d} | {per_run['delta_mean'][r]:9.1f} | {per_run['small_cheese'][r] / n:8.2f} | "
+              f"{per_run['big_cheese'][r] / n:6.2f} | {per_run['catches'][r] / n:4.2f} | {per_run['wins'][r]}")
+
+
+def load_sample_log(path, offset):
+    """샘플 로그를 체크포인트 오프셋까지 읽기 (그 뒤의 미완료 기록은 잘라냄)"""
+    samples = []
+    if not os.path.exists(path):
+        open(path, 'wb').close()
+        return samples
+    with open(path, 'r+b') as f:
+        f.truncate(offset)
+        while f.tell() < offset:
+            samples.extend(pickle.load(f))
+    return samples
+
+
+def append_sample_log(path, samples):
+    """배치 샘플을 로그 끝에 추가하고 디스크에 반영, 새 끝 오프셋 반환"""
+    with open(path, 'ab') as f:
+        pickle.dump(samples, f)
+        f.flush()
+        os.fsync(f.fileno())
+        return f.tell()
+
+
 def main():
     parser = argparse.ArgumentParser(description='Generate SFT data offline')
     parser.add_argument('--n_games', type=int, default=10000, help='Total games to generate')
@@ -40,9 +130,38 @@ def main():
     parser.add_argument('--max_runs', type=int, default=20, help='Max runs per game')
     parser.add_argument('--output_dir', type=str, default='sft_data', help='Output directory')
     parser.add_argument('--save_every', type=int, default=1000, help='Save checkpoint every N games')
+    parser.add_argument('--augment_mirror', action='store_true',
+                        help='Also emit left-right mirrored samples (map symmetry)')
+    parser.add_argument('--opening_book', type=str, default=None,
+                        help='Opening book file from build_opening_book.py (skip search for early states)')
+    parser.add_argument('--book_explore', type=float, default=0.1,
+                        help='Probability of searching anyway when the state is in the opening book')
+    parser.add_argument('--dedupe', action='store_true',
+                        help='Merge samples with the same state before saving (keeps top_k programs)')
+    parser.add_argument('--dedupe_score_bucket', type=int, default=1,
+                        help='Score coarsening for dedupe keys (0 = ignore, 1 = exact, k = k-point bins)')
+    parser.add_argument('--dedupe_step_bucket', type=int, default=1,
+                        help='Step coarsening for dedupe keys (0 = ignore, 1 = exact, k = k-step bins)')
+    parser.add_argument('--resume', action='store_true',
+                        help='Resume from the checkpoint in output_dir/checkpoint')
+    parser.add_argument('--checkpoint_interval', type=float, default=5.0,
+                        help='Seconds between background checkpoint writes (0 = only at batch ends)')
     args = parser.parse_args()
 
+    import cpp_simulator as cpp_sim
+
     os.makedirs(args.output_dir, exist_ok=True)
+    ckpt_dir = os.path.join(args.output_dir, 'checkpoint')
+    os.makedirs(ckpt_dir, exist_ok=True)
+    log_path = os.path.join(ckpt_dir, 'samples.log')
+    stats_path = os.path.join(ckpt_dir, 'stats.bin')
+    stats = cpp_sim.RunStats()
+    store = cpp_sim.CheckpointStore(os.path.join(ckpt_dir, 'main.ckpt'), args.checkpoint_interval)
+
+    # 거리 캐시를 한 번만 계산해 저장 → spawn 워커는 mmap으로 붙음 (체크포인트 정리 시 함께 삭제)
+    from cpp_simulator_adapter import publish_shared_cache
+    cache_path = os.path.join(ckpt_dir, 'distance_cache.bin')
+    shared_cache = publish_shared_cache(cache_path, args.level)
 
     print("=" * 70)
     print(f"오프라인 SFT 데이터 생성")
@@ -50,6 +169,26 @@ def main():
     print(f"설정: {args.n_games}게임, {args.n_parallel}개 병렬, RM{args.group_size}, top-{args.top_k}")
     print(f"cpp_threads/game: {args.cpp_threads} (total: {args.n_parallel * args.cpp_threads})")
     print(f"저장: {args.output_dir}")
+    print(f"거리 캐시: {'공유 파일 ' + cache_path if shared_cache else '워커별 계산'}")
+
+    mapper = None
+    if args.augment_mirror:
+        mapper = cpp_sim.MapSymmetry()
+        if mapper.has(cpp_sim.Symmetry.MIRROR_LR):
+            print(f"대칭 증강: 좌우 대칭 (함수 {mapper.mappable_functions(cpp_sim.Symmetry.MIRROR_LR)}개 대응)")
+        else:
+            print("대칭 증강: 맵이 좌우 대칭이 아니므로 비활성화")
+            mapper = None
+    if args.opening_book:
+        book = cpp_sim.OpeningBook()
+        if not book.open(args.opening_book):
+            raise SystemExit(f"오프닝 북을 열 수 없음: {args.opening_book}")
+        print(f"오프닝 북: {args.opening_book} ({len(book)} 상태, 탐색 확률 {args.book_explore})")
+
+    deduper = None
+    if args.dedupe:
+        deduper = cpp_sim.SampleDeduper(args.top_k, args.dedupe_score_bucket, args.dedupe_step_bucket)
+        print(f"중복 제거: score 구간 {args.dedupe_score_bucket}, step 구간 {args.dedupe_step_bucket}, top-{args.top_k}")
     print("=" * 70)
 
     all_data = []  # (state_vec, programs, scores) 리스트
@@ -57,15 +196,46 @@ def main():
     total_games = 0
     total_runs = 0
     total_score = 0
+    total_augmented = 0
+    game_idx = 0
+
+    # 체크포인트: 카운터 + 샘플 로그 유효 길이 (게임별 진행 상황은 game_<id>.ckpt)
+    if args.resume and store.load():
+        c = store.counters
+        game_idx = c['game_idx']
+        total_games = c['total_games']
+        total_wins = c['total_wins']
+        total_runs = c['total_runs']
+        total_score = c['total_score']
+        total_augmented = c['total_augmented']
+        all_data = load_sample_log(log_path, store.shards.get('samples.log', 0))
+        add_to_deduper(deduper, all_data, args.cpp_threads)
+        if os.path.exists(stats_path):
+            with open(stats_path, 'rb') as f:
+                stats_idx, blob = pickle.load(f)
+            if stats_idx == game_idx:
+                stats.merge(blob)
+            else:
+                print(f"통계 기록이 체크포인트와 다른 배치 (Game {stats_idx}) → 통계는 새로 시작")
+        print(f"재개: Game {game_idx}/{args.n_games}, {len(all_data)} 샘플")
+    else:
+        store.clear()
+        open(log_path, 'wb').close()
+        for name in os.listdir(ckpt_dir):
+            if name.startswith('game_') and name.endswith('.ckpt'):
+                os.remove(os.path.join(ckpt_dir, name))
+        store.flush()
 
     start_time = time.time()
-    game_idx = 0
+    start_game_idx = game_idx
 
     while game_idx < args.n_games:
         batch_size = min(args.n_parallel, args.n_games - game_idx)
 
+        ckpt_paths = [os.path.join(ckpt_dir, f'game_{game_idx + i}.ckpt') for i in range(batch_size)]
         worker_args = [
-            (i, args.level, args.max_runs, args.cpp_threads, args.top_k, args.group_size)
+            (game_idx + i, args.level, args.max_runs, args.cpp_threads, args.top_k, args.group_size,
+             ckpt_paths[i], args.checkpoint_interval, args.opening_book, args.book_explore)
             for i in range(batch_size)
         ]
 
@@ -79,7 +249,9 @@ def main():
         # 결과 수집
         batch_wins = 0
         batch_score = 0
+        batch_samples = []
         for r in results:
+            stats.merge(r['stats'])
             total_games += 1
             total_score += r['final_score']
             batch_score += r['final_score']
@@ -88,16 +260,37 @@ def main():
                 batch_wins += 1
 
             for run_data in r['runs_data']:
-                all_data.append({
+                batch_samples.append({
                     'state_vec': run_data['state_vec'],
                     'programs': run_data['programs'],
                     'scores': run_data['scores'],
                 })
                 total_runs += 1
 
+        if mapper is not None:
+            mirrored = mirror_samples(batch_samples, mapper)
+            batch_samples.extend(mirrored)
+            total_augmented += len(mirrored)
+        all_data.extend(batch_samples)
+        add_to_deduper(deduper, batch_samples, args.cpp_threads)
+
         game_idx += batch_size
+
+        # 배치 확정: 로그 / 통계 추가 → 카운터 / 오프셋 원자적 기록 → 게임별 체크포인트 삭제
+        store.set_shard('samples.log', append_sample_log(log_path, batch_samples))
+        save_stats(stats_path, stats, game_idx)
+        for name, value in (('game_idx', game_idx), ('total_games', total_games),
+                            ('total_wins', total_wins), ('total_runs', total_runs),
+                            ('total_score', total_score), ('total_augmented', total_augmented)):
+            store.set_counter(name, value)
+        store.flush()
+        for path in ckpt_paths:
+            for p in (path, path + '.tmp'):
+                if os.path.exists(p):
+                    os.remove(p)
+
         elapsed = time.time() - start_time
-        eps_min = game_idx / elapsed * 60 if elapsed > 0 else 0
+        eps_min = (game_idx - start_game_idx) / elapsed * 60 if elapsed > 0 else 0
 
         print(f"Batch {game_idx//batch_size:4d} | Game {game_idx:5d}/{args.n_games} | "
               f"Time: {batch_time:.1f}s | {eps_min:.1f} eps/min | "
@@ -105,39 +298,63 @@ def main():
               f"Total: {total_wins}/{total_games} ({total_wins/total_games*100:.1f}%) | "
               f"Runs: {total_runs} | "
               f"Avg: {batch_score//batch_size}")
+        snap = stats.snapshot()
+        search = snap['search_us']
+        print(f"           | score {snap['score_mean']:.0f}±{snap['score_std']:.0f} | "
+              f"win runs {snap['runs_to_win_mean']:.1f} | "
+              f"search p50 {search['p50'] / 1000:.0f}ms p90 {search['p90'] / 1000:.0f}ms "
+              f"p99 {search['p99'] / 1000:.0f}ms")
 
         # 중간 저장
         if game_idx % args.save_every == 0 and game_idx > 0:
             save_path = os.path.join(args.output_dir, f'sft_data_g{game_idx}.pt')
+            shard = shard_samples(all_data, deduper)
             torch.save({
-                'data': all_data,
+                'data': shard,
                 'n_games': total_games,
                 'n_runs': total_runs,
+                'n_augmented': total_augmented,
                 'wins': total_wins,
                 'win_rate': total_wins / total_games if total_games > 0 else 0,
+                'dedupe': deduper.stats if deduper is not None else None,
+                'stats': stats.snapshot(),
                 'args': vars(args),
             }, save_path)
-            print(f"  → 중간 저장: {save_path} ({len(all_data)} 샘플)")
+            print(f"  → 중간 저장: {save_path} ({len(shard)} 샘플)")
 
     # 최종 저장
     elapsed = time.time() - start_time
     save_path = os.path.join(args.output_dir, f'sft_data_final.pt')
+    shard = shard_samples(all_data, deduper)
     torch.save({
-        'data': all_data,
+        'data': shard,
         'n_games': total_games,
         'n_runs': total_runs,
+        'n_augmented': total_augmented,
         'wins': total_wins,
         'win_rate': total_wins / total_games if total_games > 0 else 0,
         'avg_score': total_score / total_games if total_games > 0 else 0,
+        'dedupe': deduper.stats if deduper is not None else None,
+        'stats': stats.snapshot(),
         'args': vars(args),
     }, save_path)
 
+    # 완료된 작업의 체크포인트 정리
+    store.close()
+    for name in os.listdir(ckpt_dir):
+        os.remove(os.path.join(ckpt_dir, name))
+    os.rmdir(ckpt_dir)
+
     print("\n" + "=" * 70)
     print(f"완료: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}")
     print(f"총 시간: {elapsed/60:.1f}분")
     print(f"게임: {total_games}, 승률: {total_wins}/{total_games} ({total_wins/total_games*100:.1f}%)")
     print(f"총 런 수: {total_runs} (평균 {total_runs/total_games:.1f}런/게임)")
-    print(f"총 샘플: {len(all_data)}")
+    print(f"총 샘플: {len(all_data)} (대칭 증강 {total_augmented})")
+    if deduper is not None:
+        st = deduper.stats
+        print(f"중복 제거: {st['samples']} → {st['unique']} 샘플 (중복 {st['ratio']*100:.1f}%)")
+    print_run_stats(stats.snapshot())
     print(f"저장: {save_path}")
     print("=" * 70)
 
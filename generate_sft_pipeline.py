@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+오프라인 SFT 데이터 생성 - C++ 단계별 파이프라인 (GenerationPipeline)
+
+탐색 워커 → [runs 큐] → 관측 인코더 → [samples 큐] → 대칭 증강 / 중복 제거 → [write 큐] → 샤드 기록기
+단계마다 스레드 수와 큐 용량을 따로 정하고, 큐가 차면 앞 단계가 대기 (backpressure)
+→ 인코딩 / 파일 쓰기가 시뮬레이션과 겹쳐서 진행, report_every초마다 큐 깊이와 단계별 대기 시간 출력
+
+탐색은 run_tournament의 Running Max / 샘플링 정책과 같음 (scores = 런 시작 대비 평균 점수 변화)
+샤드 (output_dir/samples.bin)를 다 쓰면 generate_sft_data.py와 같은 형식의 .pt로 저장
+
+사용법:
+    python3 generate_sft_pipeline.py --n_games 10000 --policy rm:32 --top_k 1 \
+        --search_workers 18 --encode_workers 1 --augment_mirror
+"""
+
+import os
+import sys
+import time
+import argparse
+import torch
+from datetime import datetime
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from compare_policies import parse_policy
+
+
+def print_report(r):
+    """진행 상황 + 큐 깊이 + 단계별 처리 / 대기 시간"""
+    queues = ' '.join(f"{q['name']} {q['depth']}/{q['capacity']} (최대 {q['high_water']}, 대기 {q['full_waits']})"
+                      for q in r['queues'])
+    print(f"[{r['elapsed_sec']:7.1f}s] 게임 {r['games_done']} | 샘플 {r['samples_written']} | "
+          f"{r['bytes_written'] / 1e6:.1f}MB | 큐: {queues}")
+    for st in r['stages']:
+        print(f"           {st['name']:>8} x{st['threads']:<3} | 처리 {st['items']:7d} | "
+              f"작업 {st['busy_sec']:8.1f}s | 입력 대기 {st['wait_in_sec']:8.1f}s | "
+              f"출력 대기 {st['wait_out_sec']:8.1f}s")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate SFT data with the native staged pipeline')
+    parser.add_argument('--n_games', type=int, default=10000, help='Total games to generate')
+    parser.add_argument('--policy', type=str, default='rm:32', help='Search policy kind:budget[:evals] (rm / sampled)')
+    parser.add_argument('--top_k', type=int, default=1, help='Top-K programs per run')
+    parser.add_argument('--max_runs', type=int, default=20, help='Max runs per game')
+    parser.add_argument('--seed', type=int, default=0, help='Seed (game m uses seeds derived from (seed, m))')
+    parser.add_argument('--search_workers', type=int, default=0, help='Search threads (0 = auto)')
+    parser.add_argument('--encode_workers', type=int, default=1, help='Observation encoder threads')
+    parser.add_argument('--run_queue', type=int, default=64, help='Search -> encoder queue capacity')
+    parser.add_argument('--sample_queue', type=int, default=256, help='Encoder -> augment queue capacity')
+    parser.add_argument('--write_queue', type=int, default=1024, help='Augment -> writer queue capacity')
+    parser.add_argument('--augment_mirror', action='store_true',
+                        help='Also emit left-right mirrored samples (map symmetry)')
+    parser.add_argument('--dedupe', action='store_true',
+                        help='Merge samples with the same state before writing (keeps top_k programs)')
+    parser.add_argument('--dedupe_score_bucket', type=int, default=1,
+                        help='Score coarsening for dedupe keys (0 = ignore, 1 = exact, k = k-point bins)')
+    parser.add_argument('--dedupe_step_bucket', type=int, default=1,
+                        help='Step coarsening for dedupe keys (0 = ignore, 1 = exact, k = k-step bins)')
+    parser.add_argument('--report_every', type=float, default=10.0, help='Seconds between progress reports')
+    parser.add_argument('--output_dir', type=str, default='sft_data', help='Output directory')
+    args = parser.parse_args()
+
+    import cpp_simulator as cpp_sim
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    shard_path = os.path.join(args.output_dir, 'samples.bin')
+    policy = parse_policy(args.policy, cpp_sim)
+
+    pipeline = cpp_sim.GenerationPipeline(
+        shard_path, policy=policy, games=args.n_games, seed=args.seed, max_runs=args.max_runs,
+        top_k=args.top_k, search_workers=args.search_workers, encode_workers=args.encode_workers,
+        run_queue=args.run_queue, sample_queue=args.sample_queue, write_queue=args.write_queue,
+        mirror=args.augment_mirror, dedupe=args.dedupe,
+        dedupe_score_bucket=args.dedupe_score_bucket, dedupe_step_bucket=args.dedupe_step_bucket)
+
+    print("=" * 70)
+    print(f"오프라인 SFT 데이터 생성 (C++ 파이프라인)")
+    print(f"시작: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}")
+    print(f"설정: {args.n_games}게임, 정책 {args.policy}, top-{args.top_k}, "
+          f"탐색 {pipeline.report()['stages'][0]['threads']} / 인코더 {args.encode_workers} 스레드")
+    print(f"큐: runs {args.run_queue}, samples {args.sample_queue}, write {args.write_queue}")
+    print(f"샤드: {shard_path}")
+    print("=" * 70)
+
+    start_time = time.time()
+    pipeline.start()
+    try:
+        while not pipeline.wait(args.report_every):
+            print_report(pipeline.report())
+    except KeyboardInterrupt:
+        print("중단 요청: 진행 중인 런까지 기록하고 종료")
+        pipeline.cancel()
+        pipeline.wait()
+
+    report = pipeline.report()
+    print_report(report)
+    if report['error']:
+        raise SystemExit(f"샤드 기록 실패: {report['error']}")
+
+    shard = cpp_sim.read_sample_shard(shard_path)
+    vecs = shard['state_vecs']
+    data = []
+    for i in range(len(shard['programs'])):
+        sample = {
+            'state_vec': vecs[i].tolist(),
+            'programs': shard['programs'][i],
+            'scores': shard['scores'][i],
+        }
+        if args.dedupe:
+            sample['count'] = shard['counts'][i]
+        data.append(sample)
+
+    stats = pipeline.stats()
+    n_runs = sum(stats['per_run']['runs'])
+    save_path = os.path.join(args.output_dir, 'sft_data_final.pt')
+    torch.save({
+        'data': data,
+        'n_games': stats['games'],
+        'n_runs': n_runs,
+        'n_augmented': report['mirrored'],
+        'wins': stats['wins'],
+        'win_rate': stats['win_rate'],
+        'avg_score': stats['score_mean'],
+        'dedupe': pipeline.dedupe_stats if args.dedupe else None,
+        'stats': stats,
+        'pipeline': report,
+        'args': vars(args),
+    }, save_path)
+
+    elapsed = time.time() - start_time
+    print("\n" + "=" * 70)
+    print(f"완료: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}")
+    print(f"총 시간: {elapsed/60:.1f}분 ({stats['games'] / elapsed * 60 if elapsed > 0 else 0:.1f} eps/min)")
+    print(f"게임: {stats['games']}, 승률: {stats['wins']}/{stats['games']} ({stats['win_rate']*100:.1f}%)")
+    print(f"총 런 수: {n_runs} (평균 {stats['runs_mean']:.1f}런/게임)")
+    print(f"총 샘플: {len(data)} (대칭 증강 {report['mirrored']})")
+    if args.dedupe:
+        st = pipeline.dedupe_stats
+        print(f"중복 제거: {st['samples']} → {st['unique']} 샘플 (중복 {st['ratio']*100:.1f}%)")
+    print(f"저장: {save_path}")
+    print("=" * 70)
+
+
+if __name__ == '__main__':
+    main()
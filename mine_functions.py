@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+데이터셋 n-gram 채굴로 새 매크로 함수 후보 찾기
+
+1단계: SFT 데이터 샤드(.pt)의 프로그램을 평면(CSR) 배열로 모아 C++ NgramMiner에 추가
+2단계: 토큰 n-gram(작성된 그대로) / 전개 n-gram(함수 본문 전개 후)을 멀티스레드로 셈
+3단계: 압축 이득(줄어드는 토큰 수) 순 후보를 평면 라이브러리 형식으로 저장
+
+사용법:
+    python3 mine_functions.py sft_data/sft_data_g*.pt --top_n 64 --output mined_functions.json
+
+저장된 'flat'은 바로 평가에 사용 가능:
+    cpp_simulator.batch_simulate(programs, state, functions=flat)
+"""
+
+import os
+import sys
+import json
+import time
+import argparse
+import numpy as np
+import torch
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+
+def flatten_programs(samples):
+    """샘플의 프로그램 목록 → (tokens, offsets) CSR 배열"""
+    programs = [p for s in samples for p in s['programs']]
+    offsets = np.zeros(len(programs) + 1, dtype=np.int64)
+    offsets[1:] = np.cumsum([len(p) for p in programs])
+    tokens = np.fromiter((t for p in programs for t in p), dtype=np.int32, count=int(offsets[-1]))
+    return tokens, offsets
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Mine macro function candidates from SFT data')
+    parser.add_argument('shards', nargs='+', help='SFT data .pt files')
+    parser.add_argument('--top_n', type=int, default=64, help='Number of candidates to emit')
+    parser.add_argument('--min_programs', type=int, default=2, help='Minimum programs containing a candidate')
+    parser.add_argument('--max_units', type=int, default=9, help='Max grammar units per n-gram (dir / LOOP n d / IF n d)')
+    parser.add_argument('--threads', type=int, default=0, help='C++ threads (0 = auto)')
+    parser.add_argument('--output', type=str, default='mined_functions.json', help='Output JSON path')
+    args = parser.parse_args()
+
+    import cpp_simulator as cpp_sim
+
+    miner = cpp_sim.NgramMiner(args.max_units)
+    start_time = time.time()
+
+    for path in args.shards:
+        data = torch.load(path)
+        tokens, offsets = flatten_programs(data['data'])
+        miner.add_programs(tokens, offsets, args.threads)
+        print(f"{path}: {len(offsets) - 1} 프로그램 | 누적 {miner.num_programs} 프로그램, "
+              f"{miner.num_ngrams} n-gram | {time.time() - start_time:.1f}s")
+
+    candidates = miner.candidates(args.top_n, args.min_programs)
+    flat = miner.emit_flat(args.top_n, args.min_programs)
+
+    print("=" * 70)
+    print(f"{'gain':>10} {'count':>8} {'progs':>8} {'expanded':>9}  body")
+    for c in candidates[:20]:
+        print(f"{c['gain']:>10} {c['token_count']:>8} {c['programs']:>8} {c['expanded_count']:>9}  {c['body']}")
+
+    with open(args.output, 'w') as f:
+        json.dump({
+            'shards': args.shards,
+            'n_programs': miner.num_programs,
+            'candidates': candidates,
+            'flat': flat,
+        }, f)
+    print(f"저장: {args.output} ({len(candidates)} 후보, 평면 {len(flat)} 토큰)")
+    print("=" * 70)
+
+
+if __name__ == '__main__':
+    main()